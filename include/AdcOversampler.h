@@ -0,0 +1,84 @@
+#ifndef ADC_OVERSAMPLER_H
+#define ADC_OVERSAMPLER_H
+
+#include <stdint.h>
+
+#define ADC_OVERSAMPLE_MAX      64
+#define ADC_OVERSAMPLE_DEFAULT  32
+#define ADC_TRIM_DIVISOR        4    // Media recortada: descarta 1/4 de las muestras en cada extremo
+
+enum AdcFilter : uint8_t {
+    ADC_FILTER_MEDIAN,        // Inmune a picos aislados
+    ADC_FILTER_TRIMMED_MEAN   // Descarta los extremos y promedia el resto: menos ruido que la mediana
+};
+
+/**
+ * Sobremuestreo de un canal ADC.
+ *
+ * El ADC del ESP32 tiene varios LSB de ruido y picos esporádicos (WiFi,
+ * fuente), así que una sola muestra de analogRead() se ve como jitter en la
+ * humedad de suelo. Se juntan N muestras por lectura y se filtran con la
+ * mediana o con una media recortada: los picos quedan en los extremos del
+ * orden y no llegan al resultado.
+ *
+ * getSpread() es el rango de las muestras que se conservaron, una medida
+ * del ruido del canal para diagnóstico.
+ */
+class AdcOversampler {
+public:
+    AdcOversampler() : count(0), spread(0) {}
+
+    void reset() { count = 0; }
+
+    void add(uint16_t sample) {
+        if (count < ADC_OVERSAMPLE_MAX) samples[count++] = sample;
+    }
+
+    uint8_t getCount() const { return count; }
+
+    // Valor filtrado de las muestras acumuladas (0 si no hay ninguna)
+    uint16_t result(AdcFilter filter) {
+        if (count == 0) {
+            spread = 0;
+            return 0;
+        }
+        sort();
+
+        if (filter == ADC_FILTER_MEDIAN) {
+            uint8_t mid = count / 2;
+            uint8_t quarter = count / ADC_TRIM_DIVISOR;
+            spread = samples[count - 1 - quarter] - samples[quarter];
+            if (count & 1) return samples[mid];
+            return (uint16_t)(((uint32_t)samples[mid - 1] + samples[mid] + 1) / 2);
+        }
+
+        uint8_t trim = count / ADC_TRIM_DIVISOR;
+        uint8_t kept = count - 2 * trim;
+        uint32_t sum = 0;
+        for (uint8_t i = trim; i < count - trim; i++) sum += samples[i];
+        spread = samples[count - 1 - trim] - samples[trim];
+        return (uint16_t)((sum + kept / 2) / kept);
+    }
+
+    uint16_t getSpread() const { return spread; }
+
+private:
+    uint16_t samples[ADC_OVERSAMPLE_MAX];
+    uint8_t count;
+    uint16_t spread;
+
+    // Inserción: a lo sumo 64 valores y casi ordenados (ruido alrededor de un nivel)
+    void sort() {
+        for (uint8_t i = 1; i < count; i++) {
+            uint16_t v = samples[i];
+            uint8_t j = i;
+            while (j > 0 && samples[j - 1] > v) {
+                samples[j] = samples[j - 1];
+                j--;
+            }
+            samples[j] = v;
+        }
+    }
+};
+
+#endif // ADC_OVERSAMPLER_H
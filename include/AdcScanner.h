@@ -0,0 +1,136 @@
+#ifndef ADC_SCANNER_H
+#define ADC_SCANNER_H
+
+#include <Arduino.h>
+#include <esp_adc_cal.h>
+#include "AdcOversampler.h"
+
+#define ADC_SCAN_MAX_CHANNELS  8      // ADC1: GPIO 32-39
+#define ADC_SCAN_MAX_AGE_MS    100    // Los sensores que vencen en la misma pasada comparten el barrido
+#define ADC_DEFAULT_VREF_MV    1100   // Si el chip no tiene Vref grabado en eFuse
+
+/**
+ * Barrido ADC compartido por los sensores analógicos (capacitivo, HD38).
+ *
+ * Cada sensor registra su pin con addPin() y pide el valor filtrado con
+ * read(). Si el último barrido es viejo, read() muestrea todos los pines
+ * registrados en una sola pasada, intercalando los canales (p0 p1 p2 p0 p1
+ * p2 ...) para que un transitorio afecte a todas las sondas por igual y no
+ * a varias muestras seguidas de una. Cada canal acumula adc_samples muestras
+ * que AdcOversampler reduce con mediana o media recortada (adc_filter); los
+ * sensores que vencen juntos reutilizan el mismo barrido.
+ *
+ * millivolts() aplica la curva de calibración de fábrica (eFuse) al valor
+ * filtrado. La calibración seco/mojado de los sensores sigue en cuentas
+ * crudas, que es lo que se anota al calibrar.
+ */
+class AdcScanner {
+public:
+    AdcScanner()
+        : channelCount(0),
+          samplesPerScan(ADC_OVERSAMPLE_DEFAULT),
+          filter(ADC_FILTER_TRIMMED_MEAN),
+          scanned(false),
+          characterized(false),
+          lastScanMs(0),
+          lastScanUs(0),
+          scans(0) {}
+
+    // Registra un pin y devuelve su canal (el mismo si ya estaba); -1 si no hay lugar
+    int addPin(int pin) {
+        for (uint8_t c = 0; c < channelCount; c++) {
+            if (channels[c].pin == pin) return c;
+        }
+        if (channelCount >= ADC_SCAN_MAX_CHANNELS) {
+            Serial.printf("[⚠ WARN] ADC: sin lugar para el pin %d\n", pin);
+            return -1;
+        }
+        if (!characterized) {
+            analogReadResolution(12);
+            esp_adc_cal_value_t src = esp_adc_cal_characterize(ADC_UNIT_1, ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12,
+                                                               ADC_DEFAULT_VREF_MV, &calibration);
+            characterized = true;
+            Serial.printf("[→ INFO] ADC: calibración %s\n",
+                          src == ESP_ADC_CAL_VAL_EFUSE_TP ? "eFuse two-point" :
+                          src == ESP_ADC_CAL_VAL_EFUSE_VREF ? "eFuse Vref" : "Vref por defecto");
+        }
+        pinMode(pin, INPUT);
+        channels[channelCount].pin = pin;
+        channels[channelCount].value = 0;
+        channels[channelCount].spread = 0;
+        scanned = false;
+        return channelCount++;
+    }
+
+    void configure(int samples, AdcFilter f) {
+        samplesPerScan = constrain(samples, 1, ADC_OVERSAMPLE_MAX);
+        filter = f;
+        scanned = false;
+    }
+
+    // Valor filtrado del canal (cuentas, 0-4095); barre si el último barrido es viejo
+    uint16_t read(int channel) {
+        if (channel < 0 || channel >= channelCount) return 0;
+        if (!scanned || millis() - lastScanMs >= ADC_SCAN_MAX_AGE_MS) scan();
+        return channels[channel].value;
+    }
+
+    // Valor filtrado del último barrido con la curva de calibración eFuse aplicada
+    uint32_t millivolts(int channel) const {
+        if (channel < 0 || channel >= channelCount || !characterized) return 0;
+        return esp_adc_cal_raw_to_voltage(channels[channel].value, &calibration);
+    }
+
+    // Rango de las muestras conservadas en el último barrido (ruido del canal, en cuentas)
+    uint16_t getSpread(int channel) const {
+        return (channel >= 0 && channel < channelCount) ? channels[channel].spread : 0;
+    }
+
+    void scan() {
+        uint32_t t0 = micros();
+        for (uint8_t c = 0; c < channelCount; c++) channels[c].sampler.reset();
+
+        for (uint8_t s = 0; s < samplesPerScan; s++) {
+            for (uint8_t c = 0; c < channelCount; c++) {
+                channels[c].sampler.add(analogRead(channels[c].pin));
+            }
+        }
+
+        for (uint8_t c = 0; c < channelCount; c++) {
+            channels[c].value = channels[c].sampler.result(filter);
+            channels[c].spread = channels[c].sampler.getSpread();
+        }
+        lastScanUs = micros() - t0;
+        lastScanMs = millis();
+        scanned = true;
+        scans++;
+    }
+
+    uint8_t getChannelCount() const { return channelCount; }
+    uint8_t getSamplesPerScan() const { return samplesPerScan; }
+    uint32_t getLastScanUs() const { return lastScanUs; }
+    uint32_t getScans() const { return scans; }
+
+private:
+    struct Channel {
+        int pin;
+        uint16_t value;
+        uint16_t spread;
+        AdcOversampler sampler;
+    };
+
+    Channel channels[ADC_SCAN_MAX_CHANNELS];
+    uint8_t channelCount;
+    uint8_t samplesPerScan;
+    AdcFilter filter;
+    bool scanned;
+    bool characterized;
+    esp_adc_cal_characteristics_t calibration;
+    uint32_t lastScanMs;
+    uint32_t lastScanUs;
+    uint32_t scans;
+};
+
+extern AdcScanner adcScanner;
+
+#endif // ADC_SCANNER_H
@@ -0,0 +1,176 @@
+#ifndef DEADBAND_FILTER_H
+#define DEADBAND_FILTER_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "Measurement.h"
+
+#define DEADBAND_DEFAULT_HEARTBEAT_MS  900000   // 15 min: un campo quieto se republica igual
+#define DEADBAND_MEMORY_FIELDS         32       // Campos de todos los sensores que sobreviven al deep sleep
+
+/**
+ * Referencias de las bandas muertas guardadas en memoria RTC entre dos
+ * despertares (espnow_deep_sleep): sin esto cada despertar arranca con la
+ * tabla vacía y publica todo. Agregado sin constructor, como SleepSchedule;
+ * clear() al arrancar en frío.
+ */
+struct DeadbandMemory {
+    struct Entry {
+        uint8_t sensor;                           // Índice del sensor en SensorManager
+        uint8_t field;                            // Clave de MeasurementTable (y name si es MEAS_NAMED)
+        char name[MEASUREMENT_FIELD_NAME_MAX + 1];
+        float last;                               // Último valor publicado
+        uint32_t lastSentMs;                      // En el reloj de SleepSchedule::clockMs()
+    };
+
+    uint8_t count;
+    Entry entries[DEADBAND_MEMORY_FIELDS];
+
+    void clear() { count = 0; }
+};
+
+/**
+ * Publicación por excepción de las mediciones de un sensor.
+ *
+ * Cada medición de una lectura (MeasurementSet) se publica solo si se
+ * alejó más de su banda muerta del último valor publicado, o si lleva
+ * heartbeatMs sin publicarse (para que el dashboard sepa que el sensor
+ * sigue vivo). filter() copia las mediciones que salen; si ninguna salió,
+ * no hay nada que enviar.
+ *
+ * La banda y el heartbeat son por campo; los campos sin configuración usan
+ * los valores por defecto (banda 0 = cualquier cambio). La referencia es el
+ * último valor publicado, no la última lectura, así una deriva lenta
+ * termina saliendo.
+ *
+ * now tiene que ser un reloj continuo entre lecturas: en un sensor a
+ * batería, SleepSchedule::clockMs(), y las referencias pasan de un
+ * despertar al siguiente con save()/restore().
+ */
+class DeadbandFilter {
+public:
+    DeadbandFilter(float defaultBand = 0, uint32_t defaultHeartbeatMs = DEADBAND_DEFAULT_HEARTBEAT_MS)
+        : band(defaultBand), heartbeat(defaultHeartbeatMs), published(0), suppressed(0) {}
+
+    bool setBand(const char* name, float value) {
+        Field* f = fieldNamed(name);
+        if (!f) return false;
+        f->band = value;
+        return true;
+    }
+
+    // 0 = sin heartbeat: el campo solo sale al dejar la banda
+    bool setHeartbeat(const char* name, uint32_t ms) {
+        Field* f = fieldNamed(name);
+        if (!f) return false;
+        f->heartbeatMs = ms;
+        return true;
+    }
+
+    /**
+     * Agrega a out las mediciones que hay que publicar y devuelve cuántas
+     * son (0 = nada que enviar). Las mediciones inválidas no salen ni
+     * mueven la referencia.
+     */
+    uint8_t filter(const MeasurementSet& in, uint32_t now, MeasurementSet& out) {
+        uint8_t written = 0;
+
+        for (const Measurement& m : in) {
+            if (m.quality == MEAS_INVALID || isnan(m.value) || isinf(m.value)) continue;
+
+            // Campo sin lugar en la tabla (nombre largo o demasiados campos): sale siempre
+            bool added;
+            FieldTable::Entry* e = fields.findOrAdd(m, added);
+            Field* f = e ? &e->state : nullptr;
+            if (added) init(*f);
+            bool send = !f || !f->sent ||
+                        (f->heartbeatMs > 0 && now - f->lastSentMs >= f->heartbeatMs) ||
+                        fabs(m.value - f->last) > f->band;
+
+            if (send && out.push(m)) {
+                written++;
+                if (f) {
+                    f->sent = true;
+                    f->lastSentMs = now;
+                    f->last = m.value;
+                }
+            }
+        }
+
+        if (written) {
+            published++;
+        } else {
+            suppressed++;
+        }
+        return written;
+    }
+
+    // Guarda en mem los campos ya publicados (antes del deep sleep)
+    void save(uint8_t sensor, DeadbandMemory& mem) const {
+        for (uint8_t i = 0; i < fields.size() && mem.count < DEADBAND_MEMORY_FIELDS; i++) {
+            const FieldTable::Entry& f = fields[i];
+            if (!f.state.sent) continue;
+            DeadbandMemory::Entry& e = mem.entries[mem.count++];
+            e.sensor = sensor;
+            e.field = f.field;
+            memcpy(e.name, f.name, sizeof(e.name));
+            e.last = (float)f.state.last;
+            e.lastSentMs = f.state.lastSentMs;
+        }
+    }
+
+    // Recupera las referencias del sensor guardadas por save() (al despertar)
+    void restore(uint8_t sensor, const DeadbandMemory& mem) {
+        uint8_t count = mem.count < DEADBAND_MEMORY_FIELDS ? mem.count : DEADBAND_MEMORY_FIELDS;
+        for (uint8_t i = 0; i < count; i++) {
+            const DeadbandMemory::Entry& e = mem.entries[i];
+            if (e.sensor != sensor || memchr(e.name, '\0', sizeof(e.name)) == nullptr) continue;
+            bool added;
+            FieldTable::Entry* f = fields.findOrAdd(e.field, e.name, added);
+            if (!f) continue;
+            if (added) init(f->state);
+            f->state.sent = true;
+            f->state.last = e.last;
+            f->state.lastSentMs = e.lastSentMs;
+        }
+    }
+
+    uint32_t getPublished() const { return published; }
+    uint32_t getSuppressed() const { return suppressed; }
+
+private:
+    struct Field {
+        float band;
+        uint32_t heartbeatMs;
+        bool sent;          // Ya se publicó al menos una vez
+        double last;        // Último valor publicado
+        uint32_t lastSentMs;
+    };
+    typedef MeasurementTable<Field> FieldTable;
+
+    float band;
+    uint32_t heartbeat;
+    FieldTable fields;
+    uint32_t published;     // Lecturas con al menos un campo publicado
+    uint32_t suppressed;    // Lecturas descartadas enteras
+
+    // Campo nuevo: valores por defecto, todavía sin publicar
+    void init(Field& f) const {
+        f.band = band;
+        f.heartbeatMs = heartbeat;
+        f.sent = false;
+        f.last = 0;
+        f.lastSentMs = 0;
+    }
+
+    Field* fieldNamed(const char* name) {
+        bool added;
+        FieldTable::Entry* e = fields.findOrAdd(name, added);
+        if (!e) return nullptr;
+        if (added) init(e->state);
+        return &e->state;
+    }
+};
+
+#endif // DEADBAND_FILTER_H
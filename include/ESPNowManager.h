@@ -5,13 +5,43 @@
 #include <WiFi.h>
 #include <esp_now.h>
 #include <esp_wifi.h>
+#include <esp_idf_version.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <atomic>
+#include <stddef.h>
+#include "deviceIdentity.h"
+#include "MeshDedup.h"
+#include "MeshSeqTracker.h"
+#include "PeerRegistry.h"
+#include "SpscRing.h"
+#include "MeshPayload.h"
+#include "MeshRouting.h"
+#include "TrickleTimer.h"
+#include "SleepSchedule.h"
+
+#define ESPNOW_RX_RING_SIZE      16    // Tramas recibidas esperando a la tarea de recepción
+#define ESPNOW_RX_TASK_STACK     4096
+#define ESPNOW_RX_TASK_PRIORITY  2     // Por encima del loop y del uplink, por debajo de la WiFi
+#define ESPNOW_RX_TASK_CORE      0
+
+#define MESH_DATA_HOPS             4     // Saltos iniciales de una trama de datos
+#define MESH_NAME_REANNOUNCE       20    // Cada cuántas tramas se repite el nombre de un sensor
+#define MESH_AGGREGATE_MAX_CYCLES  MESH_MAX_CYCLE_MARKS
+
+#define ROUTE_TX_QUEUE             4     // Frames waiting behind the unicast in flight
+#define ROUTE_MAX_RETRIES          2     // Retries towards the parent before flooding
+#define ROUTE_ACK_TIMEOUT_MS       50    // The send callback normally arrives in a few ms
+#define PEER_SNAPSHOT_TIMEOUT_MS   100   // Max wait of the web handler for rxTask's registry copy
 
 // Message types for ESP-NOW communication
 enum MessageType {
   MSG_BEACON = 0,        // Gateway beacon broadcast
   MSG_PAIR_REQUEST = 1,  // Sensor pairing request
   MSG_PAIR_ACK = 2,      // Gateway pairing acknowledgement
-  MSG_DATA = 3          // Sensor data transmission
+  MSG_DATA = 3,          // Sensor data, fixed struct (legacy, still accepted)
+  MSG_DATA_V2 = 4,       // Sensor data, TLV frame (MeshPayload.h), flooded
+  MSG_DATA_UP = 5        // Same frame, unicast hop by hop to the parent (gradient routing)
 };
 
 // Discovery/pairing message structure
@@ -24,7 +54,26 @@ typedef struct {
   uint32_t timestamp;    // Timestamp for timeout detection
 } DiscoveryMessage;
 
-// Sensor data message structure
+// Route advertisement appended to MSG_BEACON (gradient routing)
+typedef struct {
+  uint8_t hops;          // Hops to the gateway: 0 gateway, 0xFF no route
+  uint16_t pathCost;     // Path cost to the gateway (ETX x10, MeshRouting.h)
+  uint8_t parentMAC[6];  // Sender's next hop, zeros if none (loop avoidance)
+} RouteAdvert;
+
+// Beacon timing appended after the route advert (Trickle, TrickleTimer.h)
+typedef struct {
+  uint8_t beaconSeq;     // Counts beacons actually sent: link loss despite suppression
+  uint16_t intervalDs;   // Sender's current beacon interval, tenths of a second
+} BeaconTiming;
+
+typedef struct {
+  DiscoveryMessage base;
+  RouteAdvert route;
+  BeaconTiming timing;   // Absent in beacons from older firmware
+} BeaconMessage;
+
+// Legacy sensor data message (MSG_DATA); new firmware sends MSG_DATA_V2
 typedef struct {
   uint8_t msgType;       // MessageType enum (MSG_DATA)
   uint8_t hopCount;      // Hop limit for flooding
@@ -37,11 +86,19 @@ typedef struct {
 
 } SensorDataMessage;
 
-// Peer information structure
-struct PeerInfo {
+// Raw frame as copied by the receive callback
+struct EspNowRxFrame {
   uint8_t mac[6];
-  uint32_t lastSeen;
-  bool active;
+  int8_t rssi;           // 0 if the IDF does not report it (4.x)
+  uint8_t len;
+  uint8_t data[ESP_NOW_MAX_DATA_LEN];
+};
+
+// Data frame waiting to be routed up
+struct MeshTxFrame {
+  uint8_t len;
+  uint8_t attempts;
+  uint8_t data[MESH_FRAME_MAX];
 };
 
 // Pairing states
@@ -57,7 +114,9 @@ private:
   String mode;                    // "gateway" or "sensor"
   bool enabled;
   uint8_t channel;
-  uint16_t beaconInterval;
+  uint16_t beaconInterval;        // Trickle Imin
+  uint32_t beaconIntervalMax;     // Trickle Imax
+  uint8_t beaconRedundancy;       // Trickle k (0 = never suppress)
   uint16_t discoveryTimeout;
   uint16_t sendInterval;
 
@@ -66,14 +125,30 @@ private:
   uint8_t gatewayMAC[6];
   int8_t bestGatewayRSSI;
   uint32_t lastBeaconTime;
+  TrickleTimer trickle;           // Loop task only
+  uint8_t beaconSeq;
+  uint8_t advertisedHops;                  // Route advert of the last beacon sent
+  uint8_t advertisedParent[6];
+  bool advertisedHasParent;
+  std::atomic<uint8_t> trickleHeard;       // Consistent beacons, counted by rxTask
+  std::atomic<bool> trickleInconsistent;   // Topology change seen by rxTask
+  volatile uint32_t lastRelayMs;           // Last routed frame forwarded for a child
   uint32_t lastDiscoveryAttempt;
   uint32_t sequenceNumber;
 
-  // Peer management (for gateway)
-  static const int MAX_PEERS = 20;
-  PeerInfo peers[MAX_PEERS];
-  int peerCount;
+  // Peer management (for gateway; rxTask writes)
+  PeerRegistry peerRegistry;
   uint32_t lastPeerCleanup;
+  std::atomic<bool> peerCleanupDue;  // Set by update(), handled on rxTask
+  uint32_t driverRecycled;           // ESP-NOW driver slots reused (table full)
+
+  // Registry copy for /espnow/status: requested by the loop task, taken on rxTask
+  enum PeerSnapshotState : uint8_t { SNAPSHOT_IDLE, SNAPSHOT_REQUESTED, SNAPSHOT_COPYING, SNAPSHOT_DONE };
+  std::atomic<uint8_t> peerSnapshotState;
+  PeerEntry* peerSnapshotOut;        // Caller's buffer, valid while a snapshot is requested
+  uint16_t peerSnapshotMax;
+  uint16_t peerSnapshotCount;
+  PeerRegistryStats peerSnapshotStats;
 
   // Broadcast address
   uint8_t broadcastAddress[6] = {0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
@@ -81,90 +156,114 @@ private:
   // Static instance pointer for callbacks
   static ESPNowManager* instance;
 
-  // Duplicate packet detection cache for flooding
-  static const int SEEN_PACKET_CACHE_SIZE = 30;
-  struct PacketID {
-    uint8_t mac[6];
-    uint32_t sequence;
-    unsigned long timestamp;
-  };
-  PacketID seenPackets[SEEN_PACKET_CACHE_SIZE];
-  int seenPacketIndex;
-  // Callback for received mesh data (gateway only)
-  typedef void (*MeshDataCallback)(const uint8_t* senderMAC, float temp, float hum, float co2, uint32_t seq, const char* sensorId);
+  // Duplicate packet detection for flooding (per-originator sequence window)
+  MeshDedup dedup;
+  MeshSeqTracker seqTracker;  // Gateway: loss/reorder/latency per originator (rxTask writes)
+
+  // Receive path: the WiFi callback only copies the frame into rxRing,
+  // rxTask parses, dedupes, forwards and delivers it
+  SpscRing<EspNowRxFrame, ESPNOW_RX_RING_SIZE> rxRing;
+  TaskHandle_t rxTask;
+  uint32_t rxFrames;
+  int8_t lastRxRssi;
+
+  // Receive callback timing (runs on the WiFi task)
+  uint32_t rxCallbacks;
+  uint64_t rxCallbackTotalUs;
+  uint32_t rxCallbackMaxUs;
+
+  // Sensor: readings of the current cycle packed into one MSG_DATA_V2 frame
+  uint8_t txFrame[MESH_FRAME_MAX];
+  MeshFrameWriter txWriter;
+  bool txOpen;
+  uint32_t framesSent;
+  uint8_t aggregateCycles;       // Sampling cycles packed per frame
+  uint8_t cyclesInFrame;
+  bool cycleOpen;                // A reading of the current cycle was queued
+  bool cycleMarked;              // ...and its age mark is in the open frame
+  uint32_t cycleStartMs;
+  uint32_t txReadings;
+  uint32_t txBytes;
+  MeshAnnouncedSensor announced[MESH_ANNOUNCED_SENSORS];
+
+  // Gateway: sensor names announced by each originator
+  MeshNameTable meshNames;
+
+  // Gradient routing: data goes up to the parent by unicast, flooding is the
+  // fallback. Only rxTask sends routed frames; the loop hands its own frames
+  // over through ownTxRing.
+  enum RouteTxStatus : uint8_t { ROUTE_TX_PENDING, ROUTE_TX_OK, ROUTE_TX_FAIL };
+  bool routingEnabled;
+  MeshRouter router;
+  SpscRing<MeshTxFrame, 4> ownTxRing;
+  MeshTxFrame routeQueue[ROUTE_TX_QUEUE];
+  uint8_t routeQueueHead;
+  uint8_t routeQueueCount;
+  volatile bool routeInFlight;
+  uint8_t routeDest[6];
+  uint32_t routeSentMs;
+  std::atomic<uint8_t> routeTxStatus;   // Set by onDataSent (WiFi task)
+  uint32_t routedUp;
+  uint32_t routeRetries;
+  uint32_t floodFallbacks;
+
+  // Duty-cycled sensor (deep sleep between readings): a leaf that never
+  // relays; its frame goes by unicast to the paired peer from the loop task
+  bool dutyCycled;
+  volatile bool directInFlight;
+  std::atomic<uint8_t> directTxStatus;  // Set by onDataSent (WiFi task)
+
+  // Callback for received mesh data (gateway only); fields in line protocol ("temp=25.30,hum=60.50")
+  typedef void (*MeshDataCallback)(const uint8_t* originatorMAC, const char* sensorId, const char* fields,
+                                   uint32_t seq, uint16_t ageS);
   MeshDataCallback meshDataCallback;
 
-  // Cleanup stale peers (gateway only)
+  // MAC this node announces: SoftAP for gateway, Station for sensor
+  const uint8_t* ownMac() const {
+    return mode == "gateway" ? deviceIdentity.apMac() : deviceIdentity.staMac();
+  }
+
+  // Cleanup stale peers (gateway only, rxTask): least recently heard first
   void cleanupStalePeers() {
     if (mode != "gateway") return;
 
-    uint32_t now = millis();
     const uint32_t PEER_TIMEOUT = 300000;  // 5 minutes
 
-    for (int i = 0; i < peerCount; i++) {
-      if (peers[i].active && (now - peers[i].lastSeen) > PEER_TIMEOUT) {
-        Serial.printf("[ESP-NOW] Peer %d timeout, removido\n", i);
-        esp_now_del_peer(peers[i].mac);
-        peers[i].active = false;
-      }
+    while (const PeerEntry* p = peerRegistry.oldestIdle(millis(), PEER_TIMEOUT)) {
+      uint8_t mac[6];
+      memcpy(mac, p->mac, 6);
+      Serial.printf("[ESP-NOW] Peer %02X:%02X:%02X:%02X:%02X:%02X timeout, removido\n",
+                    mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+      if (p->inDriver) esp_now_del_peer(mac);
+      peerRegistry.expire(mac);
     }
   }
 
-  // Find peer index by MAC address
-  int findPeerIndex(const uint8_t* mac) {
-    for (int i = 0; i < MAX_PEERS; i++) {
-      if (peers[i].active && memcmp(peers[i].mac, mac, 6) == 0) {
-        return i;
-      }
-    }
-    return -1;
-  }
-
-  // Add peer to list
-  bool addPeerToList(const uint8_t* mac) {
-    // Check if peer already exists
-    int existingIndex = findPeerIndex(mac);
-    if (existingIndex >= 0) {
-      peers[existingIndex].lastSeen = millis();
-      return true;
-    }
-
-    // Find empty slot
-    for (int i = 0; i < MAX_PEERS; i++) {
-      if (!peers[i].active) {
-        memcpy(peers[i].mac, mac, 6);
-        peers[i].lastSeen = millis();
-        peers[i].active = true;
-        if (i >= peerCount) peerCount = i + 1;
-        return true;
-      }
+  // rxTask: copy the registry (most recent first) into the buffer of snapshotPeers()
+  void takePeerSnapshot() {
+    uint8_t expected = SNAPSHOT_REQUESTED;
+    if (!peerSnapshotState.compare_exchange_strong(expected, SNAPSHOT_COPYING)) return;  // Caller gave up
+    uint16_t n = 0;
+    for (const PeerEntry* p = peerRegistry.first(); p && n < peerSnapshotMax; p = peerRegistry.next(p)) {
+      peerSnapshotOut[n++] = *p;
     }
-
-    Serial.println("[ESP-NOW] Límite de peers alcanzado");
-    return false;
+    peerSnapshotCount = n;
+    peerSnapshotStats = peerRegistry.getStats();
+    peerSnapshotState.store(SNAPSHOT_DONE);
   }
 
-  // Check if a packet has been seen recently to prevent loops
-  bool hasSeenPacket(const uint8_t* mac, uint32_t seq) {
-    unsigned long now = millis();
-    const unsigned long SEEN_TIMEOUT = 60000; // 1 minute timeout
-
-    for (int i = 0; i < SEEN_PACKET_CACHE_SIZE; i++) {
-        if (memcmp(seenPackets[i].mac, mac, 6) == 0 && seenPackets[i].sequence == seq) {
-            if (now - seenPackets[i].timestamp < SEEN_TIMEOUT) {
-                return true; // Packet is fresh and a duplicate
-            }
-        }
+  // Register a peer (LRU eviction when the registry is full) and give it an ESP-NOW driver slot
+  bool registerPeer(const uint8_t* mac) {
+    PeerEntry evicted;
+    bool didEvict;
+    PeerEntry* p = peerRegistry.add(mac, millis(), &evicted, &didEvict);
+    if (didEvict) {
+      Serial.printf("[ESP-NOW] Registro lleno, desalojado %02X:%02X:%02X:%02X:%02X:%02X\n",
+                    evicted.mac[0], evicted.mac[1], evicted.mac[2], evicted.mac[3], evicted.mac[4], evicted.mac[5]);
+      if (evicted.inDriver) esp_now_del_peer(evicted.mac);
     }
-    return false; // Packet not seen or is stale
-  }
-
-  // Mark a packet as seen
-  void markPacketAsSeen(const uint8_t* mac, uint32_t seq) {
-      memcpy(seenPackets[seenPacketIndex].mac, mac, 6);
-      seenPackets[seenPacketIndex].sequence = seq;
-      seenPackets[seenPacketIndex].timestamp = millis();
-      seenPacketIndex = (seenPacketIndex + 1) % SEEN_PACKET_CACHE_SIZE;
+    if (!p->inDriver) p->inDriver = ensurePeer(mac);
+    return p->inDriver;
   }
 
   // Static callback handlers
@@ -174,26 +273,99 @@ private:
     }
   }
 
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+  static void onDataRecvStatic(const esp_now_recv_info_t *info, const uint8_t *data, int len) {
+    if (instance) {
+      instance->enqueueRx(info->src_addr, info->rx_ctrl ? info->rx_ctrl->rssi : 0, data, len);
+    }
+  }
+#else
   static void onDataRecvStatic(const uint8_t *mac_addr, const uint8_t *data, int len) {
     if (instance) {
-      instance->onDataRecv(mac_addr, data, len);
+      instance->enqueueRx(mac_addr, 0, data, len);  // IDF 4.x does not pass RSSI
     }
   }
+#endif
+
+  // Runs on the WiFi task: copy the frame and wake rxTask, nothing else
+  void enqueueRx(const uint8_t *mac_addr, int8_t rssi, const uint8_t *data, int len) {
+    uint32_t start = micros();
+    if (len > 0 && len <= ESP_NOW_MAX_DATA_LEN) {
+      EspNowRxFrame* frame = rxRing.reserve();
+      if (frame) {
+        memcpy(frame->mac, mac_addr, 6);
+        frame->rssi = rssi;
+        frame->len = len;
+        memcpy(frame->data, data, len);
+        rxRing.commit();
+        xTaskNotifyGive(rxTask);
+      }
+    }
+    recordRxTime(micros() - start);
+  }
+
+  static void rxTaskEntry(void* param) {
+    static_cast<ESPNowManager*>(param)->rxLoop();
+  }
+
+  void rxLoop() {
+    for (;;) {
+      // With a unicast in flight, wake up anyway for its ACK timeout
+      ulTaskNotifyTake(pdTRUE, routeInFlight ? pdMS_TO_TICKS(ROUTE_ACK_TIMEOUT_MS) : portMAX_DELAY);
+      while (EspNowRxFrame* frame = rxRing.front()) {
+        lastRxRssi = frame->rssi;
+        onDataRecv(frame->mac, frame->data, frame->len);
+        rxRing.release();
+        rxFrames++;
+      }
+      while (MeshTxFrame* own = ownTxRing.front()) {
+        routeUp(own->data, own->len);
+        ownTxRing.release();
+      }
+      serviceRouteTx(millis());
+      if (peerCleanupDue.exchange(false)) cleanupStalePeers();
+      takePeerSnapshot();
+    }
+  }
+
+  void recordRxTime(uint32_t us) {
+    rxCallbacks++;
+    rxCallbackTotalUs += us;
+    if (us > rxCallbackMaxUs) rxCallbackMaxUs = us;
+  }
 
   // Instance callback handlers
   void onDataSent(const uint8_t *mac_addr, esp_now_send_status_t status) {
     // Keep minimal - runs on WiFi task
+    if (routeInFlight && memcmp(mac_addr, routeDest, 6) == 0) {
+      // MAC-level ACK of the routed unicast: rxTask retries or falls back
+      routeTxStatus.store(status == ESP_NOW_SEND_SUCCESS ? ROUTE_TX_OK : ROUTE_TX_FAIL);
+      xTaskNotifyGive(rxTask);
+      return;
+    }
+    if (directInFlight && memcmp(mac_addr, gatewayMAC, 6) == 0) {
+      directTxStatus.store(status == ESP_NOW_SEND_SUCCESS ? ROUTE_TX_OK : ROUTE_TX_FAIL);
+      return;
+    }
     if (status != ESP_NOW_SEND_SUCCESS) {
       Serial.println("[ESP-NOW] ✗ Envío fallido");
     }
   }
 
+  // Runs on rxTask (not the WiFi task): may log, add peers and send
   void onDataRecv(const uint8_t *mac_addr, const uint8_t *data, int len) {
-    // Keep minimal - runs on WiFi task
-    if (len < sizeof(uint8_t)) return;
+    if (len < (int)sizeof(uint8_t)) return;
 
     uint8_t msgType = data[0];
 
+    if (mode == "gateway") {
+      peerRegistry.onFrame(mac_addr, len, lastRxRssi, millis());  // Only paired sensors count
+    }
+
+    if (msgType == MSG_BEACON && len >= (int)offsetof(BeaconMessage, timing)) {
+      onRouteBeacon(mac_addr, (const BeaconMessage*)data, len >= (int)sizeof(BeaconMessage));
+    }
+
     if (mode == "sensor" && msgType == MSG_BEACON && pairingState != PAIRED) {
       // Sensor received beacon from gateway
       handleBeaconReceived(mac_addr, data, len);
@@ -206,14 +378,35 @@ private:
       // Gateway or Sensor received a pairing request
       handlePairRequestReceived(mac_addr, data, len);
 
-    } else if (msgType == MSG_DATA) {
+    } else if (msgType == MSG_DATA_V2 || msgType == MSG_DATA_UP) {
       // Any node can receive sensor data for forwarding
+      handleDataV2Received(data, len);
+
+    } else if (msgType == MSG_DATA) {
       handleDataReceived(mac_addr, data, len);
     }
   }
 
+  // rxTask: route table (gateway is the root) and Trickle consistency
+  void onRouteBeacon(const uint8_t *mac_addr, const BeaconMessage* beacon, bool timed) {
+    bool newNeighbor = false;
+    if (mode != "gateway") {
+      newNeighbor = router.onBeacon(mac_addr, beacon->route.hops, beacon->route.pathCost,
+                                    beacon->route.parentMAC, lastRxRssi, millis(),
+                                    timed ? beacon->timing.beaconSeq : -1,
+                                    timed ? beacon->timing.intervalDs * 100u : 0);
+    }
+    // A neighbour without a route needs our advert soon (own route changes: broadcastBeacon)
+    bool needsUs = beacon->route.hops == ROUTE_NO_HOPS && router.hasParent();
+    if (newNeighbor || needsUs) {
+      trickleInconsistent.store(true);
+    } else if (trickleHeard.load() < 0xFF) {
+      trickleHeard.fetch_add(1);
+    }
+  }
+
   void handleBeaconReceived(const uint8_t *mac_addr, const uint8_t *data, int len) {
-    if (len != sizeof(DiscoveryMessage)) return;
+    if (len < (int)sizeof(DiscoveryMessage)) return;  // Route advert may follow
 
     DiscoveryMessage* msg = (DiscoveryMessage*)data;
     int8_t rssi = msg->rssi;
@@ -233,8 +426,8 @@ private:
         // Send pairing request
         DiscoveryMessage pairReq;
         pairReq.msgType = MSG_PAIR_REQUEST;
-        pairReq.deviceId = ESP.getEfuseMac() & 0xFF;
-        WiFi.macAddress(pairReq.macAddr);
+        pairReq.deviceId = deviceIdentity.shortId();
+        memcpy(pairReq.macAddr, deviceIdentity.staMac(), 6);
         pairReq.channel = WiFi.channel();
         pairReq.rssi = 0;  // Not used in request
         pairReq.timestamp = millis();
@@ -285,40 +478,22 @@ private:
 
   void handlePairRequestReceived(const uint8_t *mac_addr, const uint8_t *data, int len) {
     if (len != sizeof(DiscoveryMessage)) return;
+    if (dutyCycled) return;  // Asleep most of the time: nobody should pair with us
 
     Serial.printf("[ESP-NOW] Pairing request: %02X:%02X:%02X:%02X:%02X:%02X\n",
                   mac_addr[0], mac_addr[1], mac_addr[2], mac_addr[3], mac_addr[4], mac_addr[5]);
 
-    // Add to peer list
-    if (!addPeerToList(mac_addr)) {
-      Serial.println("  └─ ✗ Límite de peers alcanzado");
+    // Add to the peer registry and the ESP-NOW peer table
+    if (!registerPeer(mac_addr)) {
+      Serial.println("  └─ ✗ Error agregando peer");
       return;
     }
-
-    // Add as ESP-NOW peer if not already added
-    if (!esp_now_is_peer_exist(mac_addr)) {
-      esp_now_peer_info_t peerInfo = {};
-      memcpy(peerInfo.peer_addr, mac_addr, 6);
-      peerInfo.channel = channel; // Use configured channel
-      peerInfo.encrypt = false;
-
-      esp_err_t result = esp_now_add_peer(&peerInfo);
-      if (result == ESP_OK) {
-        Serial.printf("  └─ ✓ Peer agregado (total: %d)\n", getActivePeerCount());
-      } else {
-        Serial.printf("  └─ ✗ Error agregando peer: %d\n", result);
-        return;
-      }
-    }
+    Serial.printf("  └─ ✓ Peer registrado (total: %d)\n", peerRegistry.size());
 
     // Send pairing acknowledgement
     DiscoveryMessage ack;
     ack.msgType = MSG_PAIR_ACK;
-    if (mode == "gateway") {
-      WiFi.softAPmacAddress(ack.macAddr);  // Gateway uses its SoftAP MAC
-    } else {
-      WiFi.macAddress(ack.macAddr);        // Sensor uses its Station MAC
-    }
+    memcpy(ack.macAddr, ownMac(), 6);
     ack.channel = channel; // Use configured channel
 
     esp_now_send(mac_addr, (uint8_t*)&ack, sizeof(ack));
@@ -333,20 +508,26 @@ private:
     memcpy(&msg, data, sizeof(SensorDataMessage));
 
     // 1. Duplicate check to prevent loops and storms
-    if (hasSeenPacket(msg.originatorMAC, msg.sequence)) {
+    if (dedup.checkAndMark(msg.originatorMAC, msg.sequence, millis())) {
       return; // Drop duplicate packet
     }
-    markPacketAsSeen(msg.originatorMAC, msg.sequence);
 
     // 2. If this node is a gateway, process the data
+    if (mode == "gateway") {
+      seqTracker.onFrame(msg.originatorMAC, msg.sequence, millis());
+      if (PeerEntry* p = peerRegistry.find(msg.originatorMAC)) p->lastSeq = msg.sequence;
+    }
     if (mode == "gateway" && meshDataCallback != nullptr) {
       Serial.printf("[ESP-NOW] Gateway got data from %s. Hops left: %d\n", msg.sensorId, msg.hopCount);
+      msg.sensorId[sizeof(msg.sensorId) - 1] = '\0';
+      char fields[UPLINK_FIELDS_LEN];
+      snprintf(fields, sizeof(fields), "temp=%.2f,hum=%.2f,co2=%.2f", msg.temperature, msg.humidity, msg.co2);
       // Pass originator's MAC to the callback
-      meshDataCallback(msg.originatorMAC, msg.temperature, msg.humidity, msg.co2, msg.sequence, msg.sensorId);
+      meshDataCallback(msg.originatorMAC, msg.sensorId, fields, msg.sequence, 0);
     }
 
-    // 3. Forward the packet if hop limit is not reached
-    if (msg.hopCount > 1) {
+    // 3. Forward the packet if hop limit is not reached (a sleeping node is never a relay)
+    if (msg.hopCount > 1 && !dutyCycled) {
       msg.hopCount--; // Decrement hop count
 
       // Re-broadcast the modified message to all neighbors
@@ -357,16 +538,246 @@ private:
     }
   }
 
+  void handleDataV2Received(const uint8_t *data, int len) {
+    MeshFrameHeader hdr;
+    if (!parseMeshFrameHeader(data, len, hdr)) return;
+
+    if (dedup.checkAndMark(hdr.originatorMAC, hdr.sequence, millis())) {
+      return; // Drop duplicate packet
+    }
+
+    if (mode == "gateway") {
+      uint32_t txMs = 0;
+      bool hasTxTime = findMeshTxTime(data, len, txMs);
+      seqTracker.onFrame(hdr.originatorMAC, hdr.sequence, millis(), hasTxTime, txMs);
+      if (PeerEntry* p = peerRegistry.find(hdr.originatorMAC)) p->lastSeq = hdr.sequence;
+    }
+    if (mode == "gateway" && meshDataCallback != nullptr) {
+      deliverReadings(hdr, data, len);
+    }
+
+    // A routed frame ends at the gateway; floods keep going (other gateways)
+    if (mode == "gateway" && hdr.msgType == MSG_DATA_UP) return;
+    if (hdr.hopCount <= 1 || dutyCycled) return;
+
+    uint8_t fwd[MESH_FRAME_MAX];
+    memcpy(fwd, data, len);
+    fwd[MESH_FRAME_HOP_OFFSET] = hdr.hopCount - 1;
+    if (hdr.msgType == MSG_DATA_UP) lastRelayMs = millis();  // Someone routes through us
+    if (routingEnabled && mode != "gateway") {
+      routeUp(fwd, len);  // Floods from nodes without a route are picked up here too
+    } else {
+      esp_now_send(broadcastAddress, fwd, len);
+    }
+  }
+
+  // rxTask only: queue a data frame for the parent, or flood it if there is none
+  void routeUp(const uint8_t *frame, uint8_t len) {
+    if (!router.hasParent() || routeQueueCount >= ROUTE_TX_QUEUE) {
+      flood(frame, len);
+      return;
+    }
+    MeshTxFrame& t = routeQueue[(routeQueueHead + routeQueueCount) % ROUTE_TX_QUEUE];
+    memcpy(t.data, frame, len);
+    t.data[0] = MSG_DATA_UP;
+    t.len = len;
+    t.attempts = 0;
+    routeQueueCount++;
+    serviceRouteTx(millis());
+  }
+
+  void flood(const uint8_t *frame, uint8_t len) {
+    uint8_t out[MESH_FRAME_MAX];
+    memcpy(out, frame, len);
+    out[0] = MSG_DATA_V2;
+    if (out[MESH_FRAME_HOP_OFFSET] > MESH_DATA_HOPS) out[MESH_FRAME_HOP_OFFSET] = MESH_DATA_HOPS;
+    esp_now_send(broadcastAddress, out, len);
+    floodFallbacks++;
+  }
+
+  void popRouteQueue() {
+    routeQueueHead = (routeQueueHead + 1) % ROUTE_TX_QUEUE;
+    routeQueueCount--;
+  }
+
+  // rxTask only: resolve the unicast in flight, then send the next one
+  void serviceRouteTx(uint32_t now) {
+    if (routeInFlight) {
+      uint8_t status = routeTxStatus.load();
+      if (status == ROUTE_TX_PENDING && now - routeSentMs < ROUTE_ACK_TIMEOUT_MS) return;
+      routeInFlight = false;
+
+      bool ok = status == ROUTE_TX_OK;
+      router.onTxResult(routeDest, ok, now);  // May pick another parent
+      MeshTxFrame& t = routeQueue[routeQueueHead];
+      if (ok) {
+        routedUp++;
+        popRouteQueue();
+      } else if (++t.attempts > ROUTE_MAX_RETRIES || !router.hasParent()) {
+        flood(t.data, t.len);
+        popRouteQueue();
+      } else {
+        routeRetries++;
+      }
+    }
+
+    while (routeQueueCount > 0 && !routeInFlight) {
+      MeshTxFrame& t = routeQueue[routeQueueHead];
+      if (!router.hasParent() || !ensurePeer(router.parent())) {
+        flood(t.data, t.len);
+        popRouteQueue();
+        continue;
+      }
+      memcpy(routeDest, router.parent(), 6);
+      routeTxStatus.store(ROUTE_TX_PENDING);
+      routeSentMs = now;
+      routeInFlight = true;  // Before sending: the callback may run right away
+      if (esp_now_send(routeDest, t.data, t.len) != ESP_OK) {
+        routeTxStatus.store(ROUTE_TX_FAIL);  // Resolved on the next pass
+      }
+    }
+  }
+
+  bool ensurePeer(const uint8_t *mac) {
+    if (esp_now_is_peer_exist(mac)) return true;
+    esp_now_peer_info_t peerInfo = {};
+    memcpy(peerInfo.peer_addr, mac, 6);
+    peerInfo.channel = channel;
+    peerInfo.encrypt = false;
+    esp_err_t result = esp_now_add_peer(&peerInfo);
+    if (result == ESP_ERR_ESPNOW_FULL) {
+      // Driver table (ESP_NOW_MAX_TOTAL_PEER_NUM) full: reuse the least recently heard peer's slot
+      PeerEntry* victim = peerRegistry.leastRecentInDriver(mac);
+      if (victim) {
+        esp_now_del_peer(victim->mac);
+        victim->inDriver = false;
+        driverRecycled++;
+        result = esp_now_add_peer(&peerInfo);
+      }
+    }
+    return result == ESP_OK;
+  }
+
+  // Duty-cycled sensor, loop task: unicast to the paired peer and wait for
+  // its MAC ACK (a few ms); flood if it never comes. Returns true on ACK.
+  bool sendDirect(uint8_t *frame, uint8_t len) {
+    if (pairingState == PAIRED) {
+      frame[0] = MSG_DATA_UP;
+      frame[MESH_FRAME_HOP_OFFSET] = ROUTE_MAX_HOPS;
+      for (uint8_t attempt = 0; attempt <= ROUTE_MAX_RETRIES; attempt++) {
+        if (attempt > 0) routeRetries++;
+        directTxStatus.store(ROUTE_TX_PENDING);
+        directInFlight = true;  // Before sending: the callback may run right away
+        if (esp_now_send(gatewayMAC, frame, len) == ESP_OK) {
+          uint32_t start = millis();
+          while (directTxStatus.load() == ROUTE_TX_PENDING && millis() - start < ROUTE_ACK_TIMEOUT_MS) {
+            delay(1);
+          }
+        }
+        directInFlight = false;
+        if (directTxStatus.load() == ROUTE_TX_OK) {
+          routedUp++;
+          return true;
+        }
+      }
+    }
+    flood(frame, len);
+    return false;
+  }
+
+  // Gateway: one callback per reading in the frame
+  void deliverReadings(const MeshFrameHeader& hdr, const uint8_t *data, int len) {
+    MeshTlvReader reader(data, len);
+    uint8_t type, valueLen;
+    const uint8_t* value;
+    int delivered = 0;
+    uint16_t ageS = 0;
+
+    while (reader.next(type, value, valueLen)) {
+      if (valueLen < 2) continue;
+      uint16_t hash = meshTlvHash(value);
+
+      if (type == MESH_TLV_AGE) {
+        ageS = hash;  // Same u16 layout
+
+      } else if (type == MESH_TLV_SENSOR_NAME) {
+        meshNames.learn(hdr.originatorMAC, hash, (const char*)value + 2, valueLen - 2);
+
+      } else if (type == MESH_TLV_READING) {
+        char fields[UPLINK_FIELDS_LEN];
+        if (meshReadingToFields(value, valueLen, fields, sizeof(fields)) <= 0) continue;
+
+        // Name not announced yet (gateway rebooted): keep the data under its hash
+        const char* sensorId = meshNames.lookup(hdr.originatorMAC, hash);
+        char unnamed[8];
+        if (!sensorId) {
+          snprintf(unnamed, sizeof(unnamed), "s%04x", hash);
+          sensorId = unnamed;
+        }
+        meshDataCallback(hdr.originatorMAC, sensorId, fields, hdr.sequence, ageS);
+        delivered++;
+      }
+    }
+
+    Serial.printf("[ESP-NOW] Gateway got %d readings (seq %lu). Hops left: %d%s\n", delivered,
+                  (unsigned long)hdr.sequence, hdr.hopCount, reader.isTruncated() ? " [truncada]" : "");
+  }
+
+  // Sensor: include the name the first time and every MESH_NAME_REANNOUNCE frames
+  MeshAnnouncedSensor* announceSlot(uint16_t hash, bool& needsName) {
+    MeshAnnouncedSensor* oldest = &announced[0];
+    for (MeshAnnouncedSensor& a : announced) {
+      if (a.used && a.hash == hash) {
+        needsName = framesSent - a.frame >= MESH_NAME_REANNOUNCE;
+        return &a;
+      }
+      if (!a.used || (oldest->used && a.frame < oldest->frame)) oldest = &a;
+    }
+    needsName = true;
+    oldest->used = false;
+    return oldest;
+  }
+
+  void openFrame() {
+    txWriter.begin(MSG_DATA_V2, MESH_DATA_HOPS, deviceIdentity.staMac(), sequenceNumber++);
+    // Relative latency at the gateway; millis() restarts on every wake-up, so not when duty-cycled
+    if (!dutyCycled) txWriter.markTxTime();
+    txOpen = true;
+    cycleMarked = false;
+  }
+
+  // Several cycles per frame: readings carry the age of their cycle
+  bool addToFrame(uint16_t hash, const MeasurementSet& measurements, const char* announceName) {
+    if (aggregateCycles > 1 && !cycleMarked) {
+      if (!txWriter.beginCycle(cycleStartMs)) return false;
+      cycleMarked = true;
+    }
+    return txWriter.addReading(hash, measurements, announceName);
+  }
+
 public:
   ESPNowManager()
-    : mode("sensor"), enabled(false), channel(1), beaconInterval(2000),
+    : mode("sensor"), enabled(false), channel(1), beaconInterval(TRICKLE_DEFAULT_IMIN_MS),
+      beaconIntervalMax(TRICKLE_DEFAULT_IMAX_MS), beaconRedundancy(TRICKLE_DEFAULT_K),
       discoveryTimeout(15000), sendInterval(30000), pairingState(NOT_PAIRED),
-      bestGatewayRSSI(-100), lastBeaconTime(0), lastDiscoveryAttempt(0),
-      sequenceNumber(0), peerCount(0), lastPeerCleanup(0), seenPacketIndex(0),
+      bestGatewayRSSI(-100), lastBeaconTime(0), beaconSeq(0),
+      advertisedHops(ROUTE_NO_HOPS), advertisedHasParent(false),
+      trickleHeard(0), trickleInconsistent(false), lastRelayMs(0), lastDiscoveryAttempt(0),
+      sequenceNumber(0), lastPeerCleanup(0), peerCleanupDue(false), driverRecycled(0),
+      peerSnapshotState(SNAPSHOT_IDLE), peerSnapshotOut(nullptr), peerSnapshotMax(0), peerSnapshotCount(0),
+      rxTask(nullptr), rxFrames(0), lastRxRssi(0),
+      rxCallbacks(0), rxCallbackTotalUs(0), rxCallbackMaxUs(0),
+      txWriter(txFrame, sizeof(txFrame)), txOpen(false), framesSent(0),
+      aggregateCycles(1), cyclesInFrame(0), cycleOpen(false), cycleMarked(false),
+      cycleStartMs(0), txReadings(0), txBytes(0),
+      routingEnabled(true), routeQueueHead(0), routeQueueCount(0), routeInFlight(false),
+      routeSentMs(0), routeTxStatus(ROUTE_TX_PENDING), routedUp(0), routeRetries(0), floodFallbacks(0),
+      dutyCycled(false), directInFlight(false), directTxStatus(ROUTE_TX_PENDING),
       meshDataCallback(nullptr) {
     memset(gatewayMAC, 0, 6);
-    memset(peers, 0, sizeof(peers));
-    memset(seenPackets, 0, sizeof(seenPackets));
+    memset(announced, 0, sizeof(announced));
+    memset(routeDest, 0, 6);
+    memset(advertisedParent, 0, 6);
     instance = this;
   }
 
@@ -405,6 +816,20 @@ public:
       return false;
     }
 
+    router.begin(mode == "gateway", deviceIdentity.staMac(), beaconInterval);
+    const uint8_t* mac = deviceIdentity.staMac();
+    trickle.begin(beaconInterval, beaconIntervalMax, beaconRedundancy,
+                  ((uint32_t)mac[2] << 24) | ((uint32_t)mac[3] << 16) | ((uint32_t)mac[4] << 8) | mac[5]);
+
+    // Receive task before the callback that wakes it
+    if (!rxTask &&
+        xTaskCreatePinnedToCore(rxTaskEntry, "espnow_rx", ESPNOW_RX_TASK_STACK, this,
+                                ESPNOW_RX_TASK_PRIORITY, &rxTask, ESPNOW_RX_TASK_CORE) != pdPASS) {
+      Serial.println("[ESP-NOW] ✗ No se pudo crear la tarea de recepción");
+      esp_now_deinit();
+      return false;
+    }
+
     // Register callbacks
     esp_now_register_send_cb(onDataSentStatic);
     esp_now_register_recv_cb(onDataRecvStatic);
@@ -420,9 +845,9 @@ public:
     Serial.println("[ESP-NOW] ✓ Inicializado exitosamente");
 
     if (mode == "gateway") {
-      Serial.printf("  └─ MAC Gateway (SoftAP): %s\n", WiFi.softAPmacAddress().c_str());
+      Serial.printf("  └─ MAC Gateway (SoftAP): %s\n", deviceIdentity.apMacString());
     } else {
-      Serial.printf("  └─ MAC Sensor (Station): %s\n", WiFi.macAddress().c_str());
+      Serial.printf("  └─ MAC Sensor (Station): %s\n", deviceIdentity.staMacString());
     }
 
     return true;
@@ -433,28 +858,32 @@ public:
     meshDataCallback = callback;
   }
 
-  // Broadcast beacon (gateway and sensors)
+  // Broadcast beacon (gateway and sensors) when the Trickle timer says so
   void broadcastBeacon() {
     if (!enabled) return;
 
     uint32_t now = millis();
-    if (now - lastBeaconTime < beaconInterval) return;
+    for (uint8_t heard = trickleHeard.exchange(0); heard > 0; heard--) trickle.hearConsistent();
+
+    // Our own advert changed (parent, hops) or a neighbour needs it: fast beacons again
+    const uint8_t* parent = router.parent();
+    bool routeChanged = router.hops() != advertisedHops ||
+                        (parent ? memcmp(parent, advertisedParent, 6) != 0 : advertisedHasParent);
+    if (trickleInconsistent.exchange(false) || routeChanged) trickle.reset(now);
+
+    // The gateway anchors the gradient and relays keep their children's route alive
+    trickle.setSuppression(!routeChanged && mode != "gateway" && router.childCount() == 0 &&
+                           now - lastRelayMs > beaconIntervalMax);
+    if (!trickle.poll(now)) return;
+    sendBeacon(now);
+  }
 
-    DiscoveryMessage beacon;
+  void sendBeacon(uint32_t now) {
+    BeaconMessage msg;
+    DiscoveryMessage& beacon = msg.base;
     beacon.msgType = MSG_BEACON;
-    beacon.deviceId = ESP.getEfuseMac() & 0xFF;
-
-    // Use SoftAP MAC for gateway, Station MAC for sensor
-    if (mode == "gateway") {
-      String macStr = WiFi.softAPmacAddress();
-      if (macStr.length() > 0) {
-        sscanf(macStr.c_str(), "%hhx:%hhx:%hhx:%hhx:%hhx:%hhx", &beacon.macAddr[0], &beacon.macAddr[1], &beacon.macAddr[2], &beacon.macAddr[3], &beacon.macAddr[4], &beacon.macAddr[5]);
-      } else {
-        WiFi.macAddress(beacon.macAddr); // Fallback to station MAC
-      }
-    } else {
-      WiFi.macAddress(beacon.macAddr);
-    }
+    beacon.deviceId = deviceIdentity.shortId();
+    memcpy(beacon.macAddr, ownMac(), 6);  // SoftAP MAC for gateway, Station MAC for sensor
 
     beacon.channel = channel;  // Use configured channel instead of WiFi.channel()
 
@@ -465,14 +894,22 @@ public:
     }
     beacon.timestamp = now;
 
-    esp_now_send(broadcastAddress, (uint8_t*)&beacon, sizeof(beacon));
+    // Route advert (the router is updated by rxTask; a stale copy only lasts one beacon)
+    msg.route.hops = router.hops();
+    msg.route.pathCost = router.cost();
+    const uint8_t* parent = router.parent();
+    if (parent) memcpy(msg.route.parentMAC, parent, 6);
+    else memset(msg.route.parentMAC, 0, 6);
+    advertisedHops = msg.route.hops;
+    advertisedHasParent = parent != nullptr;
+    memcpy(advertisedParent, msg.route.parentMAC, 6);
+
+    msg.timing.beaconSeq = beaconSeq++;
+    uint32_t intervalDs = trickle.getInterval() / 100;
+    msg.timing.intervalDs = intervalDs > 0xFFFF ? 0xFFFF : intervalDs;
+
+    esp_now_send(broadcastAddress, (uint8_t*)&msg, sizeof(msg));
     lastBeaconTime = now;
-
-    // Periodic peer cleanup (gateway only)
-    if (mode == "gateway" && (now - lastPeerCleanup > 60000)) {  // Every minute
-      cleanupStalePeers();
-      lastPeerCleanup = now;
-    }
   }
 
   // Wait for gateway discovery (sensor only)
@@ -480,10 +917,11 @@ public:
     if (!enabled || mode != "sensor") return false;
 
     Serial.println("[ESP-NOW] Listening for gateway beacon...");
+    sendBeacon(millis());  // No route yet: neighbours on a slow Trickle interval reset to fast beacons
 
     unsigned long startTime = millis();
     while (pairingState != PAIRED && millis() - startTime < discoveryTimeout) {
-      delay(100);
+      delay(10);  // Pairing ends on rxTask; a short poll keeps wake-to-send low
     }
 
     if (pairingState == PAIRED) {
@@ -508,29 +946,89 @@ public:
     }
   }
 
-  // Send sensor data (sensor only)
-  bool sendSensorData(float temperature, float humidity, float co2, const char* sensorId) {
+  // Add a sensor's readings to the frame of this cycle (sensor only). A
+  // full frame is sent and a new one started.
+  bool queueReading(const char* sensorId, const MeasurementSet& measurements) {
     // In a flooding mesh, we don't need to be "paired" to send. We just broadcast.
     if (!enabled || mode != "sensor") {
       return false;
     }
 
-    SensorDataMessage msg;
-    msg.msgType = MSG_DATA;
-    msg.hopCount = 4; // Set initial hop limit (e.g., 4)
-    WiFi.macAddress(msg.originatorMAC); // This node is the originator
-    strncpy(msg.sensorId, sensorId, sizeof(msg.sensorId) - 1);
-    msg.sensorId[sizeof(msg.sensorId) - 1] = '\0'; // Asegurar null-termination    msg.temperature = temperature;
-    msg.humidity = humidity;
-    msg.co2 = co2;
-    msg.sequence = sequenceNumber++;
-
-    // Broadcast the data to all listening peers
-    esp_err_t result = esp_now_send(broadcastAddress, (uint8_t*)&msg, sizeof(msg));
+    uint16_t hash = meshSensorHash(sensorId);
+    bool needsName;
+    MeshAnnouncedSensor* slot = announceSlot(hash, needsName);
+
+    if (!cycleOpen) {
+      cycleOpen = true;
+      cycleStartMs = millis();
+    }
+    if (!txOpen) openFrame();
+    bool added = addToFrame(hash, measurements, needsName ? sensorId : nullptr);
+    if (!added && txWriter.readingCount() > 0) {
+      flushReadings();
+      openFrame();
+      added = addToFrame(hash, measurements, needsName ? sensorId : nullptr);
+    }
+    if (!added) {
+      Serial.printf("[ESP-NOW] ✗ %s: lectura sin campos válidos o demasiado grande\n", sensorId);
+      return false;
+    }
+
+    if (needsName) {
+      slot->hash = hash;
+      slot->used = true;
+      slot->frame = framesSent;
+    }
+    return true;
+  }
+
+  // End of a sampling cycle: the frame goes out every espnow_aggregate_cycles
+  // cycles, or earlier if it filled up (sensor only)
+  void endCycle() {
+    if (!cycleOpen) return;
+    cycleOpen = false;
+    cycleMarked = false;
+    if (++cyclesInFrame >= aggregateCycles) flushReadings();
+  }
+
+  // Send the open frame now, if it has readings (sensor only).
+  // Duty-cycled: true only if the paired peer acknowledged it
+  bool flushReadings() {
+    if (!txOpen || txWriter.readingCount() == 0) return false;
+    txOpen = false;
+    cyclesInFrame = 0;
+
+    txWriter.finish(millis());
+    if (dutyCycled) {
+      bool acked = sendDirect(txFrame, txWriter.length());
+      framesSent++;
+      txReadings += txWriter.readingCount();
+      txBytes += txWriter.length();
+      Serial.printf("[ESP-NOW] Data %s: %d lecturas, %u bytes\n", acked ? "ACK" : "sin ACK, inundada",
+                    txWriter.readingCount(), (unsigned)txWriter.length());
+      return acked;
+    }
+
+    esp_err_t result;
+    MeshTxFrame* routed = routingEnabled ? ownTxRing.reserve() : nullptr;
+    if (routed) {
+      // rxTask sends it to the parent (or floods it if there is no route)
+      routed->len = txWriter.length();
+      memcpy(routed->data, txFrame, routed->len);
+      routed->data[MESH_FRAME_HOP_OFFSET] = ROUTE_MAX_HOPS;
+      ownTxRing.commit();
+      xTaskNotifyGive(rxTask);
+      result = ESP_OK;
+    } else {
+      result = esp_now_send(broadcastAddress, txFrame, txWriter.length());
+    }
+    framesSent++;
+    txReadings += txWriter.readingCount();
+    txBytes += txWriter.length();
 
     if (result == ESP_OK) {
-      Serial.printf("[ESP-NOW] Data broadcasted: T=%.1f H=%.1f CO2=%.0f\n",
-                    temperature, humidity, co2);
+      Serial.printf("[ESP-NOW] Data %s: %d lecturas, %u bytes\n", routed ? "routed" : "broadcasted",
+                    txWriter.readingCount(), (unsigned)txWriter.length());
       return true;
     } else {
       Serial.printf("[ESP-NOW] Broadcast failed: %d\n", result);
@@ -548,27 +1046,146 @@ public:
     return mode;
   }
 
-  // Get peer count (gateway only)
-  int getPeerCount() const {
-    return peerCount;
+  // Beacon timing (call before init): beacon_interval_ms is the fastest interval
+  void setBeaconTiming(uint16_t minMs, uint32_t maxMs, uint8_t redundancy) {
+    beaconInterval = minMs ? minMs : TRICKLE_DEFAULT_IMIN_MS;
+    beaconIntervalMax = maxMs < beaconInterval ? beaconInterval : maxMs;
+    beaconRedundancy = redundancy;
   }
 
+  const TrickleTimer& getTrickle() const { return trickle; }
+
   // Get active peer count (gateway only)
   int getActivePeerCount() const {
-    int count = 0;
-    for (int i = 0; i < MAX_PEERS; i++) {
-      if (peers[i].active) count++;
+    return peerRegistry.size();
+  }
+
+  // Peers tracked by the gateway, 1..PEER_REGISTRY_MAX_CAPACITY (call before init)
+  void setMaxPeers(uint16_t capacity) {
+    peerRegistry.begin(capacity);
+  }
+
+  uint16_t getPeerCapacity() const { return peerRegistry.getCapacity(); }
+
+  // Copy of the peer registry, most recent first, taken on rxTask (which
+  // mutates it) so the web handler never walks it concurrently. Waits up to
+  // PEER_SNAPSHOT_TIMEOUT_MS; returns the entries copied, or -1 if rxTask
+  // did not get to it in time.
+  int snapshotPeers(PeerEntry* out, uint16_t maxEntries, PeerRegistryStats& stats) {
+    if (!enabled || !rxTask) return -1;
+    peerSnapshotOut = out;
+    peerSnapshotMax = maxEntries;
+    peerSnapshotState.store(SNAPSHOT_REQUESTED);
+    xTaskNotifyGive(rxTask);
+
+    uint32_t start = millis();
+    while (peerSnapshotState.load() == SNAPSHOT_REQUESTED && millis() - start < PEER_SNAPSHOT_TIMEOUT_MS) {
+      delay(1);
     }
+    uint8_t expected = SNAPSHOT_REQUESTED;
+    if (peerSnapshotState.compare_exchange_strong(expected, SNAPSHOT_IDLE)) return -1;  // Timed out
+    while (peerSnapshotState.load() != SNAPSHOT_DONE) delay(1);  // Copy under way: a few us
+    stats = peerSnapshotStats;
+    int count = peerSnapshotCount;
+    peerSnapshotState.store(SNAPSHOT_IDLE);
     return count;
   }
+  uint32_t getDriverRecycled() const { return driverRecycled; }
 
   // Get MAC address as string
-  String getMACAddress() const {
-    if (mode == "gateway") {
-      return WiFi.softAPmacAddress();
-    } else {
-      return WiFi.macAddress();
+  const char* getMACAddress() const {
+    return mode == "gateway" ? deviceIdentity.apMacString() : deviceIdentity.staMacString();
+  }
+
+  // Gradient routing on/off (call before init); off = flooding only
+  void setRouting(bool enable) {
+    routingEnabled = enable;
+  }
+
+  // Deep sleep between readings (sensor only): no relaying, no pairing
+  // requests answered, own frames unicast to the paired peer with ACK
+  void setDutyCycled(bool enable) {
+    dutyCycled = enable;
+  }
+
+  bool isDutyCycled() const { return dutyCycled; }
+
+  // How long waitForDiscovery() listens for a beacon
+  void setDiscoveryTimeout(uint16_t timeoutMs) {
+    discoveryTimeout = timeoutMs;
+  }
+
+  // State to keep in RTC memory before deep sleep (flush the open frame first)
+  void saveResumeState(EspNowResumeState& state) const {
+    state.magic = ESPNOW_RESUME_MAGIC;
+    memcpy(state.peerMAC, gatewayMAC, 6);
+    state.channel = channel;
+    state.paired = pairingState == PAIRED;
+    state.sequence = sequenceNumber;
+    state.framesSent = framesSent;
+    memcpy(state.announced, announced, sizeof(announced));
+  }
+
+  // Resume after deep sleep (call after init): paired again without discovery.
+  // Returns false if the RTC memory holds no valid state (power loss).
+  bool restoreResumeState(const EspNowResumeState& state) {
+    if (state.magic != ESPNOW_RESUME_MAGIC) return false;
+    sequenceNumber = state.sequence;
+    framesSent = state.framesSent;
+    memcpy(announced, state.announced, sizeof(announced));
+    if (state.paired) {
+      memcpy(gatewayMAC, state.peerMAC, 6);
+      if (ensurePeer(gatewayMAC)) pairingState = PAIRED;
     }
+    return true;
+  }
+
+  // Route state (read from the loop while rxTask updates it: values may lag one frame)
+  bool isRoutingEnabled() const { return routingEnabled; }
+  const MeshRouter& getRouter() const { return router; }
+  uint32_t getRoutedUp() const { return routedUp; }
+  uint32_t getRouteRetries() const { return routeRetries; }
+  uint32_t getFloodFallbacks() const { return floodFallbacks; }
+
+  // Sampling cycles packed into one frame (sensor only)
+  void setAggregateCycles(uint8_t cycles) {
+    if (cycles < 1) cycles = 1;
+    if (cycles > MESH_AGGREGATE_MAX_CYCLES) cycles = MESH_AGGREGATE_MAX_CYCLES;
+    aggregateCycles = cycles;
+  }
+
+  // Frames originated by this sensor
+  uint8_t getAggregateCycles() const { return aggregateCycles; }
+  uint32_t getTxFrames() const { return framesSent; }
+  uint32_t getTxReadings() const { return txReadings; }
+  uint32_t getTxBytes() const { return txBytes; }
+
+  // Originators tracked by the duplicate filter (call before init)
+  void setDedupCapacity(uint16_t capacity) {
+    dedup.begin(capacity);
+  }
+
+  const MeshDedupStats& getDedupStats() const {
+    return dedup.getStats();
+  }
+
+  // Per-originator delivery stats (gateway only)
+  const MeshSeqTracker& getSeqTracker() const {
+    return seqTracker;
+  }
+
+  // Receive ring (WiFi callback → rxTask)
+  uint32_t getRxFrames() const { return rxFrames; }
+  uint32_t getRxQueueDepth() const { return rxRing.size(); }
+  uint32_t getRxQueueHighWater() const { return rxRing.getHighWater(); }
+  uint32_t getRxQueueDropped() const { return rxRing.getDropped(); }
+  int8_t getLastRxRssi() const { return lastRxRssi; }
+
+  // Receive callback timing
+  uint32_t getRxCallbackCount() const { return rxCallbacks; }
+  uint32_t getRxCallbackMaxUs() const { return rxCallbackMaxUs; }
+  uint32_t getRxCallbackAvgUs() const {
+    return rxCallbacks ? (uint32_t)(rxCallbackTotalUs / rxCallbacks) : 0;
   }
 
   // Check if enabled
@@ -583,6 +1200,14 @@ public:
     // All nodes broadcast beacons to build and maintain the mesh
     broadcastBeacon();
 
+    // Periodic peer cleanup (gateway only), on rxTask which owns the registry
+    uint32_t now = millis();
+    if (mode == "gateway" && (now - lastPeerCleanup > 60000)) {  // Every minute
+      peerCleanupDue.store(true);
+      xTaskNotifyGive(rxTask);
+      lastPeerCleanup = now;
+    }
+
     if (mode == "sensor") {
       retryDiscoveryIfNeeded();
     }
@@ -0,0 +1,279 @@
+#ifndef MEASUREMENT_H
+#define MEASUREMENT_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include "lineProtocol.h"
+
+#define MEASUREMENT_MAX             8    // Campos por lectura (ModbusSensor: MODBUS_SENSOR_MAX_FIELDS)
+#define MEASUREMENT_FIELD_NAME_MAX  15   // Nombre más largo de un campo en MeasurementTable
+
+/**
+ * Lectura tipada de un sensor: un arreglo de Measurement (campo, valor,
+ * calidad, momento de la lectura) que el sensor llena en getMeasurements().
+ *
+ * Reemplaza al string preformateado ("temp=25.30,hum=60.50"): cada destino
+ * (line protocol, trama de la malla, RS485, JSON) codifica directamente
+ * desde los valores, una sola vez y sin volver a parsear texto.
+ *
+ * Los campos conocidos tienen id fijo en MEASUREMENT_FIELDS, que es también
+ * el id en la trama de la malla; el resto (ej: campos de un mapa Modbus
+ * propio) van como MEAS_NAMED con su nombre.
+ */
+
+enum MeasurementField : uint8_t {
+    MEAS_TEMP      = 1,
+    MEAS_HUM       = 2,
+    MEAS_CO2       = 3,
+    MEAS_PRESS     = 4,
+    MEAS_SOIL_HUM  = 5,
+    MEAS_SOIL_TEMP = 6,
+    MEAS_EC        = 7,
+    MEAS_PH        = 8,
+    MEAS_N         = 9,
+    MEAS_P         = 10,
+    MEAS_K         = 11,
+    MEAS_NAMED     = 0x7F   // Fuera de la tabla: nombre en Measurement::name
+};
+
+enum MeasurementQuality : uint8_t {
+    MEAS_OK,        // Valor válido
+    MEAS_CLAMPED,   // Fuera del rango del sensor, recortado al límite (se publica)
+    MEAS_INVALID    // Sin valor (sensor desconectado, conversión fallida): no se publica
+};
+
+struct MeasurementFieldDef {
+    uint8_t id;
+    const char* name;
+    uint8_t decimals;
+};
+
+// Ids fijos: no reutilizar ni renumerar (los gateways viejos los interpretan)
+static const MeasurementFieldDef MEASUREMENT_FIELDS[] = {
+    {MEAS_TEMP,      "temp",     2},
+    {MEAS_HUM,       "hum",      2},
+    {MEAS_CO2,       "co2",      1},
+    {MEAS_PRESS,     "press",    2},
+    {MEAS_SOIL_HUM,  "soilHum",  2},
+    {MEAS_SOIL_TEMP, "soilTemp", 1},
+    {MEAS_EC,        "ec",       0},
+    {MEAS_PH,        "ph",       1},
+    {MEAS_N,         "n",        0},
+    {MEAS_P,         "p",        0},
+    {MEAS_K,         "k",        0},
+};
+
+inline const MeasurementFieldDef* findMeasurementField(const char* name, size_t len) {
+    for (const MeasurementFieldDef& f : MEASUREMENT_FIELDS) {
+        if (strlen(f.name) == len && strncmp(f.name, name, len) == 0) return &f;
+    }
+    return nullptr;
+}
+
+inline const MeasurementFieldDef* findMeasurementFieldById(uint8_t id) {
+    for (const MeasurementFieldDef& f : MEASUREMENT_FIELDS) {
+        if (f.id == id) return &f;
+    }
+    return nullptr;
+}
+
+struct Measurement {
+    uint8_t field;          // MeasurementField
+    uint8_t decimals;       // Al formatear como texto
+    uint8_t quality;        // MeasurementQuality
+    const char* name;       // De la tabla, o del sensor (vive lo que vive el sensor)
+    float value;
+    uint32_t timestampMs;   // millis() de la lectura
+};
+
+class MeasurementSet {
+public:
+    MeasurementSet() : count(0) {}
+
+    void clear() { count = 0; }
+
+    // Campo de la tabla, con sus decimales
+    bool add(MeasurementField field, float value, uint32_t timestampMs, uint8_t quality = MEAS_OK) {
+        const MeasurementFieldDef* def = findMeasurementFieldById(field);
+        if (!def) return false;
+        return push({def->id, def->decimals, quality, def->name, value, timestampMs});
+    }
+
+    // Campo por nombre (ej: mapa Modbus). Si está en la tabla usa su id, así la malla lo codifica compacto.
+    bool addNamed(const char* name, float value, uint8_t decimals, uint32_t timestampMs, uint8_t quality = MEAS_OK) {
+        if (!name || !name[0]) return false;
+        const MeasurementFieldDef* def = findMeasurementField(name, strlen(name));
+        return push({def ? def->id : (uint8_t)MEAS_NAMED, decimals, quality, def ? def->name : name, value, timestampMs});
+    }
+
+    bool push(const Measurement& m) {
+        if (count >= MEASUREMENT_MAX) return false;
+        items[count++] = m;
+        return true;
+    }
+
+    uint8_t size() const { return count; }
+    const Measurement& operator[](uint8_t i) const { return items[i]; }
+    const Measurement* begin() const { return items; }
+    const Measurement* end() const { return items + count; }
+
+    const Measurement* find(uint8_t field) const {
+        for (uint8_t i = 0; i < count; i++) {
+            if (items[i].field == field && field != MEAS_NAMED) return &items[i];
+        }
+        return nullptr;
+    }
+
+    // Valor del campo si está y es publicable; fallback si no
+    float valueOr(uint8_t field, float fallback) const {
+        const Measurement* m = find(field);
+        return (m && m->quality != MEAS_INVALID) ? m->value : fallback;
+    }
+
+    // Mediciones que se publican (calidad distinta de MEAS_INVALID)
+    uint8_t publishable() const {
+        uint8_t n = 0;
+        for (uint8_t i = 0; i < count; i++) {
+            if (items[i].quality != MEAS_INVALID) n++;
+        }
+        return n;
+    }
+
+private:
+    Measurement items[MEASUREMENT_MAX];
+    uint8_t count;
+};
+
+/**
+ * Estado por campo de las mediciones de un sensor (ventana de reporte,
+ * banda muerta), con la misma clave que la malla: el id de
+ * MEASUREMENT_FIELDS, o el nombre si es MEAS_NAMED.
+ *
+ * Tiene lugar para MEASUREMENT_MAX campos, los que entran en una lectura;
+ * las entradas no se borran (un sensor reporta siempre los mismos campos).
+ * findOrAdd() devuelve nullptr si la tabla está llena o el nombre es más
+ * largo que MEASUREMENT_FIELD_NAME_MAX, y added indica si la entrada es
+ * nueva (state recién construido) para que el dueño la inicialice.
+ */
+template <typename T>
+class MeasurementTable {
+public:
+    struct Entry {
+        uint8_t field;                                // MeasurementField
+        char name[MEASUREMENT_FIELD_NAME_MAX + 1];
+        T state;
+    };
+
+    MeasurementTable() : count(0) {}
+
+    Entry* find(uint8_t field, const char* name) {
+        int i = indexOf(field, name);
+        return i >= 0 ? &entries[i] : nullptr;
+    }
+
+    const Entry* find(uint8_t field, const char* name) const {
+        int i = indexOf(field, name);
+        return i >= 0 ? &entries[i] : nullptr;
+    }
+
+    // Por nombre (configuración): los de la tabla se buscan por id
+    const Entry* find(const char* name) const {
+        return find(fieldOf(name), name);
+    }
+
+    Entry* findOrAdd(uint8_t field, const char* name, bool& added) {
+        added = false;
+        Entry* e = find(field, name);
+        if (e) return e;
+        size_t nameLen = name ? strlen(name) : 0;
+        if (nameLen == 0 || nameLen > MEASUREMENT_FIELD_NAME_MAX || count >= MEASUREMENT_MAX) return nullptr;
+        e = &entries[count++];
+        e->field = field;
+        memcpy(e->name, name, nameLen + 1);
+        e->state = T();
+        added = true;
+        return e;
+    }
+
+    Entry* findOrAdd(const Measurement& m, bool& added) {
+        return findOrAdd(m.field, m.name, added);
+    }
+
+    Entry* findOrAdd(const char* name, bool& added) {
+        return findOrAdd(fieldOf(name), name, added);
+    }
+
+    uint8_t size() const { return count; }
+    Entry& operator[](uint8_t i) { return entries[i]; }
+    const Entry& operator[](uint8_t i) const { return entries[i]; }
+
+private:
+    Entry entries[MEASUREMENT_MAX];
+    uint8_t count;
+
+    int indexOf(uint8_t field, const char* name) const {
+        for (uint8_t i = 0; i < count; i++) {
+            if (entries[i].field != field) continue;
+            if (field != MEAS_NAMED || strcmp(entries[i].name, name) == 0) return i;
+        }
+        return -1;
+    }
+
+    static uint8_t fieldOf(const char* name) {
+        const MeasurementFieldDef* def = name ? findMeasurementField(name, strlen(name)) : nullptr;
+        return def ? def->id : (uint8_t)MEAS_NAMED;
+    }
+};
+
+/**
+ * Campos de line protocol ("temp=25.30,hum=60.50") de las mediciones
+ * publicables desde la medición next, tantos como entren enteros en cap.
+ * Las claves se escapan como en LineProtocolWriter ("soil temp" →
+ * "soil\ temp"). Avanza next y devuelve la cantidad de campos escritos (0
+ * cuando ya no quedan): se llama de nuevo para partir una lectura en
+ * varias líneas. Un campo que no entra ni solo en una línea vacía se saltea.
+ */
+inline uint8_t measurementsToFields(const MeasurementSet& set, char* out, size_t cap, uint8_t& next) {
+    if (cap == 0) return 0;
+    out[0] = '\0';
+    size_t used = 0;
+    uint8_t written = 0;
+
+    for (; next < set.size(); next++) {
+        const Measurement& m = set[next];
+        if (m.quality == MEAS_INVALID || isnan(m.value) || isinf(m.value)) continue;
+        // La clave escapada (los nombres de un mapa Modbus vienen de config.json)
+        size_t nameLen = 0;
+        for (const char* c = m.name; *c; c++) {
+            char esc[2];
+            nameLen += escapeLineProtocolChar(*c, true, esc);
+        }
+        size_t start = used + (used ? 1 : 0);
+
+        char value[24];
+        size_t valueLen = formatFixed(value, sizeof(value), m.value, m.decimals);
+        if (valueLen == 0 || start + nameLen + 1 + valueLen >= cap) {
+            if (used) break;
+            continue;   // No entra ni solo
+        }
+
+        if (used) out[used++] = ',';
+        for (const char* c = m.name; *c; c++) used += escapeLineProtocolChar(*c, true, out + used);
+        out[used++] = '=';
+        memcpy(out + used, value, valueLen);
+        used += valueLen;
+        out[used] = '\0';
+        written++;
+    }
+    return written;
+}
+
+// Todos los campos que entran en una línea
+inline uint8_t measurementsToFields(const MeasurementSet& set, char* out, size_t cap) {
+    uint8_t next = 0;
+    return measurementsToFields(set, out, cap, next);
+}
+
+#endif // MEASUREMENT_H
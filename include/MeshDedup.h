@@ -0,0 +1,195 @@
+#ifndef MESH_DEDUP_H
+#define MESH_DEDUP_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define MESH_DEDUP_DEFAULT_CAPACITY 32      // Originadores recordados
+#define MESH_DEDUP_MAX_CAPACITY     64
+#define MESH_DEDUP_WINDOW_BITS      32      // Secuencias recientes por originador
+#define MESH_DEDUP_IDLE_MS          300000  // Sin noticias en 5 min: se olvida la ventana
+
+struct MeshDedupStats {
+    uint16_t originators;
+    uint16_t capacity;
+    uint32_t lookups;
+    uint32_t duplicates;
+    uint32_t resets;      // Ventanas reiniciadas (reboot del originador o inactividad)
+    uint32_t evictions;   // Originadores desalojados por falta de lugar
+    uint8_t maxProbe;     // Peor cantidad de slots visitados en una búsqueda
+};
+
+/**
+ * Detección de duplicados para el flooding de la malla.
+ *
+ * Una entrada por originador (no por paquete) en una tabla hash de
+ * direccionamiento abierto con sondeo lineal: la MAC del originador da el
+ * slot y cada entrada guarda la secuencia más alta vista más un bitmap de
+ * las 32 anteriores (ventana deslizante, como el anti-replay de IPsec).
+ * checkAndMark() es O(1) y la memoria es fija (MESH_DEDUP_MAX_CAPACITY
+ * originadores, ~2.5 KB); la tabla se llena a lo sumo a la mitad.
+ *
+ * Una secuencia más vieja que la ventana se toma como reinicio del
+ * originador (el contador vuelve a 0 al bootear) y no como duplicado: las
+ * copias de un flood llegan a milisegundos, no 32 envíos después.
+ */
+class MeshDedup {
+public:
+    MeshDedup() { begin(MESH_DEDUP_DEFAULT_CAPACITY); }
+
+    // Cantidad de originadores a recordar (1..MESH_DEDUP_MAX_CAPACITY). Borra la tabla.
+    void begin(uint16_t capacity) {
+        if (capacity < 1) capacity = 1;
+        if (capacity > MESH_DEDUP_MAX_CAPACITY) capacity = MESH_DEDUP_MAX_CAPACITY;
+        cap = capacity;
+        tableSize = 1;
+        while (tableSize < cap * 2) tableSize <<= 1;
+        clear();
+    }
+
+    void clear() {
+        memset(table, 0, sizeof(table));
+        memset(&stats, 0, sizeof(stats));
+        stats.capacity = cap;
+    }
+
+    /**
+     * Devuelve true si (mac, seq) ya se vio. Si no, lo registra.
+     */
+    bool checkAndMark(const uint8_t* mac, uint32_t seq, uint32_t now) {
+        stats.lookups++;
+
+        uint8_t probes = 0;
+        int idx = find(mac, probes);
+        if (probes > stats.maxProbe) stats.maxProbe = probes;
+
+        if (idx < 0) {
+            insert(mac, seq, now);
+            return false;
+        }
+
+        Entry& e = table[idx];
+        if (now - e.lastSeen > MESH_DEDUP_IDLE_MS) {
+            resetWindow(e, seq, now);
+            stats.resets++;
+            return false;
+        }
+        e.lastSeen = now;
+
+        int32_t ahead = (int32_t)(seq - e.highest);
+        if (ahead > 0) {
+            e.window = (ahead >= MESH_DEDUP_WINDOW_BITS) ? 1 : ((e.window << ahead) | 1);
+            e.highest = seq;
+            return false;
+        }
+
+        uint32_t behind = (uint32_t)(-ahead);
+        if (behind >= MESH_DEDUP_WINDOW_BITS) {
+            resetWindow(e, seq, now);
+            stats.resets++;
+            return false;
+        }
+
+        uint32_t bit = 1UL << behind;
+        if (e.window & bit) {
+            stats.duplicates++;
+            return true;
+        }
+        e.window |= bit;   // Llegó fuera de orden, primera vez
+        return false;
+    }
+
+    const MeshDedupStats& getStats() const { return stats; }
+    uint16_t getCapacity() const { return cap; }
+
+private:
+    struct Entry {
+        uint8_t mac[6];
+        bool used;
+        uint32_t highest;
+        uint32_t window;    // bit i = se vio (highest - i)
+        uint32_t lastSeen;
+    };
+
+    Entry table[MESH_DEDUP_MAX_CAPACITY * 2];
+    uint16_t tableSize;
+    uint16_t cap;
+    MeshDedupStats stats;
+
+    // FNV-1a sobre los 6 bytes
+    static uint32_t hashMac(const uint8_t* mac) {
+        uint32_t h = 2166136261UL;
+        for (int i = 0; i < 6; i++) {
+            h ^= mac[i];
+            h *= 16777619UL;
+        }
+        return h;
+    }
+
+    int find(const uint8_t* mac, uint8_t& probes) const {
+        uint16_t mask = tableSize - 1;
+        uint16_t i = hashMac(mac) & mask;
+        for (probes = 1; probes <= tableSize; probes++) {
+            const Entry& e = table[i];
+            if (!e.used) return -1;
+            if (memcmp(e.mac, mac, 6) == 0) return i;
+            i = (i + 1) & mask;
+        }
+        return -1;
+    }
+
+    static void resetWindow(Entry& e, uint32_t seq, uint32_t now) {
+        e.highest = seq;
+        e.window = 1;
+        e.lastSeen = now;
+    }
+
+    void insert(const uint8_t* mac, uint32_t seq, uint32_t now) {
+        if (stats.originators >= cap) {
+            evictOldest();
+        }
+        uint16_t mask = tableSize - 1;
+        uint16_t i = hashMac(mac) & mask;
+        while (table[i].used) i = (i + 1) & mask;
+
+        Entry& e = table[i];
+        memcpy(e.mac, mac, 6);
+        e.used = true;
+        resetWindow(e, seq, now);
+        stats.originators++;
+    }
+
+    // Solo cuando la tabla está llena y aparece un originador nuevo (recorre la tabla)
+    void evictOldest() {
+        int oldest = -1;
+        for (int i = 0; i < tableSize; i++) {
+            if (table[i].used && (oldest < 0 || (int32_t)(table[i].lastSeen - table[oldest].lastSeen) < 0)) {
+                oldest = i;
+            }
+        }
+        if (oldest < 0) return;
+        remove(oldest);
+        stats.evictions++;
+    }
+
+    // Borrado con corrimiento hacia atrás: mantiene las cadenas de sondeo sin lápidas
+    void remove(int idx) {
+        uint16_t mask = tableSize - 1;
+        uint16_t hole = idx;
+        uint16_t i = (hole + 1) & mask;
+        while (table[i].used) {
+            uint16_t home = hashMac(table[i].mac) & mask;
+            // ¿home está fuera del intervalo cíclico (hole, i]? entonces se puede mover al hueco
+            bool movable = (i > hole) ? (home <= hole || home > i) : (home <= hole && home > i);
+            if (movable) {
+                table[hole] = table[i];
+                hole = i;
+            }
+            i = (i + 1) & mask;
+        }
+        table[hole].used = false;
+        stats.originators--;
+    }
+};
+
+#endif // MESH_DEDUP_H
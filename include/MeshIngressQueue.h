@@ -0,0 +1,247 @@
+#ifndef MESH_INGRESS_QUEUE_H
+#define MESH_INGRESS_QUEUE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include "MeshPayload.h"
+
+#define MESH_INGRESS_DEFAULT_DEPTH 32
+#define MESH_INGRESS_MAX_DEPTH     64
+#define MESH_INGRESS_OCC_BUCKETS   5    // 0-25%, 25-50%, 50-75%, 75-<100%, lleno
+#define MESH_INGRESS_LAT_BUCKETS   6    // <10ms, <100ms, <500ms, <1s, <5s, >=5s
+
+enum MeshOverflowPolicy : uint8_t {
+    MESH_DROP_NEWEST,   // Se descarta la lectura que llega
+    MESH_DROP_OLDEST,   // Se descarta la más vieja en cola
+    MESH_COALESCE       // Se reemplaza la lectura en cola del mismo originador y sensor;
+                        // si no hay, se descarta la más vieja
+};
+
+// Lectura de la malla entregada al loop
+struct MeshReading {
+    uint8_t originatorMAC[6];
+    char sensorId[32];
+    char fields[UPLINK_FIELDS_LEN];   // "temp=25.30,hum=60.50"
+    uint32_t seq;
+    uint16_t ageS;                          // Antigüedad al enviarse (ciclos agregados)
+    uint32_t enqueuedMs;
+};
+
+struct MeshIngressStats {
+    uint32_t enqueued;
+    uint32_t delivered;
+    uint32_t droppedNewest;
+    uint32_t droppedOldest;
+    uint32_t coalesced;
+    uint16_t highWater;
+    uint32_t occupancy[MESH_INGRESS_OCC_BUCKETS];   // Ocupación vista por cada push
+    uint32_t latency[MESH_INGRESS_LAT_BUCKETS];     // Tiempo en cola de cada lectura entregada
+    uint32_t maxLatencyMs;
+};
+
+inline bool parseMeshOverflowPolicy(const char* s, MeshOverflowPolicy& out) {
+    if (!s) return false;
+    if (strcmp(s, "drop_newest") == 0) { out = MESH_DROP_NEWEST; return true; }
+    if (strcmp(s, "drop_oldest") == 0) { out = MESH_DROP_OLDEST; return true; }
+    if (strcmp(s, "coalesce") == 0)    { out = MESH_COALESCE;    return true; }
+    return false;
+}
+
+inline const char* meshOverflowPolicyName(MeshOverflowPolicy p) {
+    switch (p) {
+        case MESH_DROP_NEWEST: return "drop_newest";
+        case MESH_DROP_OLDEST: return "drop_oldest";
+        case MESH_COALESCE:    return "coalesce";
+    }
+    return "?";
+}
+
+/**
+ * Cola de ingreso de la malla: tarea espnow_rx (productor) → loop (consumidor).
+ *
+ * head lo escribe solo el productor. tail lo avanza quien es dueño del slot
+ * más viejo: el consumidor al leerlo, o el productor al descartarlo
+ * (drop-oldest). La propiedad se toma con un CAS sobre el estado del slot
+ * (READY → READING / DROPPING / WRITING), así productor y consumidor nunca
+ * tocan el mismo slot a la vez y ninguno espera a que el otro libere un
+ * lock: si el CAS falla se reintenta con el estado nuevo.
+ *
+ * Cada slot guarda además la posición (head) con la que se escribió. El
+ * consumidor lee tail y después toma el slot: en ese hueco el productor
+ * puede descartar la lectura y escribir otra en el mismo slot (ABA). Por
+ * eso, con el slot ya tomado, el consumidor compara su posición con la
+ * tail que leyó y, si no coincide, lo devuelve y reintenta.
+ *
+ * La profundidad se redondea a potencia de 2 (los índices se enmascaran).
+ */
+class MeshIngressQueue {
+public:
+    MeshIngressQueue() { begin(MESH_INGRESS_DEFAULT_DEPTH, MESH_DROP_OLDEST); }
+
+    // Llamar antes de que arranquen productor y consumidor
+    void begin(uint16_t depth, MeshOverflowPolicy overflowPolicy) {
+        if (depth < 2) depth = 2;
+        if (depth > MESH_INGRESS_MAX_DEPTH) depth = MESH_INGRESS_MAX_DEPTH;
+        cap = 1;
+        while (cap < depth) cap <<= 1;
+        policy = overflowPolicy;
+        head.store(0, std::memory_order_relaxed);
+        tail.store(0, std::memory_order_relaxed);
+        for (int i = 0; i < MESH_INGRESS_MAX_DEPTH; i++) {
+            state[i].store(EMPTY, std::memory_order_relaxed);
+            position[i] = 0;
+        }
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    // Productor. Devuelve false si la lectura no quedó en cola.
+    bool push(const MeshReading& reading, uint32_t now) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t used = h - tail.load(std::memory_order_acquire);
+        recordOccupancy(used);
+
+        if (used >= cap) {
+            if (policy == MESH_COALESCE && coalesce(reading)) {
+                stats.coalesced++;
+                return true;
+            }
+            if (policy == MESH_DROP_NEWEST || !makeRoom(h)) {
+                stats.droppedNewest++;
+                return false;
+            }
+        }
+
+        uint32_t i = h & (cap - 1);
+        slots[i] = reading;
+        slots[i].enqueuedMs = now;
+        position[i] = h;
+        state[i].store(READY, std::memory_order_release);
+        head.store(h + 1, std::memory_order_release);
+
+        stats.enqueued++;
+        uint32_t depthNow = h + 1 - tail.load(std::memory_order_acquire);
+        if (depthNow > stats.highWater) stats.highWater = depthNow;
+        return true;
+    }
+
+    // Consumidor
+    bool pop(MeshReading& out, uint32_t now) {
+        for (int attempt = 0; attempt < POP_ATTEMPTS; attempt++) {
+            uint32_t t = tail.load(std::memory_order_acquire);
+            if (t == head.load(std::memory_order_acquire)) return false;
+
+            uint32_t i = t & (cap - 1);
+#ifdef UNIT_TEST
+            if (popRaceHook) popRaceHook(this);
+#endif
+            uint8_t expected = READY;
+            if (!state[i].compare_exchange_strong(expected, READING, std::memory_order_acquire)) {
+                continue;   // El productor lo está descartando o actualizando: reintentar
+            }
+            if (position[i] != t) {
+                // Entre la lectura de tail y el CAS el productor descartó la
+                // lectura y reusó el slot: no es la más vieja, devolverlo
+                state[i].store(READY, std::memory_order_release);
+                continue;
+            }
+            out = slots[i];
+            state[i].store(EMPTY, std::memory_order_release);
+            tail.store(t + 1, std::memory_order_release);
+
+            stats.delivered++;
+            recordLatency(now - out.enqueuedMs);
+            return true;
+        }
+        return false;   // El productor sigue con el slot; se retoma en la próxima pasada
+    }
+
+    uint16_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+    uint16_t capacity() const { return cap; }
+    MeshOverflowPolicy getPolicy() const { return policy; }
+    const MeshIngressStats& getStats() const { return stats; }
+
+    // Límites superiores de los buckets (ms); el último es abierto
+    static uint32_t latencyBucketLimitMs(int bucket) {
+        static const uint32_t LIMITS[MESH_INGRESS_LAT_BUCKETS] = {10, 100, 500, 1000, 5000, 0};
+        return LIMITS[bucket];
+    }
+
+#ifdef UNIT_TEST
+    // Se llama en pop() entre la lectura de tail y el CAS del slot
+    void (*popRaceHook)(MeshIngressQueue*) = nullptr;
+#endif
+
+private:
+    enum SlotState : uint8_t { EMPTY, READY, READING, DROPPING, WRITING };
+    static const int POP_ATTEMPTS = 64;
+
+    MeshReading slots[MESH_INGRESS_MAX_DEPTH];
+    std::atomic<uint8_t> state[MESH_INGRESS_MAX_DEPTH];
+    uint32_t position[MESH_INGRESS_MAX_DEPTH];   // head al escribirse; se lee con el slot tomado
+    std::atomic<uint32_t> head;   // Próximo slot a escribir (solo el productor)
+    std::atomic<uint32_t> tail;   // Slot más viejo (dueño del slot)
+    uint16_t cap;
+    MeshOverflowPolicy policy;
+    MeshIngressStats stats;       // Cada contador tiene un solo escritor
+
+    // Productor con la cola llena: libera el slot más viejo.
+    // Devuelve true si hay lugar para escribir en head.
+    bool makeRoom(uint32_t h) {
+        uint32_t t = tail.load(std::memory_order_acquire);
+        if (h - t < cap) return true;   // El consumidor liberó uno mientras tanto
+        uint32_t i = t & (cap - 1);
+        uint8_t expected = READY;
+        if (!state[i].compare_exchange_strong(expected, DROPPING, std::memory_order_acquire)) {
+            // El consumidor lo está leyendo: en cuanto termine habrá lugar,
+            // pero no se espera en la tarea de recepción
+            return false;
+        }
+        state[i].store(EMPTY, std::memory_order_relaxed);
+        tail.store(t + 1, std::memory_order_release);
+        stats.droppedOldest++;
+        return true;
+    }
+
+    // Productor: reemplaza la lectura en cola del mismo originador y sensor
+    bool coalesce(const MeshReading& reading) {
+        uint32_t t = tail.load(std::memory_order_acquire);
+        uint32_t h = head.load(std::memory_order_relaxed);
+        for (uint32_t k = h; k != t; k--) {          // De la más nueva a la más vieja
+            uint32_t i = (k - 1) & (cap - 1);
+            const MeshReading& q = slots[i];
+            if (memcmp(q.originatorMAC, reading.originatorMAC, 6) != 0 ||
+                strncmp(q.sensorId, reading.sensorId, sizeof(q.sensorId)) != 0) {
+                continue;
+            }
+            uint8_t expected = READY;
+            if (!state[i].compare_exchange_strong(expected, WRITING, std::memory_order_acquire)) {
+                return false;   // El consumidor ya lo está leyendo
+            }
+            uint32_t firstEnqueued = slots[i].enqueuedMs;
+            slots[i] = reading;
+            slots[i].enqueuedMs = firstEnqueued;   // La latencia cuenta desde la primera
+            state[i].store(READY, std::memory_order_release);
+            return true;
+        }
+        return false;
+    }
+
+    void recordOccupancy(uint32_t used) {
+        int b = (used >= cap) ? 4 : (int)(used * 4 / cap);
+        stats.occupancy[b]++;
+    }
+
+    void recordLatency(uint32_t ms) {
+        int b = 0;
+        while (b < MESH_INGRESS_LAT_BUCKETS - 1 && ms >= latencyBucketLimitMs(b)) b++;
+        stats.latency[b]++;
+        if (ms > stats.maxLatencyMs) stats.maxLatencyMs = ms;
+    }
+};
+
+extern MeshIngressQueue meshIngress;
+
+#endif // MESH_INGRESS_QUEUE_H
@@ -0,0 +1,452 @@
+#ifndef MESH_PAYLOAD_H
+#define MESH_PAYLOAD_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <math.h>
+#include "Measurement.h"
+
+/**
+ * Trama binaria de datos de la malla (MSG_DATA_V2).
+ *
+ *   0      msgType (4)
+ *   1      versión (MESH_PAYLOAD_VERSION)
+ *   2      hopCount
+ *   3..8   MAC del originador
+ *   9..12  secuencia (little endian)
+ *   13..   TLVs: tipo (1 byte), largo (1 byte), valor
+ *
+ * TLVs:
+ *   MESH_TLV_SENSOR_NAME  hash(2) + nombre        anuncia el nombre de un sensor
+ *   MESH_TLV_READING      hash(2) + campos        lecturas de un sensor
+ *   MESH_TLV_AGE          segundos(2)             antigüedad de las lecturas que
+ *                                                 siguen (varios ciclos por trama)
+ *   MESH_TLV_TX_TIME      millis(4)               reloj del originador al enviar
+ *                                                 (latencia relativa en el gateway)
+ *
+ * Cada campo es un id de MEASUREMENT_FIELDS (bit 7 = valor int32, si no
+ * int16) seguido del valor escalado por 10^decimales. Los campos que no
+ * están en la tabla van con MESH_FIELD_NAMED: largo, nombre, decimales e
+ * int32. Los TLV de tipo desconocido se saltean, así una versión nueva
+ * puede agregar tipos sin romper gateways viejos.
+ *
+ * Un TH (temp, hum) ocupa 4 + 2 + 3 + 3 = 12 bytes contra ~60 de la trama
+ * fija anterior, y las lecturas de varios sensores de un ciclo entran en
+ * una sola trama de hasta 250 bytes.
+ */
+
+#define MESH_PAYLOAD_VERSION   2
+#define MESH_FRAME_MAX         250      // ESP_NOW_MAX_DATA_LEN
+#define MESH_FRAME_HEADER      13
+#define MESH_FRAME_HOP_OFFSET  2
+#define MESH_NAME_MAX          31
+
+#define MESH_TLV_SENSOR_NAME   1
+#define MESH_TLV_READING       2
+#define MESH_TLV_AGE           3
+#define MESH_TLV_TX_TIME       4
+#define MESH_MAX_CYCLE_MARKS   8
+
+#define MESH_FIELD_INT32       0x80
+#define MESH_FIELD_NAMED       0x7F
+
+// Los ids de campo son los de MEASUREMENT_FIELDS (Measurement.h)
+static_assert(MESH_FIELD_NAMED == MEAS_NAMED, "MEAS_NAMED debe coincidir con el id de campo con nombre");
+
+// Hash de 16 bits del sensor ID (FNV-1a plegado)
+inline uint16_t meshSensorHash(const char* sensorId) {
+    uint32_t h = 2166136261UL;
+    for (const char* p = sensorId; p && *p; p++) {
+        h ^= (uint8_t)*p;
+        h *= 16777619UL;
+    }
+    return (uint16_t)(h ^ (h >> 16));
+}
+
+inline int32_t meshScale(double value, uint8_t decimals) {
+    static const double POW10[] = {1, 10, 100, 1000, 10000};
+    double scaled = value * POW10[decimals > 4 ? 4 : decimals];
+    if (scaled > 2147483647.0) return INT32_MAX;
+    if (scaled < -2147483648.0) return INT32_MIN;
+    return (int32_t)lround(scaled);
+}
+
+// ============================================================================
+// Escritura (sensor)
+// ============================================================================
+
+class MeshFrameWriter {
+public:
+    MeshFrameWriter(uint8_t* buffer, size_t capacity)
+        : buf(buffer), cap(capacity > MESH_FRAME_MAX ? MESH_FRAME_MAX : capacity),
+          len(0), tlvStart(0), readings(0), fieldCount(0), cycles(0), txTimePos(0) {}
+
+    void begin(uint8_t msgType, uint8_t hopCount, const uint8_t originatorMAC[6], uint32_t sequence) {
+        buf[0] = msgType;
+        buf[1] = MESH_PAYLOAD_VERSION;
+        buf[MESH_FRAME_HOP_OFFSET] = hopCount;
+        memcpy(&buf[3], originatorMAC, 6);
+        putU32At(9, sequence);
+        len = MESH_FRAME_HEADER;
+        readings = 0;
+        cycles = 0;
+        txTimePos = 0;
+    }
+
+    // Reserva el TLV con la hora de envío, que se completa con finish()
+    bool markTxTime() {
+        if (txTimePos || len + 6 > cap) return false;
+        buf[len++] = MESH_TLV_TX_TIME;
+        buf[len++] = 4;
+        txTimePos = len;
+        putU32At(len, 0);
+        len += 4;
+        return true;
+    }
+
+    /**
+     * Abre un ciclo de muestreo tomado en nowMs: las lecturas que siguen
+     * llevan su antigüedad, que se completa al enviar con finish().
+     */
+    bool beginCycle(uint32_t nowMs) {
+        if (cycles >= MESH_MAX_CYCLE_MARKS || len + 4 > cap) return false;
+        buf[len++] = MESH_TLV_AGE;
+        buf[len++] = 2;
+        cycleMarks[cycles].pos = len;
+        cycleMarks[cycles].ms = nowMs;
+        cycles++;
+        putU16(0);
+        return true;
+    }
+
+    // Al enviar: completa antigüedades y hora de envío
+    void finish(uint32_t nowMs) {
+        if (txTimePos) putU32At(txTimePos, nowMs);
+        for (uint8_t i = 0; i < cycles; i++) {
+            uint32_t age = (nowMs - cycleMarks[i].ms) / 1000;
+            if (age > 0xFFFF) age = 0xFFFF;
+            buf[cycleMarks[i].pos] = age & 0xFF;
+            buf[cycleMarks[i].pos + 1] = age >> 8;
+        }
+    }
+
+    /**
+     * Agrega las lecturas de un sensor, precedidas del anuncio de su nombre
+     * si announceName no es nullptr. Es atómica: si no entra entera no
+     * agrega nada y devuelve false. Las mediciones MEAS_INVALID no se envían.
+     */
+    bool addReading(uint16_t hash, const MeasurementSet& set, const char* announceName = nullptr) {
+        size_t saved = len;
+        if (announceName && !putName(hash, announceName)) return rollback(saved);
+        if (!beginTlv(MESH_TLV_READING)) return rollback(saved);
+        if (!putU16(hash)) return rollback(saved);
+        fieldCount = 0;
+
+        for (const Measurement& m : set) {
+            if (m.quality == MEAS_INVALID || isnan(m.value) || isinf(m.value)) continue;
+            const MeasurementFieldDef* def = m.field == MEAS_NAMED ? nullptr : findMeasurementFieldById(m.field);
+            if (!addField(def, m.name, strlen(m.name), m.value, m.decimals)) return rollback(saved);
+        }
+        return closeReading(saved);
+    }
+
+    size_t length() const { return len; }
+    uint8_t readingCount() const { return readings; }
+    uint8_t cycleCount() const { return cycles; }
+    const uint8_t* data() const { return buf; }
+
+private:
+    uint8_t* buf;
+    size_t cap;
+    size_t len;
+    size_t tlvStart;
+    uint8_t readings;
+    uint8_t fieldCount;
+    uint8_t cycles;
+    struct CycleMark {
+        size_t pos;
+        uint32_t ms;
+    };
+    CycleMark cycleMarks[MESH_MAX_CYCLE_MARKS];
+    size_t txTimePos;
+
+    bool putName(uint16_t hash, const char* name) {
+        size_t n = strnlen(name, MESH_NAME_MAX);
+        if (len + 2 + 2 + n > cap) return false;
+        buf[len++] = MESH_TLV_SENSOR_NAME;
+        buf[len++] = 2 + n;
+        putU16(hash);
+        memcpy(&buf[len], name, n);
+        len += n;
+        return true;
+    }
+
+    bool rollback(size_t saved) {
+        len = saved;
+        return false;
+    }
+
+    bool closeReading(size_t saved) {
+        if (fieldCount == 0 || len - tlvStart - 2 > 255) return rollback(saved);
+        buf[tlvStart + 1] = len - tlvStart - 2;
+        readings++;
+        return true;
+    }
+
+    bool beginTlv(uint8_t type) {
+        if (len + 2 > cap) return false;
+        tlvStart = len;
+        buf[len++] = type;
+        buf[len++] = 0;
+        return true;
+    }
+
+    bool putU16(uint16_t v) {
+        if (len + 2 > cap) return false;
+        buf[len++] = v & 0xFF;
+        buf[len++] = v >> 8;
+        return true;
+    }
+
+    bool putI32(int32_t v) {
+        if (len + 4 > cap) return false;
+        putU32At(len, (uint32_t)v);
+        len += 4;
+        return true;
+    }
+
+    void putU32At(size_t pos, uint32_t v) {
+        for (int i = 0; i < 4; i++) buf[pos + i] = (v >> (8 * i)) & 0xFF;
+    }
+
+    // def = nullptr: campo fuera de la tabla, va con su nombre y decimals
+    bool addField(const MeasurementFieldDef* def, const char* name, size_t nameLen, double value,
+                  uint8_t decimals) {
+        if (def) {
+            int32_t scaled = meshScale(value, def->decimals);
+            bool wide = scaled < INT16_MIN || scaled > INT16_MAX;
+            if (len + 1 + (wide ? 4 : 2) > cap) return false;
+            buf[len++] = def->id | (wide ? MESH_FIELD_INT32 : 0);
+            if (wide) {
+                putI32(scaled);
+            } else {
+                putU16((uint16_t)(int16_t)scaled);
+            }
+        } else {
+            if (nameLen == 0 || nameLen > MESH_NAME_MAX) return true;   // Se omite
+            if (len + 1 + 1 + nameLen + 1 + 4 > cap) return false;
+            buf[len++] = MESH_FIELD_NAMED;
+            buf[len++] = nameLen;
+            memcpy(&buf[len], name, nameLen);
+            len += nameLen;
+            if (decimals > 4) decimals = 4;
+            buf[len++] = decimals;
+            putI32(meshScale(value, decimals));
+        }
+        fieldCount++;
+        return true;
+    }
+};
+
+// ============================================================================
+// Lectura (gateway)
+// ============================================================================
+
+struct MeshFrameHeader {
+    uint8_t msgType;
+    uint8_t version;
+    uint8_t hopCount;
+    uint8_t originatorMAC[6];
+    uint32_t sequence;
+};
+
+inline bool parseMeshFrameHeader(const uint8_t* data, size_t len, MeshFrameHeader& hdr) {
+    if (len < MESH_FRAME_HEADER || len > MESH_FRAME_MAX) return false;
+    hdr.msgType = data[0];
+    hdr.version = data[1];
+    hdr.hopCount = data[MESH_FRAME_HOP_OFFSET];
+    memcpy(hdr.originatorMAC, &data[3], 6);
+    hdr.sequence = (uint32_t)data[9] | ((uint32_t)data[10] << 8) |
+                   ((uint32_t)data[11] << 16) | ((uint32_t)data[12] << 24);
+    return hdr.version == MESH_PAYLOAD_VERSION;
+}
+
+// Recorre los TLV de una trama. next() devuelve false al final o si la trama está truncada.
+class MeshTlvReader {
+public:
+    MeshTlvReader(const uint8_t* frame, size_t frameLen)
+        : data(frame), len(frameLen), pos(MESH_FRAME_HEADER), truncated(false) {}
+
+    bool next(uint8_t& type, const uint8_t*& value, uint8_t& valueLen) {
+        if (pos + 2 > len) {
+            truncated = pos != len;
+            return false;
+        }
+        type = data[pos];
+        valueLen = data[pos + 1];
+        if (pos + 2 + valueLen > len) {
+            truncated = true;
+            return false;
+        }
+        value = &data[pos + 2];
+        pos += 2 + valueLen;
+        return true;
+    }
+
+    bool isTruncated() const { return truncated; }
+
+private:
+    const uint8_t* data;
+    size_t len;
+    size_t pos;
+    bool truncated;
+};
+
+inline uint16_t meshTlvHash(const uint8_t* value) {
+    return (uint16_t)value[0] | ((uint16_t)value[1] << 8);
+}
+
+// Hora de envío del originador (MESH_TLV_TX_TIME), si la trama la trae
+inline bool findMeshTxTime(const uint8_t* data, size_t len, uint32_t& txMs) {
+    MeshTlvReader reader(data, len);
+    uint8_t type, valueLen;
+    const uint8_t* value;
+    while (reader.next(type, value, valueLen)) {
+        if (type != MESH_TLV_TX_TIME || valueLen < 4) continue;
+        txMs = (uint32_t)value[0] | ((uint32_t)value[1] << 8) |
+               ((uint32_t)value[2] << 16) | ((uint32_t)value[3] << 24);
+        return true;
+    }
+    return false;
+}
+
+/**
+ * Convierte el valor de un MESH_TLV_READING (sin el hash) a campos de line
+ * protocol: "temp=25.30,hum=60.50". Devuelve la cantidad de campos, o -1
+ * si está mal formado. Los ids que este firmware no conoce se saltean (el
+ * bit de ancho alcanza para saber cuánto ocupan), igual que los nombres
+ * que no son [A-Za-z0-9_]: vienen de la radio y el gateway los copia sin
+ * escapar a la línea (un ' ', ',', '=' o '\n' la rompería).
+ */
+inline int meshReadingToFields(const uint8_t* value, uint8_t valueLen, char* out, size_t cap) {
+    if (cap == 0) return -1;
+    out[0] = '\0';
+    size_t pos = 0;
+    size_t i = 2;   // Después del hash
+    int count = 0;
+
+    while (i < valueLen) {
+        uint8_t fid = value[i++];
+        const char* name;
+        size_t nameLen;
+        uint8_t decimals;
+        int32_t scaled;
+
+        if (fid == MESH_FIELD_NAMED) {
+            if (i >= valueLen) return -1;
+            nameLen = value[i++];
+            if (i + nameLen + 1 + 4 > valueLen) return -1;
+            name = (const char*)&value[i];
+            i += nameLen;
+            decimals = value[i++];
+            scaled = (int32_t)((uint32_t)value[i] | ((uint32_t)value[i + 1] << 8) |
+                               ((uint32_t)value[i + 2] << 16) | ((uint32_t)value[i + 3] << 24));
+            i += 4;
+            if (!isPlainFieldKey(name, nameLen)) continue;
+        } else {
+            bool wide = fid & MESH_FIELD_INT32;
+            const MeasurementFieldDef* def = findMeasurementFieldById(fid & ~MESH_FIELD_INT32);
+            size_t width = wide ? 4 : 2;
+            if (i + width > valueLen) return -1;
+            if (wide) {
+                scaled = (int32_t)((uint32_t)value[i] | ((uint32_t)value[i + 1] << 8) |
+                                   ((uint32_t)value[i + 2] << 16) | ((uint32_t)value[i + 3] << 24));
+            } else {
+                scaled = (int16_t)((uint16_t)value[i] | ((uint16_t)value[i + 1] << 8));
+            }
+            i += width;
+            if (!def) continue;   // Campo de una versión más nueva: se saltea
+            name = def->name;
+            nameLen = strlen(def->name);
+            decimals = def->decimals;
+        }
+
+        // "name=value" con coma si no es el primero
+        size_t need = (count ? 1 : 0) + nameLen + 1;
+        if (pos + need >= cap) break;
+        if (count) out[pos++] = ',';
+        memcpy(&out[pos], name, nameLen);
+        pos += nameLen;
+        out[pos++] = '=';
+        size_t n = formatScaled(&out[pos], cap - pos, scaled, decimals > 4 ? 4 : decimals);
+        if (n == 0) {
+            pos -= need;   // No entra el valor: quitar "name="
+            out[pos] = '\0';
+            break;
+        }
+        pos += n;
+        count++;
+    }
+    return count;
+}
+
+// ============================================================================
+// Nombres de sensores anunciados (gateway)
+// ============================================================================
+
+#define MESH_NAME_TABLE_SIZE 64
+
+class MeshNameTable {
+public:
+    MeshNameTable() : clock(0) { memset(entries, 0, sizeof(entries)); }
+
+    void learn(const uint8_t mac[6], uint16_t hash, const char* name, size_t nameLen) {
+        Entry* e = find(mac, hash);
+        if (!e) e = victim();
+        memcpy(e->mac, mac, 6);
+        e->hash = hash;
+        if (nameLen > MESH_NAME_MAX) nameLen = MESH_NAME_MAX;
+        memcpy(e->name, name, nameLen);
+        e->name[nameLen] = '\0';
+        e->used = true;
+        e->lastUsed = ++clock;
+    }
+
+    // Nombre del sensor, o nullptr si el originador todavía no lo anunció
+    const char* lookup(const uint8_t mac[6], uint16_t hash) {
+        Entry* e = find(mac, hash);
+        if (!e) return nullptr;
+        e->lastUsed = ++clock;
+        return e->name;
+    }
+
+private:
+    struct Entry {
+        uint8_t mac[6];
+        uint16_t hash;
+        char name[MESH_NAME_MAX + 1];
+        bool used;
+        uint32_t lastUsed;
+    };
+    Entry entries[MESH_NAME_TABLE_SIZE];
+    uint32_t clock;
+
+    Entry* find(const uint8_t mac[6], uint16_t hash) {
+        for (Entry& e : entries) {
+            if (e.used && e.hash == hash && memcmp(e.mac, mac, 6) == 0) return &e;
+        }
+        return nullptr;
+    }
+
+    Entry* victim() {
+        Entry* oldest = &entries[0];
+        for (Entry& e : entries) {
+            if (!e.used) return &e;
+            if (e.lastUsed < oldest->lastUsed) oldest = &e;
+        }
+        return oldest;
+    }
+};
+
+#endif // MESH_PAYLOAD_H
@@ -0,0 +1,260 @@
+#ifndef MESH_ROUTING_H
+#define MESH_ROUTING_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define ROUTE_MAX_NEIGHBORS    16
+#define ROUTE_MAX_HOPS         8       // Más lejos se considera sin ruta (corta el conteo a infinito)
+#define ROUTE_NO_HOPS          0xFF
+#define ROUTE_NO_COST          0xFFFF
+#define ROUTE_MAX_LINK_COST    50      // ETX x10: peor que 20% de entrega no se usa
+#define ROUTE_NEIGHBOR_BEACONS 3       // Intervalos de beacon en silencio para olvidar un vecino
+#define ROUTE_QUALITY_PRIOR    180     // Calidad inicial de un vecino nuevo (sobre 255)
+
+/**
+ * Ruteo por gradiente hacia el gateway.
+ *
+ * Cada nodo anuncia en su beacon cuántos saltos y qué costo tiene hasta el
+ * gateway (el gateway anuncia 0/0). El costo de un enlace es su ETX x10:
+ * 10 con entrega perfecta, 20 si llega la mitad. La calidad de cada vecino
+ * es un promedio exponencial de beacons recibidos/perdidos y de los ACK de
+ * los envíos unicast. El padre es el vecino con menor costo anunciado +
+ * costo del enlace; solo se cambia si el nuevo es claramente mejor
+ * (histéresis), para no oscilar entre dos vecinos parecidos.
+ *
+ * Un vecino cuyo padre es este nodo no se elige nunca (evita lazos de dos
+ * nodos); los lazos más largos los corta ROUTE_MAX_HOPS.
+ *
+ * Con intervalo de beacon variable (Trickle) el vecino anuncia su número
+ * de beacon y su intervalo actual: los perdidos se cuentan por el salto
+ * de número (un beacon omitido por supresión no se numera) y el vecino se
+ * olvida tras ROUTE_NEIGHBOR_BEACONS veces el doble de su intervalo. Un ACK
+ * de un unicast también cuenta como señal de vida.
+ */
+
+struct RouteNeighbor {
+    uint8_t mac[6];
+    uint8_t parent[6];       // Padre anunciado por el vecino
+    uint8_t hops;            // Saltos anunciados (ROUTE_NO_HOPS = sin ruta)
+    uint16_t cost;           // Costo anunciado hasta el gateway
+    uint8_t quality;         // Probabilidad de entrega estimada (0-255)
+    int16_t beaconSeq;       // Último número de beacon, -1 si el vecino no lo envía
+    uint32_t intervalMs;     // Intervalo de beacon anunciado (0 = el propio)
+    uint32_t lastHeardMs;
+    bool used;
+};
+
+struct MeshRouteStats {
+    uint32_t parentChanges;
+    uint32_t txOk;
+    uint32_t txFail;
+    uint32_t evictions;
+};
+
+class MeshRouter {
+public:
+    MeshRouter() { begin(false, nullptr, 2000); }
+
+    void begin(bool root, const uint8_t* selfMac, uint32_t beaconIntervalMs) {
+        isRoot = root;
+        if (selfMac) memcpy(self, selfMac, 6);
+        else memset(self, 0, 6);
+        interval = beaconIntervalMs ? beaconIntervalMs : 1;
+        memset(table, 0, sizeof(table));
+        parentIdx = -1;
+        memset(&stats, 0, sizeof(stats));
+    }
+
+    /**
+     * Beacon de un vecino con su anuncio de ruta. beaconSeq (-1 si no viene)
+     * e intervalMs (0 si no viene) son la numeración e intervalo Trickle del
+     * vecino. Devuelve true si el vecino es nuevo.
+     */
+    bool onBeacon(const uint8_t mac[6], uint8_t hops, uint16_t cost, const uint8_t parent[6],
+                  int8_t rssi, uint32_t now, int beaconSeq = -1, uint32_t intervalMs = 0) {
+        if (isRoot) return false;
+        int i = find(mac);
+        bool added = i < 0;
+        if (added) {
+            i = allocate();
+            RouteNeighbor& n = table[i];
+            memcpy(n.mac, mac, 6);
+            n.quality = priorFromRssi(rssi);
+            n.used = true;
+        } else {
+            // Beacons perdidos desde el último escuchado cuentan como fallas
+            RouteNeighbor& n = table[i];
+            uint32_t missed;
+            if (beaconSeq >= 0 && n.beaconSeq >= 0) {
+                missed = (uint8_t)(beaconSeq - n.beaconSeq);
+                if (missed > 0) missed--;
+            } else {
+                uint32_t step = n.intervalMs ? n.intervalMs : interval;
+                missed = (now - n.lastHeardMs + step / 2) / step;
+                if (missed > 0) missed--;
+            }
+            for (uint32_t k = 0; k < missed && k < ROUTE_NEIGHBOR_BEACONS; k++) sample(n, false);
+            sample(n, true);
+        }
+        RouteNeighbor& n = table[i];
+        n.hops = hops;
+        n.cost = cost;
+        memcpy(n.parent, parent, 6);
+        n.beaconSeq = beaconSeq;
+        n.intervalMs = intervalMs;
+        n.lastHeardMs = now;
+        update(now);
+        return added;
+    }
+
+    // Resultado (ACK de la capa MAC) de un envío unicast a un vecino
+    void onTxResult(const uint8_t mac[6], bool ok, uint32_t now) {
+        if (ok) stats.txOk++;
+        else stats.txFail++;
+        int i = find(mac);
+        if (i < 0) return;
+        sample(table[i], ok);
+        if (ok) table[i].lastHeardMs = now;
+        update(now);
+    }
+
+    // Olvida vecinos callados y elige padre. Devuelve true si el padre cambió.
+    bool update(uint32_t now) {
+        if (isRoot) return false;
+        int previous = parentIdx;
+
+        for (int i = 0; i < ROUTE_MAX_NEIGHBORS; i++) {
+            if (table[i].used && now - table[i].lastHeardMs > silenceLimit(table[i])) {
+                table[i].used = false;
+                if (i == parentIdx) parentIdx = -1;
+            }
+        }
+
+        int best = -1;
+        uint32_t bestCost = ROUTE_NO_COST;
+        for (int i = 0; i < ROUTE_MAX_NEIGHBORS; i++) {
+            uint32_t c = pathCost(i);
+            if (c < bestCost || (c == bestCost && best >= 0 && table[i].hops < table[best].hops)) {
+                best = i;
+                bestCost = c;
+            }
+        }
+
+        uint32_t currentCost = parentIdx >= 0 ? pathCost(parentIdx) : ROUTE_NO_COST;
+        if (currentCost == ROUTE_NO_COST) {
+            parentIdx = best;
+        } else if (best >= 0 && best != parentIdx && bestCost + currentCost / 8 + 5 < currentCost) {
+            parentIdx = best;
+        }
+
+        if (parentIdx != previous) {
+            if (parentIdx >= 0) stats.parentChanges++;
+            return true;
+        }
+        return false;
+    }
+
+    bool hasParent() const { return isRoot || parentIdx >= 0; }
+    const uint8_t* parent() const { return parentIdx >= 0 ? table[parentIdx].mac : nullptr; }
+
+    // Anuncio propio para el beacon
+    uint8_t hops() const {
+        if (isRoot) return 0;
+        return parentIdx >= 0 ? table[parentIdx].hops + 1 : ROUTE_NO_HOPS;
+    }
+    uint16_t cost() const {
+        if (isRoot) return 0;
+        return parentIdx >= 0 ? pathCost(parentIdx) : ROUTE_NO_COST;
+    }
+
+    // Vecinos que anuncian a este nodo como padre
+    int childCount() const {
+        int n = 0;
+        for (const RouteNeighbor& e : table) if (e.used && memcmp(e.parent, self, 6) == 0) n++;
+        return n;
+    }
+
+    int neighborCount() const {
+        int n = 0;
+        for (const RouteNeighbor& e : table) if (e.used) n++;
+        return n;
+    }
+    const RouteNeighbor* neighbor(int i) const { return table[i].used ? &table[i] : nullptr; }
+    const MeshRouteStats& getStats() const { return stats; }
+
+    // ETX x10 del enlace
+    static uint16_t linkCost(uint8_t quality) {
+        if (quality == 0) return ROUTE_NO_COST;
+        uint32_t c = (10u * 255u + quality / 2) / quality;
+        return c > ROUTE_NO_COST ? ROUTE_NO_COST : c;
+    }
+
+private:
+    bool isRoot;
+    uint8_t self[6];
+    uint32_t interval;
+    RouteNeighbor table[ROUTE_MAX_NEIGHBORS];
+    int parentIdx;
+    MeshRouteStats stats;
+
+    int find(const uint8_t mac[6]) const {
+        for (int i = 0; i < ROUTE_MAX_NEIGHBORS; i++) {
+            if (table[i].used && memcmp(table[i].mac, mac, 6) == 0) return i;
+        }
+        return -1;
+    }
+
+    // Slot libre, o el vecino menos útil (sin ruta o más caro) que no sea el padre
+    int allocate() {
+        int victim = -1;
+        uint32_t worst = 0;
+        for (int i = 0; i < ROUTE_MAX_NEIGHBORS; i++) {
+            if (!table[i].used) {
+                memset(&table[i], 0, sizeof(table[i]));
+                return i;
+            }
+            if (i == parentIdx) continue;
+            uint32_t c = pathCost(i);
+            if (victim < 0 || c > worst) {
+                victim = i;
+                worst = c;
+            }
+        }
+        stats.evictions++;
+        memset(&table[victim], 0, sizeof(table[victim]));
+        return victim;
+    }
+
+    // Silencio tolerado: Trickle transmite en [I/2, I) y el intervalo siguiente es 2I
+    uint32_t silenceLimit(const RouteNeighbor& n) const {
+        if (!n.intervalMs) return interval * ROUTE_NEIGHBOR_BEACONS;
+        return n.intervalMs * 2 * ROUTE_NEIGHBOR_BEACONS;
+    }
+
+    // Costo hasta el gateway pasando por el vecino i, o ROUTE_NO_COST si no sirve
+    uint32_t pathCost(int i) const {
+        const RouteNeighbor& n = table[i];
+        if (!n.used || n.hops >= ROUTE_MAX_HOPS || n.cost == ROUTE_NO_COST) return ROUTE_NO_COST;
+        if (memcmp(n.parent, self, 6) == 0) return ROUTE_NO_COST;
+        uint16_t link = linkCost(n.quality);
+        if (link > ROUTE_MAX_LINK_COST) return ROUTE_NO_COST;
+        uint32_t c = (uint32_t)n.cost + link;
+        return c >= ROUTE_NO_COST ? ROUTE_NO_COST : c;
+    }
+
+    // Promedio exponencial con peso 1/8
+    static void sample(RouteNeighbor& n, bool ok) {
+        int target = ok ? 255 : 0;
+        n.quality = n.quality + (target - (int)n.quality) / 8;
+    }
+
+    static uint8_t priorFromRssi(int8_t rssi) {
+        if (rssi == 0) return ROUTE_QUALITY_PRIOR;   // IDF 4.x no informa RSSI
+        if (rssi >= -70) return 230;
+        if (rssi >= -80) return 160;
+        return 90;
+    }
+};
+
+#endif // MESH_ROUTING_H
@@ -0,0 +1,186 @@
+#ifndef MESH_SEQ_TRACKER_H
+#define MESH_SEQ_TRACKER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define MESH_TRACK_MAX           32      // Originadores seguidos por el gateway
+#define MESH_TRACK_REBOOT_BEHIND 32      // Igual que la ventana de MeshDedup
+#define MESH_TRACK_BASE_FRAMES   64      // Tramas por ventana de la base de latencia
+#define MESH_TRACK_REPORT_MS     60000   // Cada cuánto se manda la línea a Grafana
+
+struct MeshOriginatorStats {
+    uint8_t mac[6];
+    bool used;
+    uint32_t highest;       // Secuencia más alta de la época actual
+    uint32_t received;      // Tramas recibidas (sin duplicados)
+    uint32_t expected;      // Secuencias que debieron llegar desde la primera vista
+    uint32_t lost;          // Faltantes (baja si llegan tarde)
+    uint32_t gaps;          // Saltos hacia adelante de más de uno
+    uint32_t reordered;     // Llegaron después de una secuencia mayor
+    uint16_t reboots;       // La secuencia volvió atrás (el originador reinició)
+    uint32_t lastSeenMs;
+
+    // Latencia relativa: demora sobre la entrega más rápida vista
+    bool hasBase;
+    uint32_t baseOffset;    // Menor (llegada - envío) de las dos últimas ventanas
+    uint32_t windowMin;
+    uint32_t prevWindowMin;
+    uint8_t windowFrames;
+    uint32_t latencyAvgMs;  // Promedio exponencial (peso 1/8)
+    uint32_t latencyMaxMs;
+    uint32_t latencySamples;
+};
+
+/**
+ * Seguimiento de secuencias por originador en el gateway.
+ *
+ * Recibe las tramas que pasaron MeshDedup y por cada originador cuenta
+ * huecos, desorden y reinicios, y calcula la tasa de entrega (recibidas /
+ * esperadas desde la primera secuencia vista). Una secuencia faltante que
+ * llega tarde deja de contarse como perdida.
+ *
+ * Los relojes de los nodos no están sincronizados, así que la latencia es
+ * relativa: (llegada - hora de envío del originador) menos el mínimo de esa
+ * diferencia en las últimas dos ventanas de MESH_TRACK_BASE_FRAMES tramas.
+ * Mide lo que se agrega por colas, reintentos y saltos sobre la entrega más
+ * rápida; renovar la base acota el error por deriva de los cristales.
+ *
+ * Tabla fija indexada por MAC (hash + sondeo lineal). Con la tabla llena
+ * el originador más callado se reemplaza en su mismo slot, así no hace
+ * falta reacomodar las cadenas de sondeo.
+ */
+class MeshSeqTracker {
+public:
+    MeshSeqTracker() { clear(); }
+
+    void clear() {
+        memset(table, 0, sizeof(table));
+        count = 0;
+        evictions = 0;
+    }
+
+    // Una trama (no duplicada) del originador. hasTxTime/txMs: MESH_TLV_TX_TIME.
+    void onFrame(const uint8_t* mac, uint32_t seq, uint32_t now, bool hasTxTime = false, uint32_t txMs = 0) {
+        int idx = find(mac);
+        if (idx < 0) {
+            MeshOriginatorStats& e = table[insert(mac)];
+            e.highest = seq;
+            e.received = 1;
+            e.expected = 1;
+            e.lastSeenMs = now;
+            if (hasTxTime) sampleLatency(e, now - txMs);
+            return;
+        }
+
+        MeshOriginatorStats& e = table[idx];
+        e.lastSeenMs = now;
+        e.received++;
+
+        int32_t ahead = (int32_t)(seq - e.highest);
+        if (ahead > 0) {
+            e.expected += ahead;
+            if (ahead > 1) {
+                e.gaps++;
+                e.lost += ahead - 1;
+            }
+            e.highest = seq;
+        } else if ((uint32_t)(-ahead) < MESH_TRACK_REBOOT_BEHIND) {
+            e.reordered++;
+            if (e.lost > 0) e.lost--;
+        } else {
+            // Contador reiniciado: nueva época, y el reloj del originador también volvió a 0
+            e.reboots++;
+            e.expected++;
+            e.highest = seq;
+            e.hasBase = false;
+        }
+
+        if (hasTxTime) sampleLatency(e, now - txMs);
+    }
+
+    // Recorrido de la tabla: slot i, o nullptr si está libre
+    const MeshOriginatorStats* entry(int i) const { return table[i].used ? &table[i] : nullptr; }
+    int slots() const { return MESH_TRACK_MAX; }
+    int size() const { return count; }
+    uint32_t getEvictions() const { return evictions; }
+
+    const MeshOriginatorStats* lookup(const uint8_t* mac) const {
+        int idx = find(mac);
+        return idx < 0 ? nullptr : &table[idx];
+    }
+
+    // Tasa de entrega en milésimas (1000 = todo llegó)
+    static uint16_t deliveryPermille(const MeshOriginatorStats& e) {
+        if (e.expected == 0) return 1000;
+        uint32_t ok = e.received > e.expected ? e.expected : e.received;
+        return (uint16_t)((uint64_t)ok * 1000 / e.expected);
+    }
+
+private:
+    MeshOriginatorStats table[MESH_TRACK_MAX];
+    int count;
+    uint32_t evictions;
+
+    static uint32_t hashMac(const uint8_t* mac) {
+        uint32_t h = 2166136261UL;
+        for (int i = 0; i < 6; i++) {
+            h ^= mac[i];
+            h *= 16777619UL;
+        }
+        return h;
+    }
+
+    int find(const uint8_t* mac) const {
+        int i = hashMac(mac) % MESH_TRACK_MAX;
+        for (int probes = 0; probes < MESH_TRACK_MAX; probes++) {
+            if (!table[i].used) return -1;
+            if (memcmp(table[i].mac, mac, 6) == 0) return i;
+            i = (i + 1) % MESH_TRACK_MAX;
+        }
+        return -1;
+    }
+
+    int insert(const uint8_t* mac) {
+        int i = hashMac(mac) % MESH_TRACK_MAX;
+        if (count < MESH_TRACK_MAX) {
+            while (table[i].used) i = (i + 1) % MESH_TRACK_MAX;
+            count++;
+        } else {
+            // Llena: reemplazar el que hace más tiempo que no se escucha
+            i = 0;
+            for (int k = 1; k < MESH_TRACK_MAX; k++) {
+                if ((int32_t)(table[k].lastSeenMs - table[i].lastSeenMs) < 0) i = k;
+            }
+            evictions++;
+        }
+        memset(&table[i], 0, sizeof(table[i]));
+        memcpy(table[i].mac, mac, 6);
+        table[i].used = true;
+        return i;
+    }
+
+    static void sampleLatency(MeshOriginatorStats& e, uint32_t offset) {
+        if (!e.hasBase) {
+            e.hasBase = true;
+            e.baseOffset = e.windowMin = e.prevWindowMin = offset;
+            e.windowFrames = 0;
+        }
+        if ((int32_t)(offset - e.windowMin) < 0) e.windowMin = offset;
+        if (++e.windowFrames >= MESH_TRACK_BASE_FRAMES) {
+            e.prevWindowMin = e.windowMin;
+            e.windowMin = offset;
+            e.windowFrames = 0;
+        }
+        e.baseOffset = (int32_t)(e.windowMin - e.prevWindowMin) < 0 ? e.windowMin : e.prevWindowMin;
+
+        int32_t excess = (int32_t)(offset - e.baseOffset);
+        uint32_t latency = excess > 0 ? (uint32_t)excess : 0;
+        if (e.latencySamples == 0) e.latencyAvgMs = latency;
+        else e.latencyAvgMs = e.latencyAvgMs + ((int32_t)latency - (int32_t)e.latencyAvgMs) / 8;
+        if (latency > e.latencyMaxMs) e.latencyMaxMs = latency;
+        e.latencySamples++;
+    }
+};
+
+#endif // MESH_SEQ_TRACKER_H
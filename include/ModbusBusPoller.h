@@ -0,0 +1,287 @@
+#ifndef MODBUS_BUS_POLLER_H
+#define MODBUS_BUS_POLLER_H
+
+#include <Arduino.h>
+#include <ModbusRTU.h>
+#include <HardwareSerial.h>
+#include "ModbusLinkHealth.h"
+
+#define MODBUS_POLLER_MAX_SLOTS 32
+#define MODBUS_POLLER_MAX_REGS  16
+
+/**
+ * Poller del bus Modbus RTU (maestro único sobre Serial2).
+ *
+ * Cada sensor registra un "slot" (dirección + bloque de registros) y pide
+ * lecturas con request(). poll() se llama en cada pasada del loop y maneja
+ * una máquina de estados sin delay(): despacha la siguiente petición en
+ * cuanto termina la anterior (el bus es half-duplex, una transacción a la
+ * vez) y deja el resultado en el slot. Una dirección muerta solo ocupa el
+ * bus mientras dura su timeout, no bloquea el loop.
+ *
+ * El timeout de cada slot se adapta a la latencia medida (ModbusLinkHealth)
+ * y las direcciones que dejan de responder se consultan cada vez menos.
+ */
+class ModbusBusPoller {
+public:
+    enum SlotState : uint8_t {
+        SLOT_IDLE,       // Sin petición pendiente, resultado disponible
+        SLOT_QUEUED,     // Esperando turno en el bus
+        SLOT_IN_FLIGHT   // Petición enviada, esperando respuesta
+    };
+
+    struct Slot {
+        uint8_t address;
+        uint16_t startReg;
+        uint8_t count;
+        SlotState state;
+        bool ok;                                // Resultado de la última transacción
+        uint16_t regs[MODBUS_POLLER_MAX_REGS];  // Último bloque leído correctamente
+        uint32_t sentMs;
+        uint32_t completedMs;
+        uint32_t lastLatencyMs;
+        ModbusLinkHealth health;
+        // Estadísticas
+        uint32_t requests;
+        uint32_t responses;
+        uint32_t timeouts;
+        uint32_t errors;
+        uint32_t skipped;                       // Peticiones omitidas por backoff
+    };
+
+    // ModbusRTU solo tiene un timeout fijo de compilación (MODBUSRTU_TIMEOUT).
+    // expire() adelanta el vencimiento de la transacción en curso para que la
+    // librería la cierre por su camino normal (callback EX_TIMEOUT).
+    class Master : public ModbusRTU {
+    public:
+        void expire() {
+            _timestamp = millis() - MODBUSRTU_TIMEOUT - 1;
+        }
+    };
+
+private:
+    Master* mb;
+    HardwareSerial* serial;
+    int rxPin;
+    int txPin;
+    int dePin;
+    uint32_t baudrate;
+
+    Slot slots[MODBUS_POLLER_MAX_SLOTS];
+    uint8_t slotCount;
+    uint8_t nextSlot;                            // Round-robin entre slots en cola
+    int inFlight;                                // Slot con transacción en curso, -1 si el bus está libre
+    uint16_t rxBuffer[MODBUS_POLLER_MAX_REGS];   // Destino de la transacción en curso
+
+    // La librería llama al callback desde mb->task(); solo hay un maestro por bus
+    static volatile bool transactionDone;
+    static volatile Modbus::ResultCode transactionResult;
+
+    static bool onTransaction(Modbus::ResultCode event, uint16_t transactionId, void* data) {
+        transactionResult = event;
+        transactionDone = true;
+        return true;
+    }
+
+    void complete(Modbus::ResultCode result) {
+        Slot& s = slots[inFlight];
+        s.completedMs = millis();
+        s.lastLatencyMs = s.completedMs - s.sentMs;
+        s.state = SLOT_IDLE;
+
+        if (result == Modbus::EX_SUCCESS) {
+            memcpy(s.regs, rxBuffer, s.count * sizeof(uint16_t));
+            s.ok = true;
+            s.responses++;
+            s.health.onSuccess(s.lastLatencyMs);
+        } else {
+            s.ok = false;
+            if (result == Modbus::EX_TIMEOUT) {
+                s.timeouts++;
+            } else {
+                s.errors++;
+                Serial.printf("[Modbus] Addr %d: error %02X\n", s.address, result);
+            }
+            recordFailure(s);
+        }
+        inFlight = -1;
+    }
+
+    // Fallo de una petición (timeout, excepción o rechazo de la librería): cuenta para el backoff
+    void recordFailure(Slot& s) {
+        s.health.onFailure(s.completedMs);
+        if (s.health.shouldSkip(s.completedMs)) {
+            Serial.printf("[Modbus] Addr %d: %d fallos seguidos, próximo intento en %lus\n",
+                          s.address, s.health.getConsecutiveFailures(),
+                          (unsigned long)(s.health.getBackoffMs() / 1000));
+        }
+    }
+
+    // Despacha la próxima petición en cola (round-robin). Devuelve true si el bus quedó ocupado.
+    bool dispatchNext() {
+        for (uint8_t n = 0; n < slotCount; n++) {
+            uint8_t i = (nextSlot + n) % slotCount;
+            Slot& s = slots[i];
+            if (s.state != SLOT_QUEUED) continue;
+
+            nextSlot = (i + 1) % slotCount;
+            s.requests++;
+            s.sentMs = millis();
+
+            transactionDone = false;
+            if (!mb->readHreg(s.address, s.startReg, rxBuffer, s.count, onTransaction)) {
+                // La librería rechazó la petición: se cuenta como error y se sigue con el resto
+                s.state = SLOT_IDLE;
+                s.ok = false;
+                s.errors++;
+                s.completedMs = s.sentMs;
+                recordFailure(s);
+                continue;
+            }
+            s.state = SLOT_IN_FLIGHT;
+            inFlight = i;
+            return true;
+        }
+        return false;
+    }
+
+public:
+    ModbusBusPoller()
+        : mb(nullptr), serial(nullptr), rxPin(-1), txPin(-1), dePin(-1), baudrate(0),
+          slotCount(0), nextSlot(0), inFlight(-1) {}
+
+    // Inicializa el bus una sola vez; llamadas posteriores reutilizan la configuración existente
+    bool begin(int rx, int tx, int de, uint32_t baud) {
+        if (mb) {
+            if (rx != rxPin || tx != txPin || de != dePin || baud != baudrate) {
+                Serial.println("[Modbus] Warning: Bus config mismatch, using existing config");
+            }
+            return true;
+        }
+
+        Serial.printf("[Modbus] Initializing shared bus: RX=%d, TX=%d, DE=%d, baud=%lu\n",
+                      rx, tx, de, (unsigned long)baud);
+
+        serial = &Serial2;
+        serial->begin(baud, SERIAL_8N1, rx, tx);
+
+        mb = new Master();
+        mb->begin(serial, de);
+        mb->master();
+
+        rxPin = rx;
+        txPin = tx;
+        dePin = de;
+        baudrate = baud;
+        return true;
+    }
+
+    bool isInitialized() const {
+        return mb != nullptr;
+    }
+
+    // Registra un bloque de holding registers a leer. Devuelve el índice del slot o -1.
+    int addSlot(uint8_t address, uint16_t startReg, uint8_t count) {
+        if (count == 0 || count > MODBUS_POLLER_MAX_REGS) return -1;
+
+        for (uint8_t i = 0; i < slotCount; i++) {
+            if (slots[i].address == address && slots[i].startReg == startReg && slots[i].count == count) {
+                return i;  // Mismo bloque ya registrado
+            }
+        }
+        if (slotCount >= MODBUS_POLLER_MAX_SLOTS) {
+            Serial.println("[Modbus] ✗ Sin slots libres");
+            return -1;
+        }
+
+        Slot& s = slots[slotCount];
+        s = Slot();
+        s.address = address;
+        s.startReg = startReg;
+        s.count = count;
+        s.state = SLOT_IDLE;
+        s.health.configure(baudrate, count);
+        return slotCount++;
+    }
+
+    // Encola una lectura. Si ya hay una pendiente para el slot no se duplica.
+    // Una dirección en backoff no se consulta: la petición termina al instante sin resultado.
+    bool request(int slot) {
+        if (!mb || slot < 0 || slot >= slotCount) return false;
+        Slot& s = slots[slot];
+        if (s.state != SLOT_IDLE) return true;
+
+        if (s.health.shouldSkip(millis())) {
+            s.ok = false;
+            s.skipped++;
+            return true;
+        }
+        s.state = SLOT_QUEUED;
+        return true;
+    }
+
+    void requestAll() {
+        for (uint8_t i = 0; i < slotCount; i++) {
+            request(i);
+        }
+    }
+
+    // Avanza la máquina de estados. No bloquea; llamar en cada pasada del loop.
+    void poll() {
+        if (!mb) return;
+
+        // Timeout adaptativo: cortar la espera según la latencia aprendida
+        if (inFlight >= 0 && !transactionDone &&
+            millis() - slots[inFlight].sentMs > slots[inFlight].health.timeoutMs()) {
+            mb->expire();
+        }
+
+        mb->task();
+
+        if (inFlight >= 0 && transactionDone) {
+            complete(transactionResult);
+        }
+
+        if (inFlight < 0) {
+            dispatchNext();
+        }
+    }
+
+    // Lectura bloqueante, solo para el arranque (detección de sensores)
+    bool readBlocking(int slot) {
+        if (!request(slot)) return false;
+        while (isPending(slot)) {
+            poll();
+            yield();
+        }
+        return slots[slot].ok;
+    }
+
+    bool isPending(int slot) const {
+        return slot >= 0 && slot < slotCount && slots[slot].state != SLOT_IDLE;
+    }
+
+    bool isBusy() const {
+        return inFlight >= 0;
+    }
+
+    int getSlotCount() const {
+        return slotCount;
+    }
+
+    const Slot* getSlot(int slot) const {
+        return (slot >= 0 && slot < slotCount) ? &slots[slot] : nullptr;
+    }
+
+    uint32_t getBaudrate() const {
+        return baudrate;
+    }
+};
+
+// Static member initialization
+volatile bool ModbusBusPoller::transactionDone = false;
+volatile Modbus::ResultCode ModbusBusPoller::transactionResult = Modbus::EX_SUCCESS;
+
+extern ModbusBusPoller modbusBus;
+
+#endif // MODBUS_BUS_POLLER_H
@@ -0,0 +1,88 @@
+#ifndef MODBUS_LINK_HEALTH_H
+#define MODBUS_LINK_HEALTH_H
+
+#include <stdint.h>
+
+#define MODBUS_TIMEOUT_MAX_MS       1000    // Timeout antes de conocer al dispositivo (y techo)
+#define MODBUS_TIMEOUT_SLACK_MS     15      // Margen sobre el tiempo de trama (turnaround del esclavo)
+#define MODBUS_BACKOFF_BASE_MS      10000   // Primer intervalo sin consultar una dirección muerta
+#define MODBUS_BACKOFF_MAX_MS       300000  // Re-probe al menos cada 5 minutos
+#define MODBUS_FAILURES_BEFORE_BACKOFF 2    // Un fallo aislado no activa el backoff
+
+/**
+ * Salud del enlace con una dirección Modbus.
+ *
+ * Aprende la latencia de respuesta con un EWMA (media y desvío, como el RTO
+ * de TCP) y deriva de ahí un timeout ajustado, nunca menor al tiempo físico
+ * de las tramas al baudrate del bus. Tras varios fallos seguidos la dirección
+ * entra en backoff exponencial: no se consulta hasta que vence, y la primera
+ * petición después funciona como re-probe.
+ */
+class ModbusLinkHealth {
+private:
+    uint32_t floorMs;          // Tiempo mínimo de ida y vuelta de las tramas
+    uint32_t srtt8;            // Latencia media × 8
+    uint32_t rttvar4;          // Desvío medio × 4
+    bool hasSample;
+    uint8_t consecutiveFailures;
+    uint32_t backoffMs;
+    uint32_t backoffStartMs;
+
+public:
+    ModbusLinkHealth()
+        : floorMs(0), srtt8(0), rttvar4(0), hasSample(false),
+          consecutiveFailures(0), backoffMs(0), backoffStartMs(0) {}
+
+    // Tiempo de tramas para leer regCount registros (función 03, 8N1 = 10 bits por byte)
+    void configure(uint32_t baudrate, uint8_t regCount) {
+        uint32_t bytes = 8 + 5 + 2 * (uint32_t)regCount;   // Petición + respuesta
+        uint32_t bits = bytes * 10 + 2 * 35;               // + silencio t3.5 tras cada trama
+        floorMs = baudrate ? (bits * 1000 + baudrate - 1) / baudrate : 0;
+    }
+
+    void onSuccess(uint32_t latencyMs) {
+        if (!hasSample) {
+            srtt8 = latencyMs << 3;
+            rttvar4 = latencyMs << 1;            // var = latencia / 2
+            hasSample = true;
+        } else {
+            int32_t err = (int32_t)latencyMs - (int32_t)(srtt8 >> 3);
+            srtt8 += err;                        // srtt += err / 8
+            if (err < 0) err = -err;
+            rttvar4 += err - (int32_t)(rttvar4 >> 2);  // var += (|err| - var) / 4
+        }
+        consecutiveFailures = 0;
+        backoffMs = 0;
+    }
+
+    void onFailure(uint32_t now) {
+        if (consecutiveFailures < 255) consecutiveFailures++;
+        if (consecutiveFailures < MODBUS_FAILURES_BEFORE_BACKOFF) return;
+
+        backoffMs = backoffMs ? backoffMs * 2 : MODBUS_BACKOFF_BASE_MS;
+        if (backoffMs > MODBUS_BACKOFF_MAX_MS) backoffMs = MODBUS_BACKOFF_MAX_MS;
+        backoffStartMs = now;
+    }
+
+    // true mientras la dirección está en backoff (no consultar)
+    bool shouldSkip(uint32_t now) const {
+        return backoffMs && (now - backoffStartMs < backoffMs);
+    }
+
+    // srtt + 4·rttvar, acotado entre el tiempo de tramas (+ margen) y el máximo
+    uint32_t timeoutMs() const {
+        if (!hasSample) return MODBUS_TIMEOUT_MAX_MS;
+        uint32_t t = (srtt8 >> 3) + rttvar4;
+        uint32_t minimum = floorMs + MODBUS_TIMEOUT_SLACK_MS;
+        if (t < minimum) t = minimum;
+        if (t > MODBUS_TIMEOUT_MAX_MS) t = MODBUS_TIMEOUT_MAX_MS;
+        return t;
+    }
+
+    uint32_t getLatencyMs() const { return srtt8 >> 3; }
+    uint32_t getFrameTimeMs() const { return floorMs; }
+    uint8_t getConsecutiveFailures() const { return consecutiveFailures; }
+    uint32_t getBackoffMs() const { return backoffMs; }
+};
+
+#endif // MODBUS_LINK_HEALTH_H
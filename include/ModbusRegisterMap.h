@@ -0,0 +1,186 @@
+#ifndef MODBUS_REGISTER_MAP_H
+#define MODBUS_REGISTER_MAP_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#define MODBUS_FIELD_NAME_LEN   12
+#define MODBUS_SENSOR_MAX_FIELDS 12
+#define MODBUS_SENSOR_MAX_BLOCKS 4
+#define MODBUS_COALESCE_MAX_GAP  4   // Registros sin usar que conviene leer antes que abrir otra trama
+
+/**
+ * Mapa de registros de un sensor Modbus (descriptor de campos).
+ *
+ * Cada campo dice en qué holding register está, cómo interpretarlo y por
+ * cuánto escalarlo. planModbusBlocks() agrupa los campos cercanos en bloques
+ * contiguos para leerlos con una sola función 03 por bloque: un registro de
+ * más cuesta 2 bytes en el bus, una trama extra cuesta ~25 ms a 9600 baud.
+ */
+
+enum ModbusDataType : uint8_t {
+    MB_U16,
+    MB_S16,
+    MB_U32,   // Dos registros, palabra alta primero
+    MB_S32,
+    MB_F32    // IEEE 754, palabra alta primero
+};
+
+struct ModbusFieldDesc {
+    char name[MODBUS_FIELD_NAME_LEN];  // Nombre del campo en Grafana
+    uint16_t reg;
+    ModbusDataType type;
+    float scale;
+    uint8_t decimals;
+};
+
+struct ModbusBlock {
+    uint16_t start;
+    uint8_t count;
+};
+
+struct ModbusPreset {
+    const char* name;
+    const char* idPrefix;    // Prefijo del sensor ID: "<prefix>-mod-<address>"
+    const char* typeName;    // Tipo reportado: "modbus_<typeName>_<address>"
+    const ModbusFieldDesc* fields;
+    uint8_t fieldCount;
+};
+
+inline uint8_t modbusTypeWidth(ModbusDataType type) {
+    return (type == MB_U16 || type == MB_S16) ? 1 : 2;
+}
+
+inline bool parseModbusType(const char* s, ModbusDataType& out) {
+    if (!s) return false;
+    if (strcmp(s, "u16") == 0) { out = MB_U16; return true; }
+    if (strcmp(s, "s16") == 0) { out = MB_S16; return true; }
+    if (strcmp(s, "u32") == 0) { out = MB_U32; return true; }
+    if (strcmp(s, "s32") == 0) { out = MB_S32; return true; }
+    if (strcmp(s, "f32") == 0) { out = MB_F32; return true; }
+    return false;
+}
+
+// Decimales a publicar según la escala (0.1 → 1, 0.01 → 2, 1 → 0)
+inline uint8_t modbusScaleDecimals(float scale) {
+    if (scale <= 0 || scale >= 1) return 0;
+    int d = (int)lroundf(-log10f(scale));
+    return d < 0 ? 0 : (d > 4 ? 4 : d);
+}
+
+inline float decodeModbusField(const uint16_t* regs, ModbusDataType type, float scale) {
+    switch (type) {
+        case MB_U16:
+            return regs[0] * scale;
+        case MB_S16:
+            return (int16_t)regs[0] * scale;
+        case MB_U32:
+            return (((uint32_t)regs[0] << 16) | regs[1]) * scale;
+        case MB_S32:
+            return (int32_t)(((uint32_t)regs[0] << 16) | regs[1]) * scale;
+        case MB_F32: {
+            uint32_t raw = ((uint32_t)regs[0] << 16) | regs[1];
+            float f;
+            memcpy(&f, &raw, sizeof(f));
+            return f * scale;
+        }
+    }
+    return NAN;
+}
+
+/**
+ * Agrupa los campos en bloques contiguos de a lo sumo maxRegs registros,
+ * uniendo campos separados por hasta maxGap registros sin usar.
+ * Devuelve la cantidad de bloques, o -1 si no entran en maxBlocks.
+ */
+inline int planModbusBlocks(const ModbusFieldDesc* fields, int n, uint8_t maxRegs, uint8_t maxGap,
+                            ModbusBlock* blocks, int maxBlocks) {
+    if (n <= 0 || n > MODBUS_SENSOR_MAX_FIELDS) return n == 0 ? 0 : -1;
+
+    // Orden por registro (inserción: n es chico)
+    int order[MODBUS_SENSOR_MAX_FIELDS];
+    for (int i = 0; i < n; i++) {
+        int j = i;
+        while (j > 0 && fields[order[j - 1]].reg > fields[i].reg) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+
+    int count = 0;
+    uint32_t blockStart = 0, blockEnd = 0;  // [start, end)
+    for (int k = 0; k < n; k++) {
+        const ModbusFieldDesc& f = fields[order[k]];
+        uint32_t start = f.reg;
+        uint32_t end = start + modbusTypeWidth(f.type);
+        if (end - start > maxRegs) return -1;
+
+        if (count > 0) {
+            uint32_t mergedEnd = end > blockEnd ? end : blockEnd;
+            bool closeEnough = start <= blockEnd + maxGap;
+            if (closeEnough && mergedEnd - blockStart <= maxRegs) {
+                blockEnd = mergedEnd;
+                blocks[count - 1].count = blockEnd - blockStart;
+                continue;
+            }
+        }
+
+        if (count >= maxBlocks) return -1;
+        blockStart = start;
+        blockEnd = end;
+        blocks[count].start = start;
+        blocks[count].count = end - start;
+        count++;
+    }
+    return count;
+}
+
+// Bloque que contiene por completo al campo, o -1
+inline int findModbusBlock(const ModbusBlock* blocks, int n, const ModbusFieldDesc& f) {
+    uint32_t end = (uint32_t)f.reg + modbusTypeWidth(f.type);
+    for (int i = 0; i < n; i++) {
+        if (f.reg >= blocks[i].start && end <= (uint32_t)blocks[i].start + blocks[i].count) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// ============================================================================
+// Presets
+// ============================================================================
+
+// TH-MB-04S (docs/sensorsDataSheet/TH-MB-XXX-DS.pdf)
+static const ModbusFieldDesc MODBUS_PRESET_TH_MB_04S[] = {
+    {"temp", 1, MB_S16, 0.1f, 1},
+    {"hum",  0, MB_U16, 0.1f, 1},
+};
+
+// SN-3002 suelo 7 en 1: humedad, temperatura, EC, pH, N, P, K
+// (docs/sensorsDataSheet/sn-3002-tr-ectgnpkph-n01.pdf)
+static const ModbusFieldDesc MODBUS_PRESET_NPK_7IN1[] = {
+    {"soilHum",  0, MB_U16, 0.1f, 1},   // % volumétrico
+    {"soilTemp", 1, MB_S16, 0.1f, 1},   // °C, complemento a 2 bajo cero
+    {"ec",       2, MB_U16, 1.0f, 0},   // µS/cm
+    {"ph",       3, MB_U16, 0.1f, 1},
+    {"n",        4, MB_U16, 1.0f, 0},   // mg/kg
+    {"p",        5, MB_U16, 1.0f, 0},
+    {"k",        6, MB_U16, 1.0f, 0},
+};
+
+static const ModbusPreset MODBUS_PRESETS[] = {
+    {"th_mb_04s", "th",  "th",   MODBUS_PRESET_TH_MB_04S, 2},
+    {"npk_7in1",  "npk", "soil", MODBUS_PRESET_NPK_7IN1,  7},
+};
+
+inline const ModbusPreset* findModbusPreset(const char* name) {
+    if (!name) return nullptr;
+    for (const ModbusPreset& p : MODBUS_PRESETS) {
+        if (strcmp(p.name, name) == 0) return &p;
+    }
+    return nullptr;
+}
+
+#endif // MODBUS_REGISTER_MAP_H
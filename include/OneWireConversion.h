@@ -0,0 +1,83 @@
+#ifndef ONEWIRE_CONVERSION_H
+#define ONEWIRE_CONVERSION_H
+
+#include <stdint.h>
+
+#define ONEWIRE_MAX_CONVERSION_MS 750   // DS18B20 a 12 bits
+
+/**
+ * Conversión de temperatura en curso en un bus OneWire.
+ *
+ * Un solo Convert T (Skip ROM) hace convertir a la vez a todas las sondas
+ * del bus, así que la conversión es del bus y no de cada sonda: la primera
+ * sonda vencida la arranca y las que vencen mientras dura se suman a ella.
+ * El resultado está listo al cumplirse el tiempo de conversión de la
+ * resolución, o antes si el bus avisa que terminó (complete()).
+ *
+ * Cada bus lleva su propia conversión, así varios buses convierten en
+ * paralelo sin que el loop espere a ninguno.
+ */
+class OneWireConversion {
+public:
+    // Tiempo de conversión del DS18B20 según la resolución: 94, 188, 375 o 750 ms
+    static uint16_t conversionMs(uint8_t bits) {
+        if (bits <= 9) return 94;
+        if (bits == 10) return 188;
+        if (bits == 11) return 375;
+        return ONEWIRE_MAX_CONVERSION_MS;
+    }
+
+    OneWireConversion() { begin(ONEWIRE_MAX_CONVERSION_MS); }
+
+    // waitMs = 0: la conversión ya terminó al arrancarla (alimentación parásita, bloqueante)
+    void begin(uint16_t waitMs) {
+        wait = waitMs;
+        converting = false;
+        startedMs = 0;
+        conversions = 0;
+        earlyCompletions = 0;
+        lastDurationMs = 0;
+    }
+
+    // Devuelve true si hay que enviar Convert T; false si ya hay una en curso (la sonda se suma)
+    bool start(uint32_t now) {
+        if (converting) return false;
+        converting = true;
+        startedMs = now;
+        conversions++;
+        return true;
+    }
+
+    // ¿Sigue convirtiendo? Vence sola al cumplirse el tiempo de la resolución
+    bool pending(uint32_t now) {
+        if (converting && now - startedMs >= wait) finish(now);
+        return converting;
+    }
+
+    // El bus avisó que todas las sondas terminaron antes de tiempo
+    void complete(uint32_t now) {
+        if (!converting) return;
+        earlyCompletions++;
+        finish(now);
+    }
+
+    uint16_t getWaitMs() const { return wait; }
+    uint32_t getConversions() const { return conversions; }
+    uint32_t getEarlyCompletions() const { return earlyCompletions; }
+    uint32_t getLastDurationMs() const { return lastDurationMs; }
+
+private:
+    uint16_t wait;
+    bool converting;
+    uint32_t startedMs;
+    uint32_t conversions;
+    uint32_t earlyCompletions;
+    uint32_t lastDurationMs;
+
+    void finish(uint32_t now) {
+        converting = false;
+        lastDurationMs = now - startedMs;
+    }
+};
+
+#endif // ONEWIRE_CONVERSION_H
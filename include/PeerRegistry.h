@@ -0,0 +1,249 @@
+#ifndef PEER_REGISTRY_H
+#define PEER_REGISTRY_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PEER_REGISTRY_DEFAULT_CAPACITY 20
+#define PEER_REGISTRY_MAX_CAPACITY     64
+
+struct PeerEntry {
+    uint8_t mac[6];
+    int8_t rssi;            // Último RSSI (0 con IDF 4.x)
+    bool inDriver;          // Registrado en la tabla de peers de ESP-NOW
+    uint32_t lastSeq;       // Última secuencia de datos originada por el peer
+    uint32_t frames;        // Tramas recibidas directamente del peer
+    uint32_t bytes;
+    uint32_t pairedMs;
+    uint32_t lastSeenMs;
+};
+
+struct PeerRegistryStats {
+    uint32_t lookups;
+    uint32_t evictions;     // Peers desalojados (LRU) por falta de lugar
+    uint32_t expired;       // Peers olvidados por inactividad
+    uint8_t maxProbe;
+};
+
+/**
+ * Registro de peers del gateway.
+ *
+ * Las entradas viven en un arreglo fijo y no se mueven (los punteros
+ * devueltos son estables mientras la entrada exista); un índice hash de
+ * direccionamiento abierto (MAC → entrada, ocupado a lo sumo a la mitad)
+ * da la búsqueda en O(1), y una lista doblemente enlazada en orden de
+ * uso da el desalojo LRU y el vencimiento por inactividad sin recorrer la
+ * tabla. La cantidad de peers se mantiene al insertar y borrar.
+ *
+ * La tabla de peers del driver de ESP-NOW es más chica
+ * (ESP_NOW_MAX_TOTAL_PEER_NUM); inDriver y leastRecentInDriver() permiten
+ * reciclar esos lugares sin olvidar las estadísticas del peer.
+ */
+class PeerRegistry {
+public:
+    PeerRegistry() { begin(PEER_REGISTRY_DEFAULT_CAPACITY); }
+
+    // Cantidad de peers (1..PEER_REGISTRY_MAX_CAPACITY). Borra el registro.
+    void begin(uint16_t capacity) {
+        if (capacity < 1) capacity = 1;
+        if (capacity > PEER_REGISTRY_MAX_CAPACITY) capacity = PEER_REGISTRY_MAX_CAPACITY;
+        cap = capacity;
+        indexSize = 1;
+        while (indexSize < cap * 2) indexSize <<= 1;
+        clear();
+    }
+
+    void clear() {
+        memset(entries, 0, sizeof(entries));
+        memset(index, NONE, sizeof(index));
+        memset(&stats, 0, sizeof(stats));
+        count = 0;
+        mru = lru = NONE;
+        freeHead = 0;
+        for (int i = 0; i < cap; i++) links[i].next = (i + 1 < cap) ? i + 1 : NONE;
+    }
+
+    PeerEntry* find(const uint8_t* mac) {
+        int slot = findSlot(mac);
+        return slot < 0 ? nullptr : &entries[index[slot]];
+    }
+
+    /**
+     * Registra el peer (o lo refresca si ya estaba). Con el registro lleno
+     * desaloja el menos usado y copia su entrada en evicted (si no es
+     * nullptr) para que el llamador libere su lugar en el driver.
+     */
+    PeerEntry* add(const uint8_t* mac, uint32_t now, PeerEntry* evicted = nullptr, bool* didEvict = nullptr) {
+        if (didEvict) *didEvict = false;
+        PeerEntry* e = find(mac);
+        if (e) {
+            touch(e, now);
+            return e;
+        }
+
+        if (count >= cap) {
+            if (evicted) *evicted = entries[lru];
+            if (didEvict) *didEvict = true;
+            removeEntry(lru);
+            stats.evictions++;
+        }
+
+        int i = freeHead;
+        freeHead = links[i].next;
+        memset(&entries[i], 0, sizeof(entries[i]));
+        memcpy(entries[i].mac, mac, 6);
+        entries[i].pairedMs = now;
+        entries[i].lastSeenMs = now;
+
+        uint16_t mask = indexSize - 1;
+        uint16_t slot = hashMac(mac) & mask;
+        while (index[slot] != NONE) slot = (slot + 1) & mask;
+        index[slot] = i;
+
+        pushFront(i);
+        count++;
+        return &entries[i];
+    }
+
+    // Trama recibida directamente del peer. Devuelve nullptr si no está registrado.
+    PeerEntry* onFrame(const uint8_t* mac, uint16_t len, int8_t rssi, uint32_t now) {
+        PeerEntry* e = find(mac);
+        if (!e) return nullptr;
+        e->frames++;
+        e->bytes += len;
+        e->rssi = rssi;
+        touch(e, now);
+        return e;
+    }
+
+    bool remove(const uint8_t* mac) {
+        int slot = findSlot(mac);
+        if (slot < 0) return false;
+        removeEntry(index[slot]);
+        return true;
+    }
+
+    // Peer menos usado sin noticias hace más de timeoutMs, o nullptr. Para vencerlos de a uno.
+    const PeerEntry* oldestIdle(uint32_t now, uint32_t timeoutMs) const {
+        if (lru == NONE || now - entries[lru].lastSeenMs <= timeoutMs) return nullptr;
+        return &entries[lru];
+    }
+
+    void expire(const uint8_t* mac) {
+        if (remove(mac)) stats.expired++;
+    }
+
+    // Peer menos usado que ocupa un lugar en el driver, distinto de except
+    PeerEntry* leastRecentInDriver(const uint8_t* except = nullptr) {
+        for (int i = lru; i != NONE; i = links[i].prev) {
+            if (!entries[i].inDriver) continue;
+            if (except && memcmp(entries[i].mac, except, 6) == 0) continue;
+            return &entries[i];
+        }
+        return nullptr;
+    }
+
+    // Recorrido del más reciente al menos reciente: first(), luego next(e)
+    const PeerEntry* first() const { return mru == NONE ? nullptr : &entries[mru]; }
+    const PeerEntry* next(const PeerEntry* e) const {
+        int n = links[e - entries].next;
+        return n == NONE ? nullptr : &entries[n];
+    }
+
+    uint16_t size() const { return count; }
+    uint16_t getCapacity() const { return cap; }
+    const PeerRegistryStats& getStats() const { return stats; }
+
+private:
+    static const int8_t NONE = -1;
+
+    struct Link {
+        int8_t prev;    // Hacia el más reciente
+        int8_t next;    // Hacia el menos reciente (o siguiente libre)
+    };
+
+    PeerEntry entries[PEER_REGISTRY_MAX_CAPACITY];
+    Link links[PEER_REGISTRY_MAX_CAPACITY];
+    int8_t index[PEER_REGISTRY_MAX_CAPACITY * 2];   // Slot hash → entrada
+    uint16_t indexSize;
+    uint16_t cap;
+    uint16_t count;
+    int8_t mru;
+    int8_t lru;
+    int8_t freeHead;
+    PeerRegistryStats stats;
+
+    // FNV-1a sobre los 6 bytes; los bits altos se pliegan porque el índice usa los bajos
+    static uint32_t hashMac(const uint8_t* mac) {
+        uint32_t h = 2166136261UL;
+        for (int i = 0; i < 6; i++) {
+            h ^= mac[i];
+            h *= 16777619UL;
+        }
+        return h ^ (h >> 16);
+    }
+
+    int findSlot(const uint8_t* mac) {
+        stats.lookups++;
+        uint16_t mask = indexSize - 1;
+        uint16_t slot = hashMac(mac) & mask;
+        for (uint8_t probes = 1; probes <= indexSize; probes++) {
+            if (probes > stats.maxProbe) stats.maxProbe = probes;
+            if (index[slot] == NONE) return -1;
+            if (memcmp(entries[index[slot]].mac, mac, 6) == 0) return slot;
+            slot = (slot + 1) & mask;
+        }
+        return -1;
+    }
+
+    void touch(PeerEntry* e, uint32_t now) {
+        e->lastSeenMs = now;
+        int i = e - entries;
+        if (i == mru) return;
+        unlink(i);
+        pushFront(i);
+    }
+
+    void pushFront(int i) {
+        links[i].prev = NONE;
+        links[i].next = mru;
+        if (mru != NONE) links[mru].prev = i;
+        mru = i;
+        if (lru == NONE) lru = i;
+    }
+
+    void unlink(int i) {
+        if (links[i].prev != NONE) links[links[i].prev].next = links[i].next;
+        else mru = links[i].next;
+        if (links[i].next != NONE) links[links[i].next].prev = links[i].prev;
+        else lru = links[i].prev;
+    }
+
+    // Saca la entrada del índice (corrimiento hacia atrás, sin lápidas) y de la lista
+    void removeEntry(int i) {
+        uint16_t mask = indexSize - 1;
+        uint16_t hole = hashMac(entries[i].mac) & mask;
+        while (index[hole] != i) hole = (hole + 1) & mask;
+
+        uint16_t s = (hole + 1) & mask;
+        while (index[s] != NONE) {
+            uint16_t home = hashMac(entries[index[s]].mac) & mask;
+            // ¿home está fuera del intervalo cíclico (hole, s]? entonces se puede mover al hueco
+            bool movable = (s > hole) ? (home <= hole || home > s) : (home <= hole && home > s);
+            if (movable) {
+                index[hole] = index[s];
+                hole = s;
+            }
+            s = (s + 1) & mask;
+        }
+        index[hole] = NONE;
+
+        unlink(i);
+        links[i].next = freeHead;
+        freeHead = i;
+        entries[i].inDriver = false;
+        count--;
+    }
+};
+
+#endif // PEER_REGISTRY_H
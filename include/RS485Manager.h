@@ -3,6 +3,7 @@
 
 #include <Arduino.h>
 #include <HardwareSerial.h>
+#include "Measurement.h"
 
 class RS485Manager {
 private:
@@ -78,18 +79,18 @@ public:
         setReceiveMode();
     }
 
-    // Send formatted data
-    void sendSensorData(float temperature, float humidity, float co2, const char* sensorType) {
-        String message = String(sensorType) + " - ";
-
-        if (temperature >= 0) {
-            message += "Temp: " + String(temperature, 1) + "°C ";
-        }
-
-        message += "Humedad: " + String(humidity, 1) + "% ";
-
-        if (co2 >= 0) {
-            message += "CO2: " + String(co2, 0) + "ppm";
+    // Send formatted data: "<id> - Temp: 25.3°C Humedad: 60.5% CO2: 415ppm"
+    void sendMeasurements(const char* sensorId, const MeasurementSet& measurements) {
+        String message = String(sensorId) + " -";
+
+        for (const Measurement& m : measurements) {
+            if (m.quality == MEAS_INVALID) continue;
+            switch (m.field) {
+                case MEAS_TEMP: message += " Temp: " + String(m.value, 1) + "°C"; break;
+                case MEAS_HUM:  message += " Humedad: " + String(m.value, 1) + "%"; break;
+                case MEAS_CO2:  message += " CO2: " + String(m.value, 0) + "ppm"; break;
+                default:        message += " " + String(m.name) + ": " + String(m.value, (unsigned int)m.decimals); break;
+            }
         }
 
         send(message + "\r\n");
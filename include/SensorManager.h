@@ -13,15 +13,62 @@
 #include "sensors/SensorSimulated.h"
 #include "sensors/SensorOneWire.h"
 #include "sensors/HD38Sensor.h"
+#include "constants.h"
+#include "StreamingStats.h"
+#include "DeadbandFilter.h"
 
 #ifdef ENABLE_RS485
-  #include "sensors/ModbusTHSensor.h"
+  #include "sensors/ModbusSensor.h"
 #endif
 
 class SensorManager {
 private:
+    // Período de lectura de cada sensor (paralelo a sensors)
+    struct SensorSchedule {
+        uint32_t periodMs;
+        uint32_t lastReadMs;
+        bool neverRead;
+        bool pending;  // Lectura en dos fases en curso
+        uint32_t reportMs;            // Ventana de reporte (0 = publicar cada lectura)
+        uint32_t windowStartMs;
+        MeasurementWindow* window;    // Solo si reportMs > 0
+        DeadbandFilter* deadband;     // Solo si config.deadband está presente
+    };
+
     std::vector<ISensor*> sensors;
-    std::vector<DallasTemperature*> dallasInstances;  // Para cleanup
+    std::vector<SensorSchedule> schedules;
+    std::vector<ISensor*> dueSensors;                 // Resultado de readDue(), reutilizado
+    std::vector<OneWireBus*> oneWireBuses;            // Uno por pin, para cleanup
+    bool reportWindows = true;
+
+    void addSensor(ISensor* s, uint32_t periodMs, uint32_t reportMs = 0, JsonObject cfg = JsonObject()) {
+        sensors.push_back(s);
+        MeasurementWindow* window = reportMs > periodMs ? new MeasurementWindow() : nullptr;
+        schedules.push_back({periodMs, 0, true, false, window ? reportMs : 0, 0, window, makeDeadband(cfg)});
+    }
+
+    // "deadband": banda para todos los campos (número) o por campo ({"temp": 0.2});
+    // "heartbeat_ms": máximo silencio, igual (número u objeto por campo)
+    static DeadbandFilter* makeDeadband(JsonObject cfg) {
+        JsonVariant band = cfg["deadband"];
+        if (band.isNull()) return nullptr;
+        JsonVariant heartbeat = cfg["heartbeat_ms"];
+
+        DeadbandFilter* f = new DeadbandFilter(band.is<float>() ? band.as<float>() : 0,
+                                               heartbeat.is<uint32_t>() ? heartbeat.as<uint32_t>()
+                                                                        : DEADBAND_DEFAULT_HEARTBEAT_MS);
+        if (band.is<JsonObject>()) {
+            for (JsonPair kv : band.as<JsonObject>()) f->setBand(kv.key().c_str(), kv.value().as<float>());
+        }
+        if (heartbeat.is<JsonObject>()) {
+            for (JsonPair kv : heartbeat.as<JsonObject>()) f->setHeartbeat(kv.key().c_str(), kv.value().as<uint32_t>());
+        }
+        return f;
+    }
+
+    bool isDue(size_t i, uint32_t now) const {
+        return schedules[i].neverRead || (now - schedules[i].lastReadMs >= schedules[i].periodMs);
+    }
 
 public:
     SensorManager() {}
@@ -31,15 +78,24 @@ public:
         for (auto* sensor : sensors) {
             delete sensor;
         }
-        for (auto* dallas : dallasInstances) {
-            delete dallas;
+        for (auto* bus : oneWireBuses) {
+            delete bus;
+        }
+        for (auto& sched : schedules) {
+            delete sched.window;
+            delete sched.deadband;
         }
     }
 
     void loadFromConfig(JsonDocument& config) {
+        // Sobremuestreo del barrido ADC compartido (capacitive, hd38)
+        const char* adcFilter = config["adc_filter"] | "trimmed_mean";
+        adcScanner.configure(config["adc_samples"] | ADC_OVERSAMPLE_DEFAULT,
+                             strcmp(adcFilter, "median") == 0 ? ADC_FILTER_MEDIAN : ADC_FILTER_TRIMMED_MEAN);
+
         if (!config["sensors"].is<JsonArray>()) {
             Serial.println("No sensors config found, using default capacitive");
-            sensors.push_back(new SensorCapacitive());
+            addSensor(new SensorCapacitive(), DEFAULT_SENSOR_PERIOD_MS);
             sensors[0]->init();
             return;
         }
@@ -52,33 +108,40 @@ public:
 
             const char* type = sensorCfg["type"];
             JsonObject cfg = sensorCfg["config"];
+            uint32_t period = cfg["period_ms"] | DEFAULT_SENSOR_PERIOD_MS;
+            uint32_t report = cfg["report_ms"] | 0;
+            if (report > period && !cfg["deadband"].isNull()) {
+                // La ventana ya reduce el tráfico; la banda solo se usa en deep sleep, que no tiene ventana
+                Serial.printf("[⚠ WARN] Sensor '%s': con report_ms se publica la ventana entera, deadband solo aplica con espnow_deep_sleep\n",
+                              type ? type : "?");
+            }
 
             if (strcmp(type, "capacitive") == 0) {
                 int pin = cfg["pin"] | 34;
                 ISensor* s = new SensorCapacitive(pin);
                 if (s->init()) {
-                    sensors.push_back(s);
+                    addSensor(s, period, report, cfg);
                     Serial.printf("Capacitive sensor on pin %d added\n", pin);
                 }
 
             } else if (strcmp(type, "scd30") == 0) {
                 ISensor* s = new SensorSCD30();
                 if (s->init()) {
-                    sensors.push_back(s);
+                    addSensor(s, period, report, cfg);
                     Serial.println("SCD30 sensor added");
                 }
 
             } else if (strcmp(type, "bme280") == 0) {
                 ISensor* s = new SensorBME280();
                 if (s->init()) {
-                    sensors.push_back(s);
+                    addSensor(s, period, report, cfg);
                     Serial.println("BME280 sensor added");
                 }
 
             } else if (strcmp(type, "simulated") == 0) {
                 ISensor* s = new SensorSimulated();
                 if (s->init()) {
-                    sensors.push_back(s);
+                    addSensor(s, period, report, cfg);
                     Serial.println("Simulated sensor added");
                 }
 
@@ -86,20 +149,53 @@ public:
                 int pin = cfg["pin"] | 4;
                 bool scan = cfg["scan"] | true;
                 if (scan) {
-                    int count = scanOneWire(pin);
+                    int count = scanOneWire(pin, period, report, cfg);
                     Serial.printf("OneWire: %d sensors detected on pin %d\n", count, pin);
                 }
 
             }
 #ifdef ENABLE_RS485
-            else if (strcmp(type, "modbus_th") == 0) {
-                // Modbus RTU Temperature/Humidity sensor (TH-MB-04S)
+            else if (strcmp(type, "modbus_th") == 0 || strcmp(type, "modbus") == 0) {
+                // Modbus RTU sensors described by a register map:
+                // "modbus_th" = TH-MB-04S (backwards compatible), "modbus" = preset or custom fields
                 // Supports multiple addresses on the same bus
                 int rx = cfg["rx_pin"] | 16;
                 int tx = cfg["tx_pin"] | 17;
                 int de = cfg["de_pin"] | -1;
                 uint32_t baud = cfg["baudrate"] | 9600;
 
+                const char* presetName = (strcmp(type, "modbus_th") == 0) ? "th_mb_04s" : (cfg["preset"] | "");
+                const ModbusPreset* preset = findModbusPreset(presetName);
+
+                ModbusFieldDesc fields[MODBUS_SENSOR_MAX_FIELDS];
+                uint8_t fieldCount = 0;
+                const char* idPrefix = cfg["id_prefix"] | "mb";
+                const char* typeName = cfg["name"] | "custom";
+
+                if (preset) {
+                    memcpy(fields, preset->fields, preset->fieldCount * sizeof(ModbusFieldDesc));
+                    fieldCount = preset->fieldCount;
+                    idPrefix = preset->idPrefix;
+                    typeName = preset->typeName;
+                } else if (cfg["fields"].is<JsonArray>()) {
+                    // Custom map: [{"name": "ec", "reg": 2, "type": "u16", "scale": 1}, ...]
+                    for (JsonObject f : cfg["fields"].as<JsonArray>()) {
+                        if (fieldCount >= MODBUS_SENSOR_MAX_FIELDS) break;
+                        ModbusFieldDesc& d = fields[fieldCount];
+                        strlcpy(d.name, f["name"] | "value", sizeof(d.name));
+                        d.reg = f["reg"] | 0;
+                        d.scale = f["scale"] | 1.0f;
+                        d.decimals = f["decimals"] | modbusScaleDecimals(d.scale);
+                        if (!parseModbusType(f["type"] | "u16", d.type)) {
+                            Serial.printf("Modbus: tipo inválido en campo '%s'\n", d.name);
+                            continue;
+                        }
+                        fieldCount++;
+                    }
+                } else {
+                    Serial.printf("Modbus: preset '%s' desconocido y sin 'fields'\n", presetName);
+                }
+
                 // Check for addresses array or single address
                 std::vector<uint8_t> addrList;
 
@@ -115,13 +211,14 @@ public:
 
                 // Create sensor for each address
                 for (uint8_t addr : addrList) {
-                    ISensor* s = new ModbusTHSensor(addr, rx, tx, de, baud);
+                    if (fieldCount == 0) break;
+                    ISensor* s = new ModbusSensor(addr, fields, fieldCount, idPrefix, typeName, rx, tx, de, baud);
                     if (s->init()) {
-                        sensors.push_back(s);
-                        Serial.printf("ModbusTH sensor (addr=%d) added\n", addr);
+                        addSensor(s, period, report, cfg);
+                        Serial.printf("Modbus sensor %s (addr=%d) added\n", s->getSensorType(), addr);
                     } else {
                         delete s;
-                        Serial.printf("ModbusTH sensor (addr=%d) init failed\n", addr);
+                        Serial.printf("Modbus sensor (addr=%d) init failed\n", addr);
                     }
                 }
             }
@@ -136,7 +233,7 @@ public:
 
                 ISensor* s = new HD38Sensor(aPin, dPin, divider, invert, name);
                 if (s->init()) {
-                    sensors.push_back(s);
+                    addSensor(s, period, report, cfg);
                     Serial.printf("HD38 sensor '%s' on pin %d added\n", name, aPin);
                 } else {
                     delete s;
@@ -148,50 +245,152 @@ public:
         Serial.printf("Total sensors active: %d\n", sensors.size());
     }
 
-    int scanOneWire(int pin) {
-        OneWire* oneWire = new OneWire(pin);
-        DallasTemperature* dallas = new DallasTemperature(oneWire);
-        dallas->begin();
+    int scanOneWire(int pin, uint32_t period = DEFAULT_SENSOR_PERIOD_MS, uint32_t report = 0,
+                    JsonObject cfg = JsonObject()) {
+        OneWireBus* bus = new OneWireBus(pin);
+        bus->dallas.begin();
 
-        dallasInstances.push_back(dallas);  // Store for cleanup
+        oneWireBuses.push_back(bus);  // Store for cleanup
 
-        int deviceCount = dallas->getDeviceCount();
+        int deviceCount = bus->dallas.getDeviceCount();
 
         for (int i = 0; i < deviceCount; i++) {
             DeviceAddress addr;
-            if (dallas->getAddress(addr, i)) {
-                ISensor* s = new SensorOneWire(dallas, addr, i);
+            if (bus->dallas.getAddress(addr, i)) {
+                ISensor* s = new SensorOneWire(bus, addr, i);
                 if (s->init()) {
-                    sensors.push_back(s);
+                    addSensor(s, period, report, cfg);
                 }
             }
         }
 
-        // Request temperatures for all devices (async)
-        dallas->requestTemperatures();
+        // Con la resolución ya fijada: conversiones sin espera
+        bus->configure();
 
         return deviceCount;
     }
 
-    void readAll() {
-        // Request temperatures from all OneWire sensors first (async)
-        for (auto* dallas : dallasInstances) {
-            dallas->requestTemperatures();
+    // Lee solo los sensores cuyo período venció. Devuelve los leídos.
+    // Los sensores con lectura en dos fases (Modbus, OneWire) se devuelven
+    // en la pasada en que llega su resultado, sin bloquear mientras tanto, y
+    // solo si la lectura fue válida.
+    const std::vector<ISensor*>& readDue(uint32_t now) {
+        dueSensors.clear();
+
+        // Lecturas en dos fases que ya completaron
+        for (size_t i = 0; i < sensors.size(); i++) {
+            if (schedules[i].pending && !sensors[i]->readPending()) {
+                schedules[i].pending = false;
+                // Sin respuesta (timeout o backoff): no se publican valores inválidos
+                if (sensors[i]->read()) {
+                    dueSensors.push_back(sensors[i]);
+                }
+            }
+        }
+
+        size_t firstSync = dueSensors.size();
+        for (size_t i = 0; i < sensors.size(); i++) {
+            if (!sensors[i]->isActive() || schedules[i].pending || !isDue(i, now)) continue;
+            schedules[i].lastReadMs = now;
+            schedules[i].neverRead = false;
+
+            if (sensors[i]->requestRead()) {
+                schedules[i].pending = true;
+                continue;
+            }
+            dueSensors.push_back(sensors[i]);
+        }
+
+        for (size_t k = firstSync; k < dueSensors.size(); k++) {
+            if (dueSensors[k]->dataReady()) {
+                dueSensors[k]->read();
+            }
         }
+        return dueSensors;
+    }
 
-        // Small delay for OneWire conversion
-        if (!dallasInstances.empty()) {
-            delay(100);
+    // Con ventana de reporte la lectura se suma a la estadística del sensor en
+    // vez de publicarse. Devuelve false si el sensor publica cada lectura.
+    bool accumulate(ISensor* sensor, const MeasurementSet& measurements, uint32_t now) {
+        if (!reportWindows) return false;
+        for (size_t i = 0; i < sensors.size(); i++) {
+            if (sensors[i] != sensor) continue;
+            MeasurementWindow* w = schedules[i].window;
+            if (!w) return false;
+            if (w->getSamples() == 0) schedules[i].windowStartMs = now;
+            w->add(measurements);
+            return true;
         }
+        return false;
+    }
 
-        // Read all sensors
-        for (auto* s : sensors) {
-            if (s->isActive() && s->dataReady()) {
-                s->read();
+    // Publica las ventanas vencidas: media, mínimo, máximo y desvío de cada
+    // campo, en tantos MeasurementSet como hagan falta
+    void closeWindows(uint32_t now, void (*publish)(ISensor*, const MeasurementSet&)) {
+        MeasurementSet stats;
+        for (size_t i = 0; i < sensors.size(); i++) {
+            MeasurementWindow* w = schedules[i].window;
+            if (!w || w->getSamples() == 0 || now - schedules[i].windowStartMs < schedules[i].reportMs) continue;
+
+            Serial.printf("[%s] Ventana de %lu s: %lu lecturas\n", sensors[i]->getSensorID(),
+                          (unsigned long)(schedules[i].reportMs / 1000), (unsigned long)w->getSamples());
+            uint8_t next = 0;
+            stats.clear();
+            while (w->format(next, stats) > 0) {
+                publish(sensors[i], stats);
+                stats.clear();
             }
+            w->reset();
+        }
+    }
+
+    // Deja en measurements solo lo que hay que publicar según la banda muerta
+    // del sensor (todo si no tiene "deadband"). false si no quedó nada.
+    bool applyDeadband(ISensor* sensor, MeasurementSet& measurements, uint32_t now) {
+        for (size_t i = 0; i < sensors.size(); i++) {
+            if (sensors[i] != sensor) continue;
+            DeadbandFilter* f = schedules[i].deadband;
+            if (!f) break;
+            MeasurementSet in = measurements;
+            measurements.clear();
+            return f->filter(in, now, measurements) > 0;
+        }
+        return measurements.publishable() > 0;
+    }
+
+    // Deep sleep: las referencias de las bandas muertas pasan de un despertar
+    // al siguiente por memoria RTC (mismo orden de sensores, misma config)
+    void saveDeadbands(DeadbandMemory& mem) const {
+        if (schedules.empty()) return;  // Despertar sin config (SPIFFS): conservar lo guardado
+        mem.clear();
+        for (size_t i = 0; i < schedules.size(); i++) {
+            if (schedules[i].deadband) schedules[i].deadband->save(i, mem);
         }
     }
 
+    void restoreDeadbands(const DeadbandMemory& mem) {
+        for (size_t i = 0; i < schedules.size(); i++) {
+            if (schedules[i].deadband) schedules[i].deadband->restore(i, mem);
+        }
+    }
+
+    // Un despertar de deep sleep es una sola lectura: publicar sin ventana
+    void setReportWindows(bool enabled) {
+        reportWindows = enabled;
+    }
+
+    // Hay lecturas en dos fases esperando su resultado
+    bool hasPendingReads() const {
+        for (const SensorSchedule& s : schedules) {
+            if (s.pending) return true;
+        }
+        return false;
+    }
+
+    uint32_t getSensorPeriod(size_t index) const {
+        return index < schedules.size() ? schedules[index].periodMs : 0;
+    }
+
     std::vector<ISensor*>& getSensors() {
         return sensors;
     }
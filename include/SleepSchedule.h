@@ -0,0 +1,145 @@
+#ifndef SLEEP_SCHEDULE_H
+#define SLEEP_SCHEDULE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define SLEEP_SCHEDULE_MAGIC     0x534C5031UL   // "SLP1": RTC con estado válido
+#define SLEEP_SETUP_WINDOW_MS    300000         // Tras un arranque en frío: portal y web antes de dormir
+#define SLEEP_MIN_MS             1000
+#define SLEEP_DEFAULT_PERIOD_MS  30000          // send_interval_ms por defecto
+#define SLEEP_REDISCOVER_AFTER   3              // Envíos sin ACK seguidos antes de buscar gateway otra vez
+#define SLEEP_MAX_BACKOFF        8              // Sin gateway el sueño se alarga hasta 8 períodos
+#define SLEEP_PENDING_READ_MS    2000           // Espera máxima de las lecturas en dos fases al despertar
+
+#define MESH_ANNOUNCED_SENSORS   16
+#define ESPNOW_RESUME_MAGIC      0x454E5231UL   // "ENR1"
+
+// Nombre de sensor anunciado en las tramas que envía este nodo (ESPNowManager)
+struct MeshAnnouncedSensor {
+    uint16_t hash;
+    bool used;
+    uint32_t frame;      // framesSent de la última trama que incluyó el nombre
+};
+
+/**
+ * Estado de la malla de un sensor que se conserva en RTC durante el deep
+ * sleep: emparejamiento, secuencia de datos y nombres anunciados, para que
+ * un despertar envíe enseguida (ESPNowManager::saveResumeState/restoreResumeState).
+ */
+struct EspNowResumeState {
+    uint32_t magic;
+    uint8_t peerMAC[6];    // Gateway (o relay) emparejado
+    uint8_t channel;
+    bool paired;
+    uint32_t sequence;     // Próxima secuencia: el gateway no ve reinicio ni duplicados
+    uint32_t framesSent;
+    MeshAnnouncedSensor announced[MESH_ANNOUNCED_SENSORS];
+};
+
+/**
+ * Ciclo de trabajo de un sensor a batería: despierta, mide, envía y
+ * vuelve a deep sleep.
+ *
+ * Vive en memoria RTC (RTC_DATA_ATTR), que se conserva durante el deep
+ * sleep y se pierde al cortar la alimentación o resetear; por eso es un
+ * agregado sin constructor y begin() marca el estado como válido.
+ *
+ * El sueño descuenta el tiempo despierto para que las mediciones salgan
+ * cada periodMs. Si el peer emparejado deja de confirmar, a partir de
+ * SLEEP_REDISCOVER_AFTER fallos seguidos se vuelve a buscar gateway y el
+ * sueño se duplica por cada fallo (hasta SLEEP_MAX_BACKOFF períodos) para
+ * no gastar la batería buscando un gateway caído.
+ */
+struct SleepSchedule {
+    uint32_t magic;
+    uint32_t wakes;
+    uint32_t acked;              // Despertares cuya trama confirmó el peer
+    uint32_t failed;
+    uint8_t failStreak;          // Fallos seguidos
+    uint32_t lastBootToSendMs;   // Del arranque al ACK del último envío
+    uint32_t maxBootToSendMs;
+    uint64_t totalBootToSendMs;
+    uint32_t lastAwakeMs;        // Tiempo despierto del despertar anterior
+    uint32_t elapsedMs;          // Despierto + dormido desde begin(), hasta el despertar actual
+    uint32_t lastPeriodMs;       // Último send_interval_ms leído de la config
+    bool meshLoaded;             // La malla de este despertar tiene el estado de RTC (o es un arranque en frío)
+
+    void begin() {
+        memset(this, 0, sizeof(*this));
+        magic = SLEEP_SCHEDULE_MAGIC;
+        meshLoaded = true;   // La malla del arranque en frío ya está inicializada
+    }
+
+    bool isValid() const { return magic == SLEEP_SCHEDULE_MAGIC; }
+
+    void onWake() {
+        wakes++;
+        meshLoaded = false;
+    }
+
+    // Después de restoreResumeState(): desde acá el estado de la malla se puede volver a guardar
+    void onMeshRestored() { meshLoaded = true; }
+
+    /**
+     * Guarda el estado de la malla antes de dormir, solo si este despertar lo
+     * restauró. Un despertar que se corta antes (SPIFFS, init de ESP-NOW)
+     * tiene la malla con los valores del constructor (sin peer, canal 1,
+     * secuencia 0): guardarlos dejaría al nodo en el canal 1 para siempre.
+     */
+    template <typename Mesh>
+    bool saveMesh(const Mesh& mesh, EspNowResumeState& state) const {
+        if (!meshLoaded) return false;
+        mesh.saveResumeState(state);
+        return true;
+    }
+
+    void onSend(bool ack, uint32_t bootToSendMs) {
+        if (!ack) {
+            failed++;
+            if (failStreak < 0xFF) failStreak++;
+            return;
+        }
+        acked++;
+        failStreak = 0;
+        lastBootToSendMs = bootToSendMs;
+        if (bootToSendMs > maxBootToSendMs) maxBootToSendMs = bootToSendMs;
+        totalBootToSendMs += bootToSendMs;
+    }
+
+    bool needsDiscovery() const { return failStreak >= SLEEP_REDISCOVER_AFTER; }
+
+    /**
+     * Duración del próximo sueño para despertar periodMs después del
+     * despertar actual. periodMs 0 (despertar sin config, ej: SPIFFS no
+     * montó): el último período leído o SLEEP_DEFAULT_PERIOD_MS, no
+     * SLEEP_MIN_MS, para no despertar cada segundo hasta que vuelva.
+     */
+    uint32_t sleepMs(uint32_t periodMs, uint32_t awakeMs) const {
+        if (periodMs == 0) periodMs = lastPeriodMs ? lastPeriodMs : SLEEP_DEFAULT_PERIOD_MS;
+        uint32_t backoff = 1;
+        if (failStreak > SLEEP_REDISCOVER_AFTER) {
+            uint8_t doublings = failStreak - SLEEP_REDISCOVER_AFTER;
+            backoff = doublings >= 8 ? SLEEP_MAX_BACKOFF : (1u << doublings);
+            if (backoff > SLEEP_MAX_BACKOFF) backoff = SLEEP_MAX_BACKOFF;
+        }
+        uint64_t target = (uint64_t)periodMs * backoff;
+        if (target > 0xFFFFFFFFULL) target = 0xFFFFFFFFULL;
+        if (target < (uint64_t)awakeMs + SLEEP_MIN_MS) return SLEEP_MIN_MS;
+        return (uint32_t)(target - awakeMs);
+    }
+
+    void onSleep(uint32_t awakeMs, uint32_t sleepMs) {
+        lastAwakeMs = awakeMs;
+        elapsedMs += awakeMs + sleepMs;
+    }
+
+    // Reloj que sigue corriendo durante el deep sleep (millis() vuelve a 0 en cada despertar)
+    uint32_t clockMs(uint32_t millisNow) const { return elapsedMs + millisNow; }
+
+    uint32_t avgBootToSendMs() const {
+        return acked ? (uint32_t)(totalBootToSendMs / acked) : 0;
+    }
+};
+
+#endif // SLEEP_SCHEDULE_H
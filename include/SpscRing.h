@@ -0,0 +1,98 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+/**
+ * Cola circular sin locks para un solo productor y un solo consumidor.
+ *
+ * El productor solo escribe head y el consumidor solo escribe tail; los
+ * índices crecen sin límite y se enmascaran con N - 1 (N potencia de 2),
+ * así que lleno/vacío se distinguen sin perder un slot. push() y pop() son
+ * una copia y un store con release: se pueden llamar desde el callback de
+ * recepción de la WiFi sin tomar mutex ni tocar el heap.
+ */
+template <typename T, size_t N>
+class SpscRing {
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "SpscRing: N debe ser potencia de 2");
+
+public:
+    SpscRing() : head(0), tail(0), highWater(0), dropped(0) {}
+
+    // Productor. Si está llena descarta el elemento y devuelve false.
+    bool push(const T& item) {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t used = h - tail.load(std::memory_order_acquire);
+        if (used >= N) {
+            dropped++;
+            return false;
+        }
+        slots[h & (N - 1)] = item;
+        head.store(h + 1, std::memory_order_release);
+        if (used + 1 > highWater) highWater = used + 1;
+        return true;
+    }
+
+    // Productor: reserva el próximo slot para escribirlo en el lugar (evita una copia).
+    // Devuelve nullptr si está llena; publicar con commit().
+    T* reserve() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h - tail.load(std::memory_order_acquire) >= N) {
+            dropped++;
+            return nullptr;
+        }
+        return &slots[h & (N - 1)];
+    }
+
+    void commit() {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        uint32_t used = h + 1 - tail.load(std::memory_order_acquire);
+        head.store(h + 1, std::memory_order_release);
+        if (used > highWater) highWater = used;
+    }
+
+    // Consumidor
+    bool pop(T& out) {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return false;
+        out = slots[t & (N - 1)];
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumidor: acceso al elemento más viejo sin copiarlo; liberar con release()
+    T* front() {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t == head.load(std::memory_order_acquire)) return nullptr;
+        return &slots[t & (N - 1)];
+    }
+
+    void release() {
+        tail.store(tail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool empty() const {
+        return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return N; }
+    uint32_t getHighWater() const { return highWater; }
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    T slots[N];
+    std::atomic<uint32_t> head;   // Próximo slot a escribir (productor)
+    std::atomic<uint32_t> tail;   // Próximo slot a leer (consumidor)
+
+    // Escritos solo por el productor
+    volatile uint32_t highWater;
+    volatile uint32_t dropped;
+};
+
+#endif // SPSC_RING_H
@@ -0,0 +1,146 @@
+#ifndef STREAMING_STATS_H
+#define STREAMING_STATS_H
+
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+#include "Measurement.h"
+
+#define STATS_PER_FIELD  4    // _mean, _min, _max, _std
+
+/**
+ * Estadística en línea de una magnitud: cantidad, media, mínimo, máximo y
+ * desvío estándar en memoria constante.
+ *
+ * Usa el algoritmo de Welford (media y suma de cuadrados de las
+ * desviaciones actualizadas muestra a muestra), que no pierde precisión
+ * como la fórmula ingenua sum(x²) - n·media² cuando el desvío es chico
+ * frente al valor (ej: 21.50 ± 0.02 °C).
+ */
+struct StreamingStats {
+    uint32_t count;
+    double mean;
+    double m2;      // Suma de cuadrados de las desviaciones a la media
+    float min;
+    float max;
+
+    StreamingStats() { reset(); }
+
+    void reset() {
+        count = 0;
+        mean = 0;
+        m2 = 0;
+        min = 0;
+        max = 0;
+    }
+
+    void add(float x) {
+        count++;
+        double delta = x - mean;
+        mean += delta / count;
+        m2 += delta * (x - mean);
+        if (count == 1 || x < min) min = x;
+        if (count == 1 || x > max) max = x;
+    }
+
+    // Desvío estándar poblacional de la ventana (0 con menos de 2 muestras)
+    double stddev() const {
+        return count > 1 ? sqrt(m2 / count) : 0;
+    }
+};
+
+/**
+ * Ventana de reporte de un sensor: un StreamingStats por campo de sus
+ * mediciones (MeasurementSet).
+ *
+ * Cada lectura se suma con add(); al cerrar la ventana format() arma las
+ * mediciones temp_mean, temp_min, temp_max y temp_std con los decimales
+ * que usa el sensor. Como todas no entran en un MeasurementSet, format()
+ * agrega los campos que entran completos y deja el índice del siguiente
+ * para la próxima llamada.
+ */
+class MeasurementWindow {
+public:
+    MeasurementWindow() : samples(0), lastMs(0) {}
+
+    // Suma una lectura; las mediciones inválidas no entran en la estadística
+    void add(const MeasurementSet& measurements) {
+        for (const Measurement& m : measurements) {
+            if (m.quality == MEAS_INVALID || isnan(m.value) || isinf(m.value)) continue;
+            bool added;
+            FieldTable::Entry* e = fields.findOrAdd(m, added);
+            if (e) {
+                if (added) nameStats(*e);
+                e->state.stats.add(m.value);
+                if (m.decimals > e->state.decimals) e->state.decimals = m.decimals > 4 ? 4 : m.decimals;
+            }
+            lastMs = m.timestampMs;
+        }
+        samples++;
+    }
+
+    uint32_t getSamples() const { return samples; }
+    uint8_t getFieldCount() const { return fields.size(); }
+
+    const StreamingStats* getStats(const char* name) const {
+        const FieldTable::Entry* e = fields.find(name);
+        return e ? &e->state.stats : nullptr;
+    }
+
+    /**
+     * Agrega a out las estadísticas de cada campo (temp_mean, temp_min,
+     * temp_max, temp_std, con nombre propio) desde el campo next, tantos
+     * campos como entren enteros en out. Avanza next y devuelve la cantidad
+     * de campos agregados (0 cuando ya no quedan).
+     */
+    uint8_t format(uint8_t& next, MeasurementSet& out) const {
+        uint8_t written = 0;
+        while (next < fields.size()) {
+            const Field& f = fields[next].state;
+            if (f.stats.count == 0) {
+                next++;
+                continue;
+            }
+            if (out.size() + STATS_PER_FIELD > MEASUREMENT_MAX) break;
+            const float values[STATS_PER_FIELD] = {(float)f.stats.mean, f.stats.min, f.stats.max,
+                                                   (float)f.stats.stddev()};
+            for (int k = 0; k < STATS_PER_FIELD; k++) {
+                out.push({MEAS_NAMED, f.decimals, MEAS_OK, f.statNames[k], values[k], lastMs});
+            }
+            written++;
+            next++;
+        }
+        return written;
+    }
+
+    void reset() {
+        for (uint8_t i = 0; i < fields.size(); i++) fields[i].state.stats.reset();
+        samples = 0;
+    }
+
+private:
+    struct Field {
+        char statNames[STATS_PER_FIELD][MEASUREMENT_FIELD_NAME_MAX + 6];   // "temp_mean", ...
+        uint8_t decimals;
+        StreamingStats stats;
+
+        Field() : decimals(0) {}
+    };
+    typedef MeasurementTable<Field> FieldTable;
+
+    // Los campos se conservan entre ventanas: un sensor siempre reporta los mismos
+    FieldTable fields;
+    uint32_t samples;
+    uint32_t lastMs;        // Momento de la última lectura sumada
+
+    static void nameStats(FieldTable::Entry& e) {
+        static const char* const SUFFIX[STATS_PER_FIELD] = {"_mean", "_min", "_max", "_std"};
+        size_t nameLen = strlen(e.name);
+        for (int k = 0; k < STATS_PER_FIELD; k++) {
+            memcpy(e.state.statNames[k], e.name, nameLen);
+            strcpy(e.state.statNames[k] + nameLen, SUFFIX[k]);
+        }
+    }
+};
+
+#endif // STREAMING_STATS_H
@@ -0,0 +1,175 @@
+#ifndef TASK_SCHEDULER_H
+#define TASK_SCHEDULER_H
+
+#include <stdint.h>
+#include <string.h>
+
+#ifdef ARDUINO
+  #include <Arduino.h>
+#endif
+
+/**
+ * Planificador cooperativo de tareas periódicas.
+ *
+ * Cada tarea tiene un período, un deadline (tiempo máximo de ejecución
+ * esperado) y contabilidad de tiempo de ejecución. En cada pasada de run():
+ *   1. Se ejecutan todas las tareas de período 0 (servidor web, WiFi...)
+ *   2. Se ejecuta como máximo UNA tarea periódica vencida: la más atrasada
+ *      (earliest deadline first)
+ * Así una tarea lenta (p.ej. un timeout Modbus) nunca retrasa más de una
+ * pasada a las tareas de período 0.
+ *
+ * El reloj es inyectable para poder testear sin hardware.
+ */
+class TaskScheduler {
+public:
+  typedef void (*TaskCallback)();
+  typedef uint32_t (*ClockFn)();
+
+  static const int MAX_TASKS = 16;
+
+  struct Task {
+    const char* name;
+    TaskCallback callback;
+    uint32_t periodMs;      // 0 = ejecutar en cada pasada
+    uint32_t deadlineUs;    // 0 = sin deadline
+    uint32_t nextRunMs;
+    bool enabled;
+
+    // Contabilidad
+    uint32_t runs;
+    uint32_t overruns;      // Ejecuciones que superaron el deadline
+    uint32_t skipped;       // Períodos perdidos por atraso
+    uint32_t lastRunUs;
+    uint32_t maxRunUs;
+    uint64_t totalRunUs;
+    uint32_t maxLatenessMs; // Máximo atraso respecto al momento planificado
+  };
+
+#ifdef ARDUINO
+  static uint32_t defaultMillis() { return millis(); }
+  static uint32_t defaultMicros() { return micros(); }
+  TaskScheduler(ClockFn msClock = defaultMillis, ClockFn usClock = defaultMicros)
+#else
+  TaskScheduler(ClockFn msClock, ClockFn usClock)
+#endif
+    : nowMs(msClock), nowUs(usClock), taskCount(0) {
+    memset(tasks, 0, sizeof(tasks));
+  }
+
+  // Registra una tarea. Devuelve su id o -1 si no hay lugar.
+  // initialDelayMs: espera antes de la primera ejecución
+  int addTask(const char* name, TaskCallback callback, uint32_t periodMs,
+              uint32_t deadlineUs = 0, uint32_t initialDelayMs = 0) {
+    if (taskCount >= MAX_TASKS || callback == nullptr) return -1;
+
+    Task& t = tasks[taskCount];
+    memset(&t, 0, sizeof(Task));
+    t.name = name;
+    t.callback = callback;
+    t.periodMs = periodMs;
+    t.deadlineUs = deadlineUs;
+    t.nextRunMs = nowMs() + initialDelayMs;
+    t.enabled = true;
+    return taskCount++;
+  }
+
+  void setPeriod(int id, uint32_t periodMs) {
+    if (!valid(id)) return;
+    tasks[id].periodMs = periodMs;
+    tasks[id].nextRunMs = nowMs() + periodMs;
+  }
+
+  void setEnabled(int id, bool enabled) {
+    if (valid(id)) tasks[id].enabled = enabled;
+  }
+
+  // Fuerza la ejecución de la tarea en la próxima pasada
+  void trigger(int id) {
+    if (valid(id)) tasks[id].nextRunMs = nowMs();
+  }
+
+  // Una pasada del planificador. Devuelve cuántas tareas se ejecutaron.
+  int run() {
+    int executed = 0;
+
+    // 1. Tareas continuas (período 0)
+    for (int i = 0; i < taskCount; i++) {
+      if (tasks[i].enabled && tasks[i].periodMs == 0) {
+        execute(tasks[i], 0);
+        executed++;
+      }
+    }
+
+    // 2. La tarea periódica vencida más atrasada
+    uint32_t now = nowMs();
+    int best = -1;
+    int32_t bestLateness = -1;
+    for (int i = 0; i < taskCount; i++) {
+      Task& t = tasks[i];
+      if (!t.enabled || t.periodMs == 0) continue;
+      int32_t lateness = (int32_t)(now - t.nextRunMs);
+      if (lateness >= 0 && lateness > bestLateness) {
+        best = i;
+        bestLateness = lateness;
+      }
+    }
+
+    if (best >= 0) {
+      Task& t = tasks[best];
+      execute(t, (uint32_t)bestLateness);
+
+      // Planificar la próxima ejecución sin acumular deriva;
+      // si estamos atrasados más de un período, saltar los perdidos
+      t.nextRunMs += t.periodMs;
+      uint32_t after = nowMs();
+      if ((int32_t)(after - t.nextRunMs) >= 0) {
+        t.skipped += (after - t.nextRunMs) / t.periodMs + 1;
+        t.nextRunMs = after + t.periodMs;
+      }
+      executed++;
+    }
+
+    return executed;
+  }
+
+  // Milisegundos hasta la próxima tarea periódica (0 si hay alguna vencida)
+  uint32_t msUntilNext() const {
+    uint32_t now = nowMs();
+    uint32_t wait = UINT32_MAX;
+    for (int i = 0; i < taskCount; i++) {
+      const Task& t = tasks[i];
+      if (!t.enabled || t.periodMs == 0) continue;
+      int32_t remaining = (int32_t)(t.nextRunMs - now);
+      if (remaining <= 0) return 0;
+      if ((uint32_t)remaining < wait) wait = remaining;
+    }
+    return wait;
+  }
+
+  int getTaskCount() const { return taskCount; }
+  const Task& getTask(int id) const { return tasks[id]; }
+
+private:
+  ClockFn nowMs;
+  ClockFn nowUs;
+  Task tasks[MAX_TASKS];
+  int taskCount;
+
+  bool valid(int id) const { return id >= 0 && id < taskCount; }
+
+  void execute(Task& t, uint32_t latenessMs) {
+    uint32_t start = nowUs();
+    t.callback();
+    uint32_t elapsed = nowUs() - start;
+
+    t.runs++;
+    t.lastRunUs = elapsed;
+    t.totalRunUs += elapsed;
+    if (elapsed > t.maxRunUs) t.maxRunUs = elapsed;
+    if (t.deadlineUs > 0 && elapsed > t.deadlineUs) t.overruns++;
+    if (latenessMs > t.maxLatenessMs) t.maxLatenessMs = latenessMs;
+  }
+};
+
+#endif // TASK_SCHEDULER_H
@@ -0,0 +1,123 @@
+#ifndef TRICKLE_TIMER_H
+#define TRICKLE_TIMER_H
+
+#include <stdint.h>
+
+#define TRICKLE_DEFAULT_IMIN_MS  2000
+#define TRICKLE_DEFAULT_IMAX_MS  64000
+#define TRICKLE_DEFAULT_K        3
+
+struct TrickleStats {
+    uint32_t sent;
+    uint32_t suppressed;   // Beacons no enviados porque k vecinos ya dijeron lo mismo
+    uint32_t resets;       // Vueltas a Imin por un cambio de topología
+};
+
+/**
+ * Temporizador Trickle (RFC 6206) para los beacons de la malla.
+ *
+ * El intervalo I arranca en Imin y se duplica al terminar cada intervalo
+ * hasta Imax mientras nada cambia. Dentro de cada intervalo el beacon se
+ * programa en un instante al azar de [I/2, I) y se omite si ya se
+ * escucharon k beacons consistentes en ese intervalo (k = 0 nunca omite).
+ * Una inconsistencia (cambio de padre, vecino nuevo o sin ruta) vuelve a
+ * Imin para que la novedad se propague rápido.
+ *
+ * Con la malla estable cada nodo pasa de un beacon cada 2 s a uno cada
+ * 64 s, y en zonas densas solo transmiten k por vecindario.
+ */
+class TrickleTimer {
+public:
+    TrickleTimer() { begin(TRICKLE_DEFAULT_IMIN_MS, TRICKLE_DEFAULT_IMAX_MS, TRICKLE_DEFAULT_K, 1); }
+
+    // seed: distinto por nodo (p. ej. la MAC) para que los vecinos no transmitan juntos
+    void begin(uint32_t iminMs, uint32_t imaxMs, uint8_t redundancy, uint32_t seed) {
+        imin = iminMs ? iminMs : 1;
+        imax = imaxMs < imin ? imin : imaxMs;
+        k = redundancy;
+        rng = seed ? seed : 1;
+        interval = imin;
+        heard = 0;
+        fired = false;
+        started = false;
+        suppressionAllowed = true;
+        stats = TrickleStats();
+    }
+
+    // Beacon escuchado que no aporta nada nuevo
+    void hearConsistent() {
+        if (heard < 0xFF) heard++;
+    }
+
+    // Algo cambió: beacons rápidos otra vez (si ya está en Imin no hace nada)
+    void reset(uint32_t now) {
+        if (started && interval == imin) return;
+        if (started) stats.resets++;
+        interval = imin;
+        startInterval(now);
+    }
+
+    // false: transmitir siempre en el instante elegido (gateway, nodos que reenvían)
+    void setSuppression(bool allowed) { suppressionAllowed = allowed; }
+
+    // Devuelve true cuando hay que transmitir el beacon
+    bool poll(uint32_t now) {
+        if (!started) startInterval(now);
+
+        bool transmit = false;
+        if (!fired && now - intervalStart >= fireAt) {
+            fired = true;
+            if (k == 0 || !suppressionAllowed || heard < k) {
+                transmit = true;
+                stats.sent++;
+            } else {
+                stats.suppressed++;
+            }
+        }
+
+        if (now - intervalStart >= interval) {
+            interval = (interval > imax / 2) ? imax : interval * 2;
+            startInterval(now);
+        }
+        return transmit;
+    }
+
+    uint32_t getInterval() const { return interval; }
+    uint32_t getImin() const { return imin; }
+    uint32_t getImax() const { return imax; }
+    uint8_t getRedundancy() const { return k; }
+    const TrickleStats& getStats() const { return stats; }
+
+private:
+    uint32_t imin;
+    uint32_t imax;
+    uint8_t k;
+    uint32_t interval;
+    uint32_t intervalStart;
+    uint32_t fireAt;         // Desde intervalStart
+    uint8_t heard;           // Beacons consistentes en este intervalo
+    bool fired;
+    bool started;
+    bool suppressionAllowed;
+    uint32_t rng;
+    TrickleStats stats;
+
+    void startInterval(uint32_t now) {
+        started = true;
+        intervalStart = now;
+        heard = 0;
+        fired = false;
+        uint32_t half = interval / 2;
+        fireAt = half + (half ? nextRandom() % (interval - half) : 0);
+    }
+
+    // xorshift32
+    uint32_t nextRandom() {
+        rng ^= rng << 13;
+        rng ^= rng >> 17;
+        rng ^= rng << 5;
+        return rng;
+    }
+};
+
+#endif // TRICKLE_TIMER_H
@@ -6,6 +6,9 @@ extern const char* YOUR_GITHUB_USERNAME;
 extern const char* YOUR_REPO_NAME;
 extern const unsigned long UPDATE_INTERVAL;
 extern const char* CONFIG_FILE_PATH;
+extern const unsigned long DEFAULT_UPLOAD_INTERVAL_MS;  // Envío a Grafana
+extern const unsigned long DEFAULT_SENSOR_PERIOD_MS;    // Lectura de cada sensor
+extern const unsigned long SENSOR_POLL_INTERVAL_MS;     // Revisión de sensores vencidos
 
 // Constantes privadas (definidas en constants_private.h)
 extern const char* URL;
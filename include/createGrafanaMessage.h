@@ -2,8 +2,19 @@
 #define CREATE_GRAFANA_MESSAGE_H
 
 #include <Arduino.h>
+#include "lineProtocol.h"
 
+#define GRAFANA_MEASUREMENT    "medicionesCO2"
+#define GRAFANA_LINE_MAX_BYTES 256
+
+// Codifican una línea en el buffer del writer, sin usar el heap.
+// Devuelven false si la línea no entró (el buffer queda como estaba) o no tiene campos.
+bool appendGrafanaLine(LineProtocolWriter& writer, const char* fields, const char* sensorId, const char* deviceId, unsigned long long timestamp);
+bool appendGrafanaLine(LineProtocolWriter& writer, float temperature, float humidity, float co2, const char* sensorId, const char* deviceId, unsigned long long timestamp);
+
+// Versiones que devuelven un String (una sola reserva por línea)
 String create_grafana_message(float temperature, float humidity, float co2, const char* sensorId= "Unknown", const char* deviceId = "Unknown");
 String create_grafana_message(const char* message, const char* sensorId= "Unknown", const char* deviceId  = "Unknown");
+String create_grafana_message(const char* message, const char* sensorId, const char* deviceId, unsigned long long timestamp);
 
 #endif // CREATE_GRAFANA_MESSAGE_H
\ No newline at end of file
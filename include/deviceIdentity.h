@@ -0,0 +1,44 @@
+#ifndef DEVICE_IDENTITY_H
+#define DEVICE_IDENTITY_H
+
+#include <Arduino.h>
+
+/**
+ * Identidad del dispositivo, calculada una sola vez al arrancar.
+ *
+ * Lee las MAC de estación y SoftAP desde eFuse (esp_read_mac, no requiere
+ * WiFi iniciado) y guarda sus formas binaria, hex y "AA:BB:..", junto con el
+ * nombre "moni-XXXXXXXXXXXX". Encoders, beacons y endpoints usan estos
+ * valores sin formatear ni parsear nada en el camino caliente.
+ */
+class DeviceIdentity {
+public:
+  DeviceIdentity();
+
+  // Llamar al principio de setup(). Idempotente.
+  void begin();
+
+  const uint8_t* staMac() const { return sta; }
+  const uint8_t* apMac() const { return ap; }
+  const char* staMacString() const { return staStr; }  // "80:F3:DA:AD:12:34"
+  const char* apMacString() const { return apStr; }
+  const char* macHex() const { return hex; }           // "80F3DAAD1234"
+  const char* name() const { return deviceName; }      // "moni-80F3DAAD1234"
+  uint8_t shortId() const { return sta[5]; }           // Último byte, para los beacons
+
+private:
+  bool initialized;
+  uint8_t sta[6];
+  uint8_t ap[6];
+  char staStr[18];
+  char apStr[18];
+  char hex[13];
+  char deviceName[18];
+};
+
+// "moni-" + 12 dígitos hex de la MAC (nodos de la malla). out debe tener 18 bytes.
+void formatDeviceName(char* out, const uint8_t mac[6]);
+
+extern DeviceIdentity deviceIdentity;
+
+#endif // DEVICE_IDENTITY_H
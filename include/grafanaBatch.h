@@ -0,0 +1,43 @@
+#ifndef GRAFANA_BATCH_H
+#define GRAFANA_BATCH_H
+
+#include <Arduino.h>
+#include "lineProtocol.h"
+
+// Tamaño máximo del cuerpo antes de forzar un envío anticipado
+#define GRAFANA_BATCH_MAX_BYTES 4096
+
+/**
+ * Acumula varias líneas de InfluxDB line protocol (una por sensor y por
+ * dato de la malla) y las envía juntas en un único POST por ciclo.
+ *
+ * Las líneas se codifican directamente en un buffer fijo con
+ * LineProtocolWriter: armar el lote no reserva memoria en el heap.
+ */
+class GrafanaBatch {
+public:
+  GrafanaBatch();
+
+  // Agrega una línea con campos ya formateados (field1=v1,field2=v2)
+  void add(const char* message, const char* sensorId = "Unknown", const char* deviceId = "Unknown");
+  // Igual, con el timestamp (ns) del momento de la muestra
+  void add(const char* message, const char* sensorId, const char* deviceId, unsigned long long timestamp);
+  // Agrega una línea con temperatura/humedad/CO2
+  void add(float temperature, float humidity, float co2, const char* sensorId = "Unknown", const char* deviceId = "Unknown");
+
+  size_t count() const { return writer.lineCount(); }
+  bool isEmpty() const { return writer.lineCount() == 0; }
+
+  // Envía todas las líneas acumuladas en un solo POST y vacía el lote
+  bool flush();
+
+private:
+  char body[GRAFANA_BATCH_MAX_BYTES];
+  LineProtocolWriter writer;
+
+  // Si la línea no entra, envía lo acumulado y reintenta
+  void append(const char* fields, float temperature, float humidity, float co2,
+              const char* sensorId, const char* deviceId, unsigned long long timestamp);
+};
+
+#endif // GRAFANA_BATCH_H
@@ -0,0 +1,227 @@
+#ifndef LINE_PROTOCOL_H
+#define LINE_PROTOCOL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#define UPLINK_FIELDS_LEN 84   // Campos de una línea encolada (UplinkRecord::fields)
+
+// Entero escalado en punto fijo sin printf: (2530, 2) → "25.30". Devuelve
+// los caracteres escritos (sin el '\0') o 0 si no entran en cap.
+inline size_t formatScaled(char* out, size_t cap, int64_t scaled, uint8_t decimals) {
+    if (decimals > 18) return 0;
+    char digits[24];
+    int n = 0;
+    uint64_t v = scaled < 0 ? (uint64_t)(-(scaled + 1)) + 1 : (uint64_t)scaled;
+    do {
+        digits[n++] = '0' + v % 10;
+        v /= 10;
+    } while (v || n <= decimals);
+
+    size_t len = (scaled < 0 ? 1 : 0) + n + (decimals ? 1 : 0);
+    if (len + 1 > cap) return 0;
+
+    size_t pos = 0;
+    if (scaled < 0) out[pos++] = '-';
+    for (int i = n - 1; i >= 0; i--) {
+        out[pos++] = digits[i];
+        if (i == decimals && decimals) out[pos++] = '.';
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+// Valor redondeado a decimals (máximo 6): (-12.745, 2) → "-12.75", sin "-0.00"
+inline size_t formatFixed(char* out, size_t cap, double value, uint8_t decimals) {
+    static const uint32_t POW10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+    if (decimals > 6) decimals = 6;
+
+    bool negative = value < 0;
+    double scaled = (negative ? -value : value) * POW10[decimals] + 0.5;
+    if (scaled >= 9.2e18) {          // Fuera de rango de int64: entero sin decimales
+        scaled = 9.2e18;
+        decimals = 0;
+    }
+    int64_t s = (int64_t)scaled;
+    return formatScaled(out, cap, negative ? -s : s, decimals);
+}
+
+// Un carácter de medición, tag o clave escapado en out (1 o 2 caracteres):
+// '\' antes de ',' y ' ' (y '=' en tags y claves); un salto de línea
+// partiría la línea y queda como espacio escapado
+inline size_t escapeLineProtocolChar(char c, bool escapeEquals, char out[2]) {
+    if (c == '\n') c = ' ';
+    size_t n = 0;
+    if (c == ',' || c == ' ' || (escapeEquals && c == '=')) out[n++] = '\\';
+    out[n++] = c;
+    return n;
+}
+
+// Nombre de campo que viaja sin escapar: solo [A-Za-z0-9_], 1..len caracteres
+inline bool isPlainFieldKey(const char* key, size_t len) {
+    if (len == 0) return false;
+    for (size_t i = 0; i < len; i++) {
+        char c = key[i];
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_')) return false;
+    }
+    return true;
+}
+
+/**
+ * Escritor de InfluxDB line protocol sobre un buffer fijo del llamador.
+ *
+ *   medicionesCO2,device=moni-80F3DAAD,sensor=th-mod-1 temp=25.30,hum=60.50 1700000000000000000
+ *
+ * No usa String ni printf (el printf de newlib reserva memoria al formatear
+ * floats), así que codificar una línea no toca el heap. Escapa medición,
+ * tags y claves según el protocolo. Cada línea es atómica: si no entra en
+ * el buffer, endLine() la descarta y deja el buffer como estaba, para que
+ * el llamador envíe lo acumulado y reintente.
+ */
+class LineProtocolWriter {
+public:
+    LineProtocolWriter(char* buffer, size_t capacity)
+        : buf(buffer), cap(capacity), len(0), lineStart(0), lines(0),
+          state(IDLE), overflow(false), lineOverflow(false) {
+        if (cap > 0) buf[0] = '\0';
+    }
+
+    // Empieza una línea nueva (separada con '\n' de la anterior)
+    void beginLine(const char* measurement) {
+        lineStart = len;
+        lineOverflow = false;
+        if (lines > 0) put('\n');
+        putEscaped(measurement, false);
+        state = TAGS;
+    }
+
+    // Tag con clave y valor escapados. Los valores vacíos no son válidos y se omiten.
+    void tag(const char* key, const char* value) {
+        if (state != TAGS || !value || !value[0]) return;
+        put(',');
+        putEscaped(key, true);
+        put('=');
+        putEscaped(value, true);
+    }
+
+    // Campo numérico en punto fijo (NaN/inf se omiten: el protocolo no los admite)
+    void field(const char* key, double value, uint8_t decimals = 2) {
+        if (isnan(value) || isinf(value)) return;
+        if (!beginField(key)) return;
+        putFixed(value, decimals);
+    }
+
+    // Campo entero ("42i")
+    void fieldInt(const char* key, int64_t value) {
+        if (!beginField(key)) return;
+        if (value < 0) {
+            put('-');
+            putUint((uint64_t)(-(value + 1)) + 1);
+        } else {
+            putUint((uint64_t)value);
+        }
+        put('i');
+    }
+
+    // Campos ya formateados por el sensor ("temp=25.30,hum=60.50")
+    void rawFields(const char* fields) {
+        if (!fields || !fields[0] || (state != TAGS && state != FIELDS)) return;
+        put(state == TAGS ? ' ' : ',');
+        state = FIELDS;
+        while (*fields) put(*fields++);
+    }
+
+    void timestamp(uint64_t ns) {
+        if (state != FIELDS) return;
+        put(' ');
+        putUint(ns);
+        state = DONE;
+    }
+
+    // Cierra la línea. Si no entró o no tiene campos se descarta y devuelve false.
+    bool endLine() {
+        bool valid = (state == FIELDS || state == DONE) && !lineOverflow;
+        state = IDLE;
+        if (!valid) {
+            len = lineStart;
+            if (cap > 0) buf[len] = '\0';
+            return false;
+        }
+        if (cap > 0) buf[len] = '\0';
+        lines++;
+        return true;
+    }
+
+    void clear() {
+        len = lineStart = 0;
+        lines = 0;
+        state = IDLE;
+        overflow = lineOverflow = false;
+        if (cap > 0) buf[0] = '\0';
+    }
+
+    const char* c_str() const { return buf; }
+    size_t length() const { return len; }
+    size_t lineCount() const { return lines; }
+    size_t capacity() const { return cap; }
+    // true si alguna línea se descartó por falta de espacio
+    bool overflowed() const { return overflow; }
+
+private:
+    enum State : uint8_t { IDLE, TAGS, FIELDS, DONE };
+
+    char* buf;
+    size_t cap;
+    size_t len;
+    size_t lineStart;
+    size_t lines;
+    State state;
+    bool overflow;
+    bool lineOverflow;
+
+    void put(char c) {
+        if (len + 1 >= cap) {   // Reservar lugar para el '\0'
+            overflow = lineOverflow = true;
+            return;
+        }
+        buf[len++] = c;
+    }
+
+    // Medición: escapar ',' y ' '. Tags y claves: además '='.
+    void putEscaped(const char* s, bool escapeEquals) {
+        if (!s) return;
+        for (; *s; s++) {
+            char esc[2];
+            size_t n = escapeLineProtocolChar(*s, escapeEquals, esc);
+            for (size_t i = 0; i < n; i++) put(esc[i]);
+        }
+    }
+
+    bool beginField(const char* key) {
+        if (state != TAGS && state != FIELDS) return false;
+        put(state == TAGS ? ' ' : ',');
+        state = FIELDS;
+        putEscaped(key, true);
+        put('=');
+        return true;
+    }
+
+    void putUint(uint64_t v) {
+        char digits[20];
+        int n = 0;
+        do {
+            digits[n++] = '0' + (v % 10);
+            v /= 10;
+        } while (v);
+        while (n) put(digits[--n]);
+    }
+
+    void putFixed(double v, uint8_t decimals) {
+        char text[24];
+        size_t n = formatFixed(text, sizeof(text), v, decimals);
+        for (size_t i = 0; i < n; i++) put(text[i]);
+    }
+};
+
+#endif // LINE_PROTOCOL_H
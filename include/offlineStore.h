@@ -0,0 +1,68 @@
+#ifndef OFFLINE_STORE_H
+#define OFFLINE_STORE_H
+
+#include <Arduino.h>
+
+#define OFFLINE_DIR               "/q"
+#define OFFLINE_META_PATH         "/q/meta"
+#define OFFLINE_SEGMENT_MAX_BYTES 16384   // Tamaño de cada segmento del log
+#define OFFLINE_MAX_SEGMENTS      32      // Máximo de segmentos (~512 KB)
+#define OFFLINE_MAX_FS_USAGE      0.75f   // No ocupar más del 75% de SPIFFS
+#define OFFLINE_REPLAY_CHUNK      3072    // Bytes por POST de reenvío
+#define OFFLINE_REPLAY_INTERVAL   2000    // ms mínimos entre POSTs de reenvío
+
+/**
+ * Log circular en SPIFFS para guardar líneas de InfluxDB mientras no hay
+ * conexión y reenviarlas en lotes cuando vuelve el enlace.
+ *
+ * - Solo se agrega al final (append-only): los segmentos nunca se reescriben,
+ *   se borran completos una vez reenviados. Así se minimiza el desgaste.
+ * - Si se llena, se descarta el segmento más antiguo.
+ * - Las líneas guardan su timestamp original. Si el reloj todavía no estaba
+ *   sincronizado por NTP (timestamp ≈ uptime), se corrigen al reenviar si
+ *   pertenecen al mismo arranque; las de arranques anteriores se descartan.
+ * - El progreso dentro de un segmento se guarda en RAM: tras un reinicio el
+ *   segmento se reenvía completo (InfluxDB sobrescribe puntos idénticos).
+ */
+class OfflineStore {
+public:
+  OfflineStore();
+
+  // Recupera el estado del log (llamar después de SPIFFS.begin())
+  void begin();
+
+  // Guarda un cuerpo de una o más líneas
+  bool append(const char* body, size_t length);
+  bool append(const String& body) { return append(body.c_str(), body.length()); }
+
+  // Reenvía un bloque si hay datos pendientes y pasó el intervalo mínimo.
+  // Devuelve true si se envió algo.
+  bool replay();
+
+  bool hasPending() const { return firstSegment != nextSegment; }
+  uint32_t getPendingBytes() const { return pendingBytes; }
+  uint32_t getStoredLines() const { return storedLines; }
+  uint32_t getReplayedLines() const { return replayedLines; }
+  uint32_t getDroppedSegments() const { return droppedSegments; }
+
+private:
+  uint32_t firstSegment;      // Segmento más antiguo pendiente
+  uint32_t nextSegment;       // Próximo índice a crear
+  uint32_t bootFirstSegment;  // Primer segmento escrito en este arranque
+  uint32_t readOffset;        // Progreso de reenvío dentro de firstSegment
+  uint32_t pendingBytes;
+  uint32_t lastReplay;
+
+  uint32_t storedLines;
+  uint32_t replayedLines;
+  uint32_t droppedSegments;
+
+  static void segmentPath(char* out, size_t size, uint32_t index);
+  void saveMeta();
+  void dropOldest();
+  bool fixTimestamp(String& line, bool sameBoot);
+};
+
+extern OfflineStore offlineStore;
+
+#endif // OFFLINE_STORE_H
@@ -5,5 +5,7 @@
 
 void sendDataGrafana(float temperature, float humidity, float co2, const char* sensorId= "Unknown", const char* deviceId = "Unknown");
 void sendDataGrafana(const char* message, const char* sensorId= "Unknown", const char* deviceId = "Unknown");
+int sendBatchGrafana(const String& body);  // Varias líneas en un solo POST, devuelve el código HTTP
+int sendBatchGrafana(const char* body, size_t length);
 
-#endif // SEND_DATA_GRAFANA_H
\ No newline at end of file
+#endif // SEND_DATA_GRAFANA_H
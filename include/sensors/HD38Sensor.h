@@ -3,6 +3,7 @@
 
 #include "ISensor.h"
 #include <Arduino.h>
+#include "AdcScanner.h"
 
 /**
  * Sensor HD-38 - Soil Moisture / Rain Sensor
@@ -33,13 +34,16 @@
 class HD38Sensor : public ISensor {
 private:
     int analogPin;
+    int adcChannel;      // Canal en adcScanner
     int digitalPin;
     bool useVoltageDivider;
     bool invertLogic;
 
     float humidity;      // Soil moisture percentage (analog)
+    bool clamped;        // Analog reading outside the calibration range
     bool digitalState;   // Digital threshold state
     bool active;
+    uint32_t readMs;
 
     // Calibration values for analog
     int dryValue;    // ADC value when dry
@@ -54,12 +58,15 @@ public:
                bool invert = false,
                const char* name = "HD38")
         : analogPin(aPin),
+          adcChannel(-1),
           digitalPin(dPin),
           useVoltageDivider(voltageDivider),
           invertLogic(invert),
           humidity(0),
+          clamped(false),
           digitalState(false),
           active(false),
+          readMs(0),
           dryValue(4095),  // Max ADC = dry
           wetValue(0),     // Min ADC = wet
           sensorName(name) {}
@@ -69,10 +76,13 @@ public:
                       sensorName.c_str(), analogPin, digitalPin,
                       useVoltageDivider ? "yes" : "no");
 
-        // Configure analog pin
+        // Configure analog pin (12-bit ADC, 0-4095, sampled by adcScanner)
         if (analogPin >= 0) {
-            pinMode(analogPin, INPUT);
-            analogReadResolution(12);  // 12-bit ADC (0-4095)
+            adcChannel = adcScanner.addPin(analogPin);
+            if (adcChannel < 0) {
+                active = false;
+                return false;
+            }
         }
 
         // Configure digital pin
@@ -101,7 +111,8 @@ public:
 
         // Read analog value
         if (analogPin >= 0) {
-            int rawValue = analogRead(analogPin);
+            // Oversampled, filtered value from the shared ADC scan
+            int rawValue = adcScanner.read(adcChannel);
 
             // If using voltage divider (5V→2.5V max), scale reading
             // With 2:1 divider, 5V input = 2.5V = ~3100 ADC at 3.3V ref
@@ -115,10 +126,12 @@ public:
             // Map to 0-100% humidity
             // Invert: higher ADC = drier = lower humidity
             humidity = map(rawValue, dryValue, wetValue, 0, 100);
+            clamped = humidity < 0 || humidity > 100;
             humidity = constrain(humidity, 0, 100);
 
-            Serial.printf("[HD38] '%s' Raw=%d, Humidity=%.1f%%\n",
-                         sensorName.c_str(), rawValue, humidity);
+            Serial.printf("[HD38] '%s' Raw=%d (%u mV, ±%u), Humidity=%.1f%%\n",
+                         sensorName.c_str(), rawValue, (unsigned)adcScanner.millivolts(adcChannel),
+                         adcScanner.getSpread(adcChannel), humidity);
         }
 
         // Read digital value
@@ -134,6 +147,7 @@ public:
                          digitalState ? "WET" : "DRY");
         }
 
+        readMs = millis();
         return true;
     }
 
@@ -161,10 +175,10 @@ public:
         return sensorId;
     }
 
-    const char* getMeasurementsString() override {
-        static char measString[64];
-        snprintf(measString, sizeof(measString), "soilHum=%.1f", humidity);
-        return measString;
+    // Only the analog reading is published; digital-only wiring has no value
+    void getMeasurements(MeasurementSet& out) override {
+        out.addNamed("soilHum", humidity, 1, readMs,
+                     analogPin < 0 ? MEAS_INVALID : (clamped ? MEAS_CLAMPED : MEAS_OK));
     }
 
     bool isActive() override {
@@ -193,11 +207,11 @@ public:
     }
 
     /**
-     * Get raw ADC value for calibration
+     * Get raw ADC value for calibration (oversampled and filtered)
      */
     int getRawValue() {
-        if (analogPin >= 0) {
-            return analogRead(analogPin);
+        if (adcChannel >= 0) {
+            return adcScanner.read(adcChannel);
         }
         return -1;
     }
@@ -1,6 +1,8 @@
 #ifndef ISENSOR_H
 #define ISENSOR_H
 
+#include "Measurement.h"
+
 class ISensor {
 public:
     virtual ~ISensor() {}
@@ -14,13 +16,23 @@ public:
     // Leer datos del sensor
     virtual bool read() = 0;
 
+    // Lectura en dos fases (opcional): requestRead() inicia la medición sin
+    // bloquear y devuelve true si el sensor la soporta; mientras readPending()
+    // sea true el resultado no llegó. Después se llama a read() como siempre.
+    virtual bool requestRead() { return false; }
+    virtual bool readPending() { return false; }
+
     // Getters para valores medidos
     virtual float getTemperature() = 0;  // Celsius
     virtual float getHumidity() = 0;     // Percentage 0-100
     virtual float getCO2() = 0;          // ppm (-1 si no aplica)
 
     virtual float getPressure() { return -1; } // hPa (-1 si no aplica)
-    virtual const char* getMeasurementsString() = 0; // string with all measurements
+
+    // Mediciones de la última lectura (campo, valor, calidad, millis() de la
+    // lectura), agregadas a out. Cada destino las formatea a su manera.
+    virtual void getMeasurements(MeasurementSet& out) = 0;
+
     // Nombre del tipo de sensor
     virtual const char* getSensorType() = 0;
 
@@ -0,0 +1,227 @@
+#ifndef MODBUS_SENSOR_H
+#define MODBUS_SENSOR_H
+
+#include "ISensor.h"
+#include "ModbusBusPoller.h"
+#include "ModbusRegisterMap.h"
+
+/**
+ * Sensor Modbus RTU genérico, definido por un mapa de registros.
+ *
+ * Los campos (registro, tipo, escala, nombre) vienen de un preset o de
+ * config.json. Los registros cercanos se leen juntos: el TH-MB-04S son 2
+ * registros en una trama, el SN-3002 (humedad, temperatura, EC, pH, N, P, K)
+ * son 7 registros en una trama en lugar de siete consultas.
+ *
+ * La lectura es en dos fases sobre ModbusBusPoller: requestRead() encola un
+ * slot por bloque y read() decodifica el último resultado sin bloquear.
+ *
+ * Config:
+ *   - preset: "th_mb_04s" | "npk_7in1" (o "fields" para un mapa propio)
+ *   - address / addresses: Direccion(es) Modbus (1-254)
+ *   - rx_pin, tx_pin, de_pin, baudrate: bus RS485 compartido
+ */
+class ModbusSensor : public ISensor {
+private:
+    uint8_t modbusAddress;
+    int rxPin;
+    int txPin;
+    int dePin;
+    uint32_t baudrate;
+
+    ModbusFieldDesc fields[MODBUS_SENSOR_MAX_FIELDS];
+    float values[MODBUS_SENSOR_MAX_FIELDS];
+    bool valid[MODBUS_SENSOR_MAX_FIELDS];
+    int8_t fieldBlock[MODBUS_SENSOR_MAX_FIELDS];
+    uint8_t fieldCount;
+
+    ModbusBlock blocks[MODBUS_SENSOR_MAX_BLOCKS];
+    int slots[MODBUS_SENSOR_MAX_BLOCKS];
+    int blockCount;
+
+    int tempIdx;
+    int humIdx;
+    int co2Idx;
+    bool active;
+
+    char sensorType[32];
+    char sensorID[32];
+    uint32_t readMs;
+
+    int findField(const char* a, const char* b = nullptr) const {
+        for (int i = 0; i < fieldCount; i++) {
+            if (strcmp(fields[i].name, a) == 0 || (b && strcmp(fields[i].name, b) == 0)) return i;
+        }
+        return -1;
+    }
+
+    float fieldValue(int idx) const {
+        return (idx >= 0 && valid[idx]) ? values[idx] : -1;
+    }
+
+public:
+    ModbusSensor(uint8_t address,
+                 const ModbusFieldDesc* desc,
+                 uint8_t count,
+                 const char* idPrefix,
+                 const char* typeName,
+                 int rx = 16,
+                 int tx = 17,
+                 int de = 18,
+                 uint32_t baud = 9600)
+        : modbusAddress(address),
+          rxPin(rx),
+          txPin(tx),
+          dePin(de),
+          baudrate(baud),
+          fieldCount(count > MODBUS_SENSOR_MAX_FIELDS ? MODBUS_SENSOR_MAX_FIELDS : count),
+          blockCount(0),
+          active(false),
+          readMs(0) {
+        for (int i = 0; i < fieldCount; i++) {
+            fields[i] = desc[i];
+            values[i] = -1;
+            valid[i] = false;
+            fieldBlock[i] = -1;
+        }
+        tempIdx = findField("temp", "soilTemp");
+        humIdx = findField("hum", "soilHum");
+        co2Idx = findField("co2");
+
+        snprintf(sensorType, sizeof(sensorType), "modbus_%s_%d", typeName, address);
+        snprintf(sensorID, sizeof(sensorID), "%s-mod-%d", idPrefix, address);
+    }
+
+    bool init() override {
+        Serial.printf("[Modbus] Initializing %s (%d campos)\n", sensorType, fieldCount);
+
+        // Initialize shared bus
+        if (!modbusBus.begin(rxPin, txPin, dePin, baudrate)) {
+            Serial.println("[Modbus] Failed to initialize bus");
+            return false;
+        }
+
+        // Agrupar registros cercanos en la menor cantidad de tramas
+        blockCount = planModbusBlocks(fields, fieldCount, MODBUS_POLLER_MAX_REGS, MODBUS_COALESCE_MAX_GAP,
+                                      blocks, MODBUS_SENSOR_MAX_BLOCKS);
+        if (blockCount <= 0) {
+            Serial.printf("[Modbus] %s: mapa de registros inválido\n", sensorType);
+            return false;
+        }
+        for (int i = 0; i < fieldCount; i++) {
+            fieldBlock[i] = findModbusBlock(blocks, blockCount, fields[i]);
+        }
+        for (int b = 0; b < blockCount; b++) {
+            slots[b] = modbusBus.addSlot(modbusAddress, blocks[b].start, blocks[b].count);
+            if (slots[b] < 0) return false;
+            Serial.printf("  └─ Bloque %d: registros %u-%u\n", b, blocks[b].start,
+                          blocks[b].start + blocks[b].count - 1);
+        }
+
+        // Test read to verify sensor is accessible (blocking, boot only)
+        active = modbusBus.readBlocking(slots[0]);
+        for (int b = 1; active && b < blockCount; b++) {
+            modbusBus.readBlocking(slots[b]);
+        }
+
+        if (active) {
+            Serial.printf("[Modbus] Sensor addr=%d initialized successfully\n", modbusAddress);
+        } else {
+            Serial.printf("[Modbus] Sensor addr=%d not responding\n", modbusAddress);
+        }
+        return active;
+    }
+
+    bool dataReady() override {
+        return active;
+    }
+
+    bool requestRead() override {
+        if (!active) return false;
+        for (int b = 0; b < blockCount; b++) {
+            modbusBus.request(slots[b]);
+        }
+        return true;
+    }
+
+    bool readPending() override {
+        for (int b = 0; b < blockCount; b++) {
+            if (modbusBus.isPending(slots[b])) return true;
+        }
+        return false;
+    }
+
+    // Decodifica el último resultado de cada bloque (no bloquea).
+    // Devuelve true si al menos un campo es válido.
+    bool read() override {
+        if (!active) return false;
+
+        int validCount = 0;
+        for (int i = 0; i < fieldCount; i++) {
+            const ModbusBusPoller::Slot* s = modbusBus.getSlot(slots[fieldBlock[i]]);
+            valid[i] = s && s->ok;
+            if (valid[i]) {
+                values[i] = decodeModbusField(&s->regs[fields[i].reg - s->startReg], fields[i].type, fields[i].scale);
+                validCount++;
+            } else {
+                values[i] = -1;
+            }
+        }
+
+        if (validCount == 0) {
+            Serial.printf("[Modbus] Addr %d: Read failed\n", modbusAddress);
+            return false;
+        }
+        readMs = millis();
+
+        MeasurementSet m;
+        getMeasurements(m);
+        char line[128];
+        measurementsToFields(m, line, sizeof(line));
+        Serial.printf("[Modbus] Addr %d: %s\n", modbusAddress, line);
+        return true;
+    }
+
+    float getTemperature() override {
+        return fieldValue(tempIdx);
+    }
+
+    float getHumidity() override {
+        return fieldValue(humIdx);
+    }
+
+    float getCO2() override {
+        return fieldValue(co2Idx);
+    }
+
+    const char* getSensorType() override {
+        return sensorType;
+    }
+
+    // Identifier format: "<prefix>-mod-address"
+    const char* getSensorID() override {
+        return sensorID;
+    }
+
+    // Un campo por registro del mapa; los del bloque que no respondió van MEAS_INVALID
+    void getMeasurements(MeasurementSet& out) override {
+        for (int i = 0; i < fieldCount; i++) {
+            out.addNamed(fields[i].name, values[i], fields[i].decimals, readMs,
+                         valid[i] ? MEAS_OK : MEAS_INVALID);
+        }
+    }
+
+    bool calibrate(float reference) override {
+        return false;
+    }
+
+    bool isActive() override {
+        return active;
+    }
+
+    uint8_t getAddress() const {
+        return modbusAddress;
+    }
+};
+
+#endif // MODBUS_SENSOR_H
@@ -11,11 +11,12 @@ private:
     float temperature;
     float humidity;
     float pressure; 
+    uint32_t readMs;
     //address could be 0x76 or 0x77
     u_int address = 0x76;
 
 public:
-    SensorBME280() : active(false), temperature(99), humidity(100), pressure(0) {}
+    SensorBME280() : active(false), temperature(99), humidity(100), pressure(0), readMs(0) {}
 
     bool init() override {
         // Try I2C address 0x76 (default) or 0x77 (alternate)
@@ -54,6 +55,7 @@ public:
             return false;
         }
 
+        readMs = millis();
         return true;
     }
 
@@ -61,10 +63,10 @@ public:
     float getHumidity() override { return humidity; }
     float getCO2() override { return -1; }  // Not available
     float getPressure() override { return pressure; }
-    const char* getMeasurementsString() override {
-        static char measString[64];
-        snprintf(measString, sizeof(measString), "temp=%.2f,hum=%.2f,press=%.2f", temperature, humidity, pressure);
-        return measString;
+    void getMeasurements(MeasurementSet& out) override {
+        out.add(MEAS_TEMP, temperature, readMs);
+        out.add(MEAS_HUM, humidity, readMs);
+        out.add(MEAS_PRESS, pressure, readMs);
     }
     const char* getSensorType() override { return "BME280"; }
     const char* getSensorID() override {
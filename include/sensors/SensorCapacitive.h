@@ -3,6 +3,7 @@
 
 #include "ISensor.h"
 #include <Arduino.h>
+#include "AdcScanner.h"
 
 #define CAPACITIVE_PIN 34  // ADC pin for capacitive soil moisture sensor
 #define ADC_MAX 4095       // 12-bit ADC
@@ -11,8 +12,11 @@
 class SensorCapacitive : public ISensor {
 private:
     int pin;
+    int adcChannel;  // Canal en adcScanner
     float humidity;  // Soil moisture percentage
+    bool clamped;    // El ADC quedó fuera de la calibración
     bool active;
+    uint32_t readMs;
 
     // Calibration values (can be adjusted per sensor)
     int dryValue;    // ADC value when completely dry
@@ -20,13 +24,14 @@ private:
 
 public:
     SensorCapacitive(int adcPin = CAPACITIVE_PIN, int dry = ADC_MAX, int wet = ADC_MIN)
-        : pin(adcPin), humidity(0), active(false), dryValue(dry), wetValue(wet) {}
+        : pin(adcPin), adcChannel(-1), humidity(0), clamped(false), active(false), readMs(0),
+          dryValue(dry), wetValue(wet) {}
 
     bool init() override {
-        pinMode(pin, INPUT);
-        active = true;
-        Serial.printf("Sensor capacitivo inicializado en pin %d\n", pin);
-        return true;
+        adcChannel = adcScanner.addPin(pin);
+        active = adcChannel >= 0;
+        if (active) Serial.printf("Sensor capacitivo inicializado en pin %d\n", pin);
+        return active;
     }
 
     bool dataReady() override {
@@ -37,15 +42,19 @@ public:
     bool read() override {
         if (!active) return false;
 
-        int rawValue = analogRead(pin);
+        // Valor sobremuestreado y filtrado del barrido compartido
+        int rawValue = adcScanner.read(adcChannel);
 
         // Map ADC value to 0-100% (inverted: higher ADC = drier = lower %)
         humidity = map(rawValue, dryValue, wetValue, 0, 100);
 
         // Constrain to valid range
+        clamped = humidity < 0 || humidity > 100;
         humidity = constrain(humidity, 0, 100);
+        readMs = millis();
 
-        Serial.printf("Raw ADC: %d, Humedad suelo: %.1f%%\n", rawValue, humidity);
+        Serial.printf("Raw ADC: %d (%u mV, ±%u), Humedad suelo: %.1f%%\n", rawValue,
+                      (unsigned)adcScanner.millivolts(adcChannel), adcScanner.getSpread(adcChannel), humidity);
         return true;
     }
 
@@ -71,10 +80,8 @@ public:
         return idString;
     }
 
-    const char* getMeasurementsString() override {
-        static char measString[32];
-        snprintf(measString, sizeof(measString), "soilHum=%.2f", humidity);
-        return measString;
+    void getMeasurements(MeasurementSet& out) override {
+        out.add(MEAS_SOIL_HUM, humidity, readMs, clamped ? MEAS_CLAMPED : MEAS_OK);
     }
 
     bool isActive() override {
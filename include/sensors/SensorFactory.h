@@ -11,7 +11,7 @@
 #elif defined(SENSOR_TYPE_BME280)
   #include "SensorBME280.h"
 #elif defined(SENSOR_TYPE_MODBUS_TH)
-  #include "ModbusTHSensor.h"
+  #include "ModbusSensor.h"
 #elif defined(MODO_SIMULACION)
   #include "SensorSimulated.h"
 #else
@@ -28,7 +28,7 @@ public:
         #elif defined(SENSOR_TYPE_BME280)
             return new SensorBME280();
         #elif defined(SENSOR_TYPE_MODBUS_TH)
-            return new ModbusTHSensor();
+            return new ModbusSensor(1, MODBUS_PRESET_TH_MB_04S, 2, "th", "th");
         #elif defined(MODO_SIMULACION)
             return new SensorSimulated();
         #else
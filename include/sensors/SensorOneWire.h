@@ -4,18 +4,61 @@
 #include "ISensor.h"
 #include <OneWire.h>
 #include <DallasTemperature.h>
+#include "OneWireConversion.h"
+
+/**
+ * Bus OneWire (un pin) compartido por sus sondas DS18B20.
+ *
+ * Las conversiones son sin espera (setWaitForConversion(false)): la
+ * primera sonda que vence manda Convert T a todo el bus y las demás leen
+ * el resultado de esa misma conversión. Con alimentación parásita el bus
+ * tiene que quedar en alto durante la conversión, así que ahí sigue
+ * siendo bloqueante.
+ */
+struct OneWireBus {
+    OneWire wire;
+    DallasTemperature dallas;
+    OneWireConversion conversion;
+    bool parasite;
+
+    explicit OneWireBus(int pin) : wire(pin), dallas(&wire), parasite(false) {}
+
+    // Después de dallas.begin() y de fijar la resolución de las sondas
+    void configure() {
+        parasite = dallas.isParasitePowerMode();
+        dallas.setWaitForConversion(parasite);
+        conversion.begin(parasite ? 0 : OneWireConversion::conversionMs(dallas.getResolution()));
+    }
+
+    void startConversion() {
+        if (conversion.start(millis())) dallas.requestTemperatures();
+    }
+
+    bool conversionPending() {
+        uint32_t now = millis();
+        if (!conversion.pending(now)) return false;
+        // Una sonda que sigue convirtiendo mantiene el bus en bajo
+        if (!parasite && dallas.isConversionComplete()) {
+            conversion.complete(now);
+            return false;
+        }
+        return true;
+    }
+};
 
 class SensorOneWire : public ISensor {
 private:
+    OneWireBus* bus;
     DallasTemperature* dallas;
     DeviceAddress address;  // 64-bit unique address
     String addressStr;      // Hex string for identification
     float temperature;
     int deviceIndex;
     bool active;
+    uint32_t readMs;
 public:
-    SensorOneWire(DallasTemperature* dt, DeviceAddress addr, int idx)
-        : dallas(dt), deviceIndex(idx), temperature(-127), active(false) {
+    SensorOneWire(OneWireBus* b, DeviceAddress addr, int idx)
+        : bus(b), dallas(&b->dallas), temperature(-127), deviceIndex(idx), active(false), readMs(0) {
         memcpy(address, addr, 8);
 
         // Convert address to hex string for identification
@@ -42,14 +85,26 @@ public:
         return active;
     }
 
+    // Lectura en dos fases: la conversión es del bus, read() cuando terminó
+    bool requestRead() override {
+        if (!active) return false;
+        bus->startConversion();
+        return true;
+    }
+
+    bool readPending() override {
+        return bus->conversionPending();
+    }
+
     bool read() override {
         if (!active || !dallas) return false;
 
-        // Request temperature (non-blocking after first call)
+        // Resultado de la última conversión del bus (solo lee el scratchpad)
         float temp = dallas->getTempC(address);
 
         if (temp != DEVICE_DISCONNECTED_C && temp != 85.0) {  // 85.0 = not ready
             temperature = temp;
+            readMs = millis();
             return true;
         }
 
@@ -72,10 +127,10 @@ public:
         snprintf(sensorId, sizeof(sensorId), "t-1w-%s", last4.c_str());
         return sensorId;
     }
-    const char* getMeasurementsString() override {
-        static char measString[32];
-        snprintf(measString, sizeof(measString), "temp=%.2f", temperature);
-        return measString;  
+    // Sin conversión válida todavía (-127 = DEVICE_DISCONNECTED_C): no se publica
+    void getMeasurements(MeasurementSet& out) override {
+        out.add(MEAS_TEMP, temperature, readMs,
+                temperature == DEVICE_DISCONNECTED_C ? MEAS_INVALID : MEAS_OK);
     }
 };
 
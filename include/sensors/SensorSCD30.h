@@ -11,9 +11,10 @@ private:
     float temperature;
     float humidity;
     float co2;
+    uint32_t readMs;
 
 public:
-    SensorSCD30() : active(false), temperature(99), humidity(100), co2(999999) {}
+    SensorSCD30() : active(false), temperature(99), humidity(100), co2(999999), readMs(0) {}
 
     bool init() override {
         active = scd30.begin();
@@ -38,6 +39,7 @@ public:
         temperature = scd30.temperature;
         humidity = scd30.relative_humidity;
         co2 = scd30.CO2;
+        readMs = millis();
         return true;
     }
 
@@ -52,10 +54,10 @@ public:
         return sensorId;
     }
 
-    const char* getMeasurementsString() override {
-        static char measString[64];
-        snprintf(measString, sizeof(measString), "temp=%.2f,hum=%.2f,co2=%.2f", temperature, humidity, co2);
-        return measString;
+    void getMeasurements(MeasurementSet& out) override {
+        out.add(MEAS_TEMP, temperature, readMs);
+        out.add(MEAS_HUM, humidity, readMs);
+        out.add(MEAS_CO2, co2, readMs);
     }
     
     bool calibrate(float reference = 400) override {
@@ -10,9 +10,10 @@ private:
     float temperature;
     float humidity;
     float co2;
+    uint32_t readMs;
 
 public:
-    SensorSimulated() : active(false), temperature(22.5), humidity(50), co2(400) {}
+    SensorSimulated() : active(false), temperature(22.5), humidity(50), co2(400), readMs(0) {}
 
     bool init() override {
         active = true;
@@ -31,6 +32,7 @@ public:
         temperature = 22.5 + random(-100, 100) * 0.01;
         humidity = 50 + random(-500, 500) * 0.01;
         co2 = 400 + random(0, 200);
+        readMs = millis();
 
         return true;
     }
@@ -40,10 +42,10 @@ public:
     float getCO2() override { return co2; }
     const char* getSensorType() override { return "Simulated"; }
     const char* getSensorID() override { return "sim-001"; }
-    const char* getMeasurementsString() override {
-        static char measString[64];
-        snprintf(measString, sizeof(measString), "temp=%.2f,hum=%.2f,co2=%.2f", temperature, humidity, co2);
-        return measString;
+    void getMeasurements(MeasurementSet& out) override {
+        out.add(MEAS_TEMP, temperature, readMs);
+        out.add(MEAS_HUM, humidity, readMs);
+        out.add(MEAS_CO2, co2, readMs);
     }
     bool isActive() override { return active; }
 };
@@ -0,0 +1,76 @@
+#ifndef UPLINK_QUEUE_H
+#define UPLINK_QUEUE_H
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/task.h>
+#include "lineProtocol.h"
+
+#define UPLINK_QUEUE_DEFAULT_DEPTH 32
+#define UPLINK_QUEUE_MAX_DEPTH     128
+#define UPLINK_TASK_STACK          8192
+#define UPLINK_TASK_PRIORITY       1
+#define UPLINK_TASK_CORE           0     // El loop de Arduino corre en el core 1
+
+// Registro de tamaño fijo que produce el muestreo y consume la tarea de envío
+struct UplinkRecord {
+  uint32_t timestamp;   // Epoch en segundos al tomar la muestra
+  char sensorId[24];
+  char deviceId[20];    // "" = este dispositivo, "moni-XXXXXXXXXXXX" = nodo de la malla
+  char fields[UPLINK_FIELDS_LEN];   // field1=v1,field2=v2
+};
+
+/**
+ * Pipeline productor/consumidor para el envío a Grafana.
+ *
+ * El loop (sensores, malla) solo encola registros sin bloquear; una tarea
+ * FreeRTOS fijada al core 0 los agrupa en un GrafanaBatch, hace el POST cada
+ * uploadInterval y reenvía lo guardado offline. Un POST lento ya no congela
+ * la interfaz web ni el drenaje de la malla.
+ */
+class UplinkQueue {
+public:
+  UplinkQueue();
+
+  bool begin(uint16_t depth = UPLINK_QUEUE_DEFAULT_DEPTH, uint32_t uploadIntervalMs = 10000);
+
+  // No bloquea: si la cola está llena el registro se descarta y se cuenta.
+  // ageSeconds: antigüedad de la muestra (lecturas agregadas de la malla)
+  bool enqueue(const char* fields, const char* sensorId, const char* deviceId = "", uint32_t ageSeconds = 0);
+
+  uint16_t getCapacity() const { return capacity; }
+  uint16_t getDepth() const;
+  uint16_t getHighWater() const { return highWater; }
+  uint32_t getEnqueued() const { return enqueued; }
+  uint32_t getDropped() const { return dropped; }
+  uint32_t getSentLines() const { return sentLines; }
+  uint32_t getBatches() const { return batches; }
+  uint32_t getFailedBatches() const { return failedBatches; }
+  uint32_t getLastBatchMs() const { return lastBatchMs; }
+  uint32_t getUploadInterval() const { return uploadInterval; }
+
+private:
+  QueueHandle_t queue;
+  TaskHandle_t task;
+  uint16_t capacity;
+  uint32_t uploadInterval;
+
+  // Escritos por el productor
+  volatile uint16_t highWater;
+  volatile uint32_t enqueued;
+  volatile uint32_t dropped;
+
+  // Escritos por la tarea de envío
+  volatile uint32_t sentLines;
+  volatile uint32_t batches;
+  volatile uint32_t failedBatches;
+  volatile uint32_t lastBatchMs;   // Duración del último POST
+
+  static void taskEntry(void* param);
+  void run();
+};
+
+extern UplinkQueue uplinkQueue;
+
+#endif // UPLINK_QUEUE_H
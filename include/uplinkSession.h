@@ -0,0 +1,54 @@
+#ifndef UPLINK_SESSION_H
+#define UPLINK_SESSION_H
+
+#include <Arduino.h>
+#include <HTTPClient.h>
+#include <WiFiClient.h>
+#include <WiFiClientSecure.h>
+
+/**
+ * Sesión HTTP persistente (keep-alive) hacia Grafana/InfluxDB.
+ *
+ * Abre la conexión una sola vez y la reutiliza entre POSTs
+ * (HTTPClient::setReuse(true)). Si el servidor cerró el socket sin que lo
+ * notemos, el primer POST falla con un error de transporte: se cierra la
+ * conexión, se vuelve a abrir y se reintenta una vez.
+ */
+class UplinkSession {
+public:
+  UplinkSession();
+
+  // POST del cuerpo en line protocol. Devuelve el código HTTP (o < 0 si falla el transporte)
+  int post(const uint8_t* body, size_t length);
+  int post(const String& body) { return post((const uint8_t*)body.c_str(), body.length()); }
+
+  // Cierra la conexión (p.ej. al perder WiFi)
+  void close();
+
+  bool isConnected() { return begun && http.connected(); }
+
+  // Estadísticas
+  uint32_t getHandshakes() const { return handshakes; }
+  uint32_t getHandshakesAvoided() const { return handshakesAvoided; }
+  uint32_t getReconnects() const { return reconnects; }
+  uint32_t getFailures() const { return failures; }
+
+private:
+  HTTPClient http;
+  WiFiClient plainClient;
+  WiFiClientSecure secureClient;
+  bool begun;
+
+  uint32_t handshakes;         // Conexiones TCP/TLS abiertas
+  uint32_t handshakesAvoided;  // POSTs que reutilizaron la conexión abierta
+  uint32_t reconnects;         // Reintentos por socket caído
+  uint32_t failures;           // POSTs fallidos tras reintentar
+
+  bool begin();
+  int send(const uint8_t* body, size_t length);
+  static bool isTransportError(int code);
+};
+
+extern UplinkSession uplinkSession;
+
+#endif // UPLINK_SESSION_H
@@ -1,8 +1,8 @@
 #include <Arduino.h>
-#include <WiFi.h>
 #include <SPIFFS.h>
 #include <ArduinoJson.h>
 #include "configFile.h"
+#include "deviceIdentity.h"
 #include "globals.h"
 #include "constants.h"
 
@@ -39,10 +39,8 @@ void createConfigFile() {
     config["max_hum"] = 65;
     config["min_hum"] = 55;
 
-    String mac = WiFi.macAddress();
-    mac.replace(":", "");
-    config["hash"] = mac;
-    config["incubator_name"] = "moni-" + mac; // en algun momento se debe a cambiar por el nombre del incubador por moni
+    config["hash"] = deviceIdentity.macHex();
+    config["incubator_name"] = deviceIdentity.name(); // en algun momento se debe a cambiar por el nombre del incubador por moni
 
     // Configuración de sensores (para modo multi-sensor)
     JsonArray sensors = config["sensors"].to<JsonArray>();
@@ -74,6 +72,7 @@ void createConfigFile() {
     config["beacon_interval_ms"] = 2000;
     config["discovery_timeout_ms"] = 15000;
     config["send_interval_ms"] = 30000;
+    config["espnow_deep_sleep"] = false;  // Sensor a batería: deep sleep entre envíos
     config["grafana_ping_url"] = "http://192.168.1.1/ping";  // URL for connectivity test
 
     if (serializeJsonPretty(config, file) == 0) {
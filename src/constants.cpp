@@ -6,6 +6,9 @@ const char* YOUR_GITHUB_USERNAME = "Pablomonte";
 const char* YOUR_REPO_NAME = "proyecto-monitoreo";
 const unsigned long UPDATE_INTERVAL = 3600000;  // 1 hora
 const char* CONFIG_FILE_PATH = "/config.json";
+const unsigned long DEFAULT_UPLOAD_INTERVAL_MS = 10000;  // 10 segundos
+const unsigned long DEFAULT_SENSOR_PERIOD_MS = 10000;    // 10 segundos (config: sensors[].config.period_ms)
+const unsigned long SENSOR_POLL_INTERVAL_MS = 100;
 
 // Las credenciales (URL, TOKEN_GRAFANA, FIRMWARE_BIN_URL)
 // están definidas en constants_private.h
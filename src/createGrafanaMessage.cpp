@@ -1,47 +1,51 @@
 #include "createGrafanaMessage.h"
-#include <WiFi.h>
 #include <constants.h>
+#include "deviceIdentity.h"
 
 /**
- * Helper function to build the device name from deviceId
- * If deviceId is a mesh sensor (starts with "mesh_"), use it directly
- * Otherwise, use the gateway MAC address
+ * Device tag: mesh sensors (deviceId "moni-...") keep their own name,
+ * local sensors use this device's cached name
  */
-static void buildDeviceName(char* device_name, size_t size, const char* deviceId) {
+static const char* deviceTag(const char* deviceId) {
   if (deviceId && strncmp(deviceId, "moni-", 5) == 0) {
-    snprintf(device_name, size, "%s", deviceId);
-    
-  } else {
-    // For local sensors, use gateway MAC
-    String mac = WiFi.macAddress();
-    mac.replace(":", "");
-    snprintf(device_name, size, "moni-%s", mac.c_str());
+    return deviceId;
   }
+  return deviceIdentity.name();
 }
 
 /**
- * Helper function to build the InfluxDB line protocol message
- * Returns: "medicionesCO2,device=<device>,sensor=<sensor> <fields> <timestamp>"
+ * Encode one line directly into the writer's buffer (no heap):
+ * "medicionesCO2,device=<device>,sensor=<sensor> <fields> <timestamp>"
  */
-static String buildInfluxMessage(const char* device_name, const char* sensorId, const char* fields, unsigned long long timestamp) {
-  return "medicionesCO2,device=" + String(device_name) + 
-         ",sensor=" + String(sensorId) + 
-         " " + String(fields) + 
-         " " + String(timestamp);
+bool appendGrafanaLine(LineProtocolWriter& writer, const char* fields, const char* sensorId, const char* deviceId, unsigned long long timestamp)
+{
+  writer.beginLine(GRAFANA_MEASUREMENT);
+  writer.tag("device", deviceTag(deviceId));
+  writer.tag("sensor", sensorId);
+  writer.rawFields(fields);
+  writer.timestamp(timestamp);
+  return writer.endLine();
+}
+
+bool appendGrafanaLine(LineProtocolWriter& writer, float temperature, float humidity, float co2, const char* sensorId, const char* deviceId, unsigned long long timestamp)
+{
+  writer.beginLine(GRAFANA_MEASUREMENT);
+  writer.tag("device", deviceTag(deviceId));
+  writer.tag("sensor", sensorId);
+  writer.field("temp", temperature, 2);
+  writer.field("hum", humidity, 2);
+  writer.field("co2", co2, 2);
+  writer.timestamp(timestamp);
+  return writer.endLine();
 }
 
 String create_grafana_message(float temperature, float humidity, float co2, const char* sensorId, const char* deviceId)
 {
   unsigned long long timestamp = time(nullptr) * 1000000000ULL;
-  char device_name[64] = {0};
-  buildDeviceName(device_name, sizeof(device_name), deviceId);
-
-  // Build fields string: "temp=X,hum=Y,co2=Z"
-  String fields = "temp=" + String(temperature, 2) +
-                  ",hum=" + String(humidity, 2) +
-                  ",co2=" + String(co2);
-
-  return buildInfluxMessage(device_name, sensorId, fields.c_str(), timestamp);
+  char line[GRAFANA_LINE_MAX_BYTES];
+  LineProtocolWriter writer(line, sizeof(line));
+  appendGrafanaLine(writer, temperature, humidity, co2, sensorId, deviceId, timestamp);
+  return String(line);
 }
 
 /**
@@ -51,8 +55,17 @@ String create_grafana_message(float temperature, float humidity, float co2, cons
 String create_grafana_message(const char* message, const char* sensorId, const char* deviceId)
 {
   unsigned long long timestamp = time(nullptr) * 1000000000ULL;
-  char device_name[64] = {0};
-  buildDeviceName(device_name, sizeof(device_name), deviceId);
+  return create_grafana_message(message, sensorId, deviceId, timestamp);
+}
 
-  return buildInfluxMessage(device_name, sensorId, message, timestamp);
-}
\ No newline at end of file
+/**
+ * Overload with an explicit timestamp (ns), for samples taken earlier
+ * and sent later (e.g. queued for the uplink task)
+ */
+String create_grafana_message(const char* message, const char* sensorId, const char* deviceId, unsigned long long timestamp)
+{
+  char line[GRAFANA_LINE_MAX_BYTES];
+  LineProtocolWriter writer(line, sizeof(line));
+  appendGrafanaLine(writer, message, sensorId, deviceId, timestamp);
+  return String(line);
+}
@@ -0,0 +1,48 @@
+#include <esp_system.h>
+#include "deviceIdentity.h"
+
+DeviceIdentity deviceIdentity;
+
+static const char HEX_DIGITS[] = "0123456789ABCDEF";
+
+static void formatHex(char* out, const uint8_t mac[6]) {
+  for (int i = 0; i < 6; i++) {
+    out[i * 2] = HEX_DIGITS[mac[i] >> 4];
+    out[i * 2 + 1] = HEX_DIGITS[mac[i] & 0x0F];
+  }
+  out[12] = '\0';
+}
+
+static void formatColon(char* out, const uint8_t mac[6]) {
+  for (int i = 0; i < 6; i++) {
+    out[i * 3] = HEX_DIGITS[mac[i] >> 4];
+    out[i * 3 + 1] = HEX_DIGITS[mac[i] & 0x0F];
+    out[i * 3 + 2] = (i < 5) ? ':' : '\0';
+  }
+}
+
+void formatDeviceName(char* out, const uint8_t mac[6]) {
+  memcpy(out, "moni-", 5);
+  formatHex(out + 5, mac);
+}
+
+DeviceIdentity::DeviceIdentity() : initialized(false) {
+  memset(sta, 0, sizeof(sta));
+  memset(ap, 0, sizeof(ap));
+  staStr[0] = apStr[0] = hex[0] = deviceName[0] = '\0';
+}
+
+void DeviceIdentity::begin() {
+  if (initialized) return;
+
+  esp_read_mac(sta, ESP_MAC_WIFI_STA);
+  esp_read_mac(ap, ESP_MAC_WIFI_SOFTAP);
+
+  formatColon(staStr, sta);
+  formatColon(apStr, ap);
+  formatHex(hex, sta);
+  formatDeviceName(deviceName, sta);
+  initialized = true;
+
+  Serial.printf("[✓ OK  ] Dispositivo %s (STA %s, AP %s)\n", deviceName, staStr, apStr);
+}
@@ -7,6 +7,9 @@
 #include "constants.h"
 #include "configFile.h"
 #include "webConfigPage.h"
+#include "uplinkQueue.h"
+#include "uplinkSession.h"
+#include "offlineStore.h"
 
 #include <ArduinoJson.h>
 
@@ -21,19 +24,31 @@
 #endif
 
 #ifdef ENABLE_ESPNOW
+  #include <vector>
   #include "ESPNowManager.h"
+  #include "MeshIngressQueue.h"
   extern ESPNowManager espnowMgr;
 #endif
 
+// Mediciones publicables como {"temp": 25.3, "hum": 60.5}, con los decimales de cada campo
+static void measurementsToJson(const MeasurementSet& measurements, JsonObject out) {
+    for (const Measurement& m : measurements) {
+        if (m.quality == MEAS_INVALID || isnan(m.value) || isinf(m.value)) continue;
+        out[m.name] = serialized(String(m.value, (unsigned int)m.decimals));
+    }
+}
+
 void handleMediciones() {
     float temperature = 99, humidity = 100, co2 = 999999, presion = 99;
     String wifiStatus = "unknown";
     bool rotation = false;
+    MeasurementSet measurements;
 
     if (sensor && sensor->isActive() && sensor->dataReady() && sensor->read()) {
         temperature = sensor->getTemperature();
         humidity = sensor->getHumidity();
         co2 = sensor->getCO2();
+        sensor->getMeasurements(measurements);
         wifiStatus = (WiFi.status() == WL_CONNECTED) ? "connected" : "disconnected";
     }
 
@@ -52,6 +67,7 @@ void handleMediciones() {
     doc["a_humidity"] = String(humidity, 2);
     doc["a_co2"] = String(co2, 2); // HAY QUE AÑADIR ESTE A LA APLICACION
     doc["wifi_status"] = wifiStatus;  
+    measurementsToJson(measurements, doc["measurements"].to<JsonObject>());
 
     String output;
     serializeJsonPretty(doc, output);
@@ -389,6 +405,40 @@ void handleConfigReset() {
   ESP.restart();
 }
 
+void handleUplinkStatus() {
+  JsonDocument doc;
+
+  JsonObject queue = doc["queue"].to<JsonObject>();
+  queue["depth"] = uplinkQueue.getDepth();
+  queue["capacity"] = uplinkQueue.getCapacity();
+  queue["high_water"] = uplinkQueue.getHighWater();
+  queue["enqueued"] = uplinkQueue.getEnqueued();
+  queue["dropped"] = uplinkQueue.getDropped();
+
+  JsonObject sent = doc["sent"].to<JsonObject>();
+  sent["lines"] = uplinkQueue.getSentLines();
+  sent["batches"] = uplinkQueue.getBatches();
+  sent["failed_batches"] = uplinkQueue.getFailedBatches();
+  sent["last_batch_ms"] = uplinkQueue.getLastBatchMs();
+  sent["interval_ms"] = uplinkQueue.getUploadInterval();
+
+  JsonObject session = doc["session"].to<JsonObject>();
+  session["handshakes"] = uplinkSession.getHandshakes();
+  session["handshakes_avoided"] = uplinkSession.getHandshakesAvoided();
+  session["reconnects"] = uplinkSession.getReconnects();
+  session["failures"] = uplinkSession.getFailures();
+
+  JsonObject offline = doc["offline"].to<JsonObject>();
+  offline["pending_bytes"] = offlineStore.getPendingBytes();
+  offline["stored_lines"] = offlineStore.getStoredLines();
+  offline["replayed_lines"] = offlineStore.getReplayedLines();
+  offline["dropped_segments"] = offlineStore.getDroppedSegments();
+
+  String output;
+  serializeJson(doc, output);
+  server.send(200, "application/json", output);
+}
+
 #ifdef ENABLE_ESPNOW
 void handleESPNowStatus() {
   JsonDocument doc;
@@ -407,10 +457,148 @@ void handleESPNowStatus() {
   if (actualMode == "sensor") {
     doc["paired"] = espnowMgr.isPaired();
     doc["peer_count"] = 0;  // Sensors don't track peers
+
+    JsonObject tx = doc["tx"].to<JsonObject>();
+    tx["aggregate_cycles"] = espnowMgr.getAggregateCycles();
+    tx["frames"] = espnowMgr.getTxFrames();
+    tx["readings"] = espnowMgr.getTxReadings();
+    tx["bytes"] = espnowMgr.getTxBytes();
   } else {
     doc["paired"] = true;  // Gateway is always "paired"
     doc["peer_count"] = espnowMgr.getActivePeerCount();
+
+    // Registro de peers, del más reciente al menos reciente: copia tomada por rxTask
+    std::vector<PeerEntry> snapshot(espnowMgr.getPeerCapacity());
+    PeerRegistryStats ps = {};
+    int count = espnowMgr.snapshotPeers(snapshot.data(), snapshot.size(), ps);
+    JsonObject peers = doc["peers"].to<JsonObject>();
+    peers["count"] = count < 0 ? espnowMgr.getActivePeerCount() : count;
+    peers["capacity"] = espnowMgr.getPeerCapacity();
+    peers["evictions"] = ps.evictions;
+    peers["expired"] = ps.expired;
+    peers["driver_recycled"] = espnowMgr.getDriverRecycled();
+    peers["max_probe"] = ps.maxProbe;
+    if (count < 0) peers["busy"] = true;  // rxTask no llegó a copiar: sin lista ni estadísticas
+    JsonArray list = peers["list"].to<JsonArray>();
+    uint32_t now = millis();
+    for (int i = 0; i < count; i++) {
+      const PeerEntry* p = &snapshot[i];
+      char deviceid[18];
+      formatDeviceName(deviceid, p->mac);
+      JsonObject n = list.add<JsonObject>();
+      n["device"] = deviceid;
+      n["rssi"] = p->rssi;
+      n["last_seq"] = p->lastSeq;
+      n["frames"] = p->frames;
+      n["bytes"] = p->bytes;
+      n["in_driver"] = p->inDriver;
+      n["last_seen_s"] = (now - p->lastSeenMs) / 1000;
+    }
+  }
+
+  const MeshDedupStats& dd = espnowMgr.getDedupStats();
+  JsonObject dedup = doc["dedup"].to<JsonObject>();
+  dedup["originators"] = dd.originators;
+  dedup["capacity"] = dd.capacity;
+  dedup["lookups"] = dd.lookups;
+  dedup["duplicates"] = dd.duplicates;
+  dedup["resets"] = dd.resets;
+  dedup["evictions"] = dd.evictions;
+  dedup["max_probe"] = dd.maxProbe;
+
+  if (actualMode == "gateway") {
+    // Entrega por originador (huecos, desorden, reinicios, latencia relativa)
+    const MeshSeqTracker& tracker = espnowMgr.getSeqTracker();
+    JsonObject delivery = doc["delivery"].to<JsonObject>();
+    delivery["originators"] = tracker.size();
+    delivery["capacity"] = MESH_TRACK_MAX;
+    delivery["evictions"] = tracker.getEvictions();
+    JsonArray nodes = delivery["nodes"].to<JsonArray>();
+    uint32_t now = millis();
+    for (int i = 0; i < tracker.slots(); i++) {
+      const MeshOriginatorStats* p = tracker.entry(i);
+      if (!p) continue;
+      MeshOriginatorStats e = *p;  // Copia: rxTask la sigue actualizando
+      char deviceid[18];
+      formatDeviceName(deviceid, e.mac);
+      JsonObject n = nodes.add<JsonObject>();
+      n["device"] = deviceid;
+      n["received"] = e.received;
+      n["expected"] = e.expected;
+      n["lost"] = e.lost;
+      n["gaps"] = e.gaps;
+      n["reordered"] = e.reordered;
+      n["reboots"] = e.reboots;
+      n["pdr"] = MeshSeqTracker::deliveryPermille(e) / 1000.0;
+      n["latency_avg_ms"] = e.latencyAvgMs;
+      n["latency_max_ms"] = e.latencyMaxMs;
+      n["last_seen_s"] = (now - e.lastSeenMs) / 1000;
+    }
+  }
+
+  const MeshRouter& router = espnowMgr.getRouter();
+  const MeshRouteStats& rs = router.getStats();
+  JsonObject route = doc["route"].to<JsonObject>();
+  route["enabled"] = espnowMgr.isRoutingEnabled();
+  route["hops"] = router.hops();
+  route["cost"] = router.cost();
+  const uint8_t* parent = router.parent();
+  if (parent) {
+    char parentMac[18];
+    snprintf(parentMac, sizeof(parentMac), "%02X:%02X:%02X:%02X:%02X:%02X",
+             parent[0], parent[1], parent[2], parent[3], parent[4], parent[5]);
+    route["parent"] = parentMac;
+  } else {
+    route["parent"] = nullptr;
   }
+  route["neighbors"] = router.neighborCount();
+  route["parent_changes"] = rs.parentChanges;
+  route["unicast_ok"] = rs.txOk;
+  route["unicast_fail"] = rs.txFail;
+  route["retries"] = espnowMgr.getRouteRetries();
+  route["flood_fallbacks"] = espnowMgr.getFloodFallbacks();
+  route["routed_up"] = espnowMgr.getRoutedUp();
+
+  const TrickleTimer& trickle = espnowMgr.getTrickle();
+  const TrickleStats& ts = trickle.getStats();
+  JsonObject beacon = doc["beacon"].to<JsonObject>();
+  beacon["interval_ms"] = trickle.getInterval();
+  beacon["min_ms"] = trickle.getImin();
+  beacon["max_ms"] = trickle.getImax();
+  beacon["redundancy_k"] = trickle.getRedundancy();
+  beacon["sent"] = ts.sent;
+  beacon["suppressed"] = ts.suppressed;
+  beacon["resets"] = ts.resets;
+
+  JsonObject rxQueue = doc["rx_queue"].to<JsonObject>();
+  rxQueue["frames"] = espnowMgr.getRxFrames();
+  rxQueue["depth"] = espnowMgr.getRxQueueDepth();
+  rxQueue["capacity"] = ESPNOW_RX_RING_SIZE;
+  rxQueue["high_water"] = espnowMgr.getRxQueueHighWater();
+  rxQueue["dropped"] = espnowMgr.getRxQueueDropped();
+  rxQueue["last_rssi"] = espnowMgr.getLastRxRssi();
+
+  const MeshIngressStats& mi = meshIngress.getStats();
+  JsonObject ingress = doc["ingress"].to<JsonObject>();
+  ingress["policy"] = meshOverflowPolicyName(meshIngress.getPolicy());
+  ingress["depth"] = meshIngress.size();
+  ingress["capacity"] = meshIngress.capacity();
+  ingress["high_water"] = mi.highWater;
+  ingress["enqueued"] = mi.enqueued;
+  ingress["delivered"] = mi.delivered;
+  ingress["dropped_newest"] = mi.droppedNewest;
+  ingress["dropped_oldest"] = mi.droppedOldest;
+  ingress["coalesced"] = mi.coalesced;
+  JsonArray occupancy = ingress["occupancy_hist"].to<JsonArray>();
+  for (int i = 0; i < MESH_INGRESS_OCC_BUCKETS; i++) occupancy.add(mi.occupancy[i]);
+  JsonArray latency = ingress["latency_hist"].to<JsonArray>();
+  for (int i = 0; i < MESH_INGRESS_LAT_BUCKETS; i++) latency.add(mi.latency[i]);
+  ingress["max_latency_ms"] = mi.maxLatencyMs;
+
+  JsonObject rx = doc["rx_callback"].to<JsonObject>();
+  rx["count"] = espnowMgr.getRxCallbackCount();
+  rx["avg_us"] = espnowMgr.getRxCallbackAvgUs();
+  rx["max_us"] = espnowMgr.getRxCallbackMaxUs();
 
   String output;
   serializeJson(doc, output);
@@ -0,0 +1,56 @@
+#include <time.h>
+#include "grafanaBatch.h"
+#include "createGrafanaMessage.h"
+#include "sendDataGrafana.h"
+#include "offlineStore.h"
+
+GrafanaBatch::GrafanaBatch() : writer(body, sizeof(body)) {}
+
+void GrafanaBatch::append(const char* fields, float temperature, float humidity, float co2,
+                          const char* sensorId, const char* deviceId, unsigned long long timestamp) {
+  for (int attempt = 0; attempt < 2; attempt++) {
+    bool ok = fields ? appendGrafanaLine(writer, fields, sensorId, deviceId, timestamp)
+                     : appendGrafanaLine(writer, temperature, humidity, co2, sensorId, deviceId, timestamp);
+    if (ok) return;
+
+    // Sin lugar: enviar lo acumulado antes de seguir
+    if (!writer.overflowed() || writer.lineCount() == 0) break;
+    flush();
+  }
+  Serial.printf("[GRAFANA] ✗ Línea de %s descartada (sin campos o demasiado larga)\n", sensorId);
+}
+
+void GrafanaBatch::add(const char* message, const char* sensorId, const char* deviceId) {
+  append(message, 0, 0, 0, sensorId, deviceId, time(nullptr) * 1000000000ULL);
+}
+
+void GrafanaBatch::add(const char* message, const char* sensorId, const char* deviceId, unsigned long long timestamp) {
+  append(message, 0, 0, 0, sensorId, deviceId, timestamp);
+}
+
+void GrafanaBatch::add(float temperature, float humidity, float co2, const char* sensorId, const char* deviceId) {
+  append(nullptr, temperature, humidity, co2, sensorId, deviceId, time(nullptr) * 1000000000ULL);
+}
+
+bool GrafanaBatch::flush() {
+  size_t lines = writer.lineCount();
+  if (lines == 0) {
+    writer.clear();
+    return true;
+  }
+
+  Serial.printf("[GRAFANA] Enviando lote de %u línea%s (%u bytes)\n",
+                (unsigned)lines, lines != 1 ? "s" : "", (unsigned)writer.length());
+
+  int code = sendBatchGrafana(writer.c_str(), writer.length());
+  bool ok = (code == 204);
+
+  // Sin enlace o error del servidor: guardar en flash para reenviar después.
+  // Un 4xx indica datos inválidos, reintentarlos no serviría.
+  if (!ok && (code <= 0 || code >= 500)) {
+    offlineStore.append(writer.c_str(), writer.length());
+  }
+
+  writer.clear();
+  return ok;
+}
@@ -12,10 +12,15 @@
 #include <ArduinoJson.h>
 #include "sendDataGrafana.h"
 #include "createGrafanaMessage.h"
+#include "uplinkQueue.h"
+#include "uplinkSession.h"
+#include "offlineStore.h"
+#include "TaskScheduler.h"
 #include "constants.h"
 #include "globals.h"
 #include "endpoints.h"
 #include "configFile.h"
+#include "deviceIdentity.h"
 #include "otaUpdater.h"
 
 #ifdef SENSOR_MULTI
@@ -27,35 +32,47 @@
   #include "sensors/SensorFactory.h"
 #endif
 
+#if defined(SENSOR_MULTI) || defined(SENSOR_TYPE_CAPACITIVE)
+  // Barrido ADC compartido por los sensores analógicos (SensorCapacitive, HD38Sensor)
+  AdcScanner adcScanner;
+#endif
+
 #ifdef ENABLE_RS485
   #include "RS485Manager.h"
   RS485Manager rs485;
 #endif
 
+#if defined(ENABLE_RS485) && (defined(SENSOR_MULTI) || defined(SENSOR_TYPE_MODBUS_TH))
+  #define USE_MODBUS_BUS
+  // Bus Modbus compartido por los sensores RS485 (ModbusSensor)
+  ModbusBusPoller modbusBus;
+#endif
+
 #ifdef ENABLE_ESPNOW
   #include "ESPNowManager.h"
+  #include "MeshIngressQueue.h"
+  #include "SleepSchedule.h"
+  #include <esp_sleep.h>
   ESPNowManager espnowMgr;
+
+  // Sensor a batería (espnow_deep_sleep): estado que sobrevive al deep sleep
+  RTC_DATA_ATTR EspNowResumeState espnowResume;
+  RTC_DATA_ATTR SleepSchedule sleepSchedule;
+  #ifdef SENSOR_MULTI
+    RTC_DATA_ATTR DeadbandMemory deadbandMemory;
+  #endif
+  uint32_t sleepPeriodMs = 0;  // send_interval_ms; 0 = siempre despierto
 #endif
 
-unsigned long lastUpdateCheck = 0;
-unsigned long lastSendTime = 0;
+// Planificador cooperativo: sensores, envío, malla, OTA y web
+TaskScheduler scheduler;
+void setupScheduler();
+void publishReading(ISensor* s);
+void publishMeasurements(ISensor* s, const MeasurementSet& m);
 
 #ifdef ENABLE_ESPNOW
-// Mesh data buffer structure to avoid HTTP calls from WiFi interrupt context
-struct MeshDataBuffer {
-  uint8_t senderMAC[6];
-  char sensorId[32] ;
-  float temp;
-  float hum;
-  float co2;
-  uint32_t seq;
-  bool valid;
-};
-
-const int MESH_BUFFER_SIZE = 10;
-MeshDataBuffer meshBuffer[MESH_BUFFER_SIZE];
-volatile int meshBufferHead = 0;
-volatile int meshBufferTail = 0;
+// Mesh readings handed from the ESP-NOW receive task to the main loop
+MeshIngressQueue meshIngress;
 #endif
 
 #ifndef UNIT_TEST
@@ -63,38 +80,16 @@ volatile int meshBufferTail = 0;
 #ifdef ENABLE_ESPNOW
 
 // Callback to enqueue mesh data (gateway only)
-// IMPORTANT: Runs in WiFi interrupt context - must not call HTTP/blocking functions
-void onMeshDataReceived(const uint8_t* senderMAC, float temp, float hum, float co2, uint32_t seq, const char* sensorId) {
-  // Calculate next buffer position
-  int nextHead = (meshBufferHead + 1) % MESH_BUFFER_SIZE;
-  Serial.println(".");
-
-  // Check if buffer is full
-  if (nextHead == meshBufferTail) {
-    Serial.println("[MESH] ✗ Buffer full, dropping data");
-    return;
-  }
- Serial.println(".");
-  // Store data in buffer
-  memcpy(meshBuffer[meshBufferHead].senderMAC, senderMAC, 6);
-
-  if (sensorId != nullptr) {
-    strncpy(meshBuffer[meshBufferHead].sensorId, sensorId, sizeof(meshBuffer[meshBufferHead].sensorId) - 1);
-    meshBuffer[meshBufferHead].sensorId[sizeof(meshBuffer[meshBufferHead].sensorId) - 1] = '\0';
-  } else {
-    strcpy(meshBuffer[meshBufferHead].sensorId, "unknown");
-  }  
-  meshBuffer[meshBufferHead].temp = temp;
-  meshBuffer[meshBufferHead].hum = hum;
-  meshBuffer[meshBufferHead].co2 = co2;
-  meshBuffer[meshBufferHead].seq = seq;
-  meshBuffer[meshBufferHead].valid = true;
- Serial.println(".");
-  // Update head pointer (atomic for single-writer scenario)
-  meshBufferHead = nextHead;
- Serial.println(".");
-  //Serial.printf("[ESP-NOW] Data buffered from sensor %d (seq=%lu)\n",
-               // senderMAC[5], seq);
+// Runs on the ESP-NOW receive task: no HTTP, no logging, never blocks
+void onMeshDataReceived(const uint8_t* originatorMAC, const char* sensorId, const char* fields,
+                        uint32_t seq, uint16_t ageS) {
+  MeshReading reading;
+  memcpy(reading.originatorMAC, originatorMAC, 6);
+  strlcpy(reading.sensorId, sensorId ? sensorId : "unknown", sizeof(reading.sensorId));
+  strlcpy(reading.fields, fields, sizeof(reading.fields));
+  reading.seq = seq;
+  reading.ageS = ageS;
+  meshIngress.push(reading, millis());  // Overflow handled by mesh_queue_policy
 }
 
 String detectRole() {
@@ -127,6 +122,126 @@ String detectRole() {
     return "sensor";
   }
 }
+
+// Parámetros de la malla, iguales en el arranque normal y al despertar del deep sleep
+void configureESPNow(JsonDocument& config) {
+  espnowMgr.setDedupCapacity(config["espnow_dedup_capacity"] | MESH_DEDUP_DEFAULT_CAPACITY);
+  espnowMgr.setMaxPeers(config["espnow_max_peers"] | PEER_REGISTRY_DEFAULT_CAPACITY);
+  espnowMgr.setBeaconTiming(config["beacon_interval_ms"] | TRICKLE_DEFAULT_IMIN_MS,
+                            config["beacon_interval_max_ms"] | TRICKLE_DEFAULT_IMAX_MS,
+                            config["beacon_redundancy_k"] | TRICKLE_DEFAULT_K);
+  espnowMgr.setAggregateCycles(config["espnow_aggregate_cycles"] | 1);
+  espnowMgr.setRouting(config["espnow_routing"] | true);
+  espnowMgr.setDiscoveryTimeout(config["discovery_timeout_ms"] | 15000);
+}
+
+// Guarda el estado de la malla en RTC y duerme hasta el próximo período (no vuelve)
+void enterDeepSleep() {
+  sleepSchedule.saveMesh(espnowMgr, espnowResume);
+  #ifdef SENSOR_MULTI
+    sensorMgr.saveDeadbands(deadbandMemory);
+  #endif
+  uint32_t awakeMs = millis();
+  uint32_t sleepMs = sleepSchedule.sleepMs(sleepPeriodMs, awakeMs);
+  sleepSchedule.onSleep(awakeMs, sleepMs);
+
+  Serial.printf("[→ INFO] Deep sleep por %lu ms (despierto %lu ms)\n",
+                (unsigned long)sleepMs, (unsigned long)awakeMs);
+  Serial.flush();
+  esp_sleep_enable_timer_wakeup((uint64_t)sleepMs * 1000ULL);
+  esp_deep_sleep_start();
+}
+
+// Lee todos los sensores una vez; las lecturas en dos fases (Modbus, OneWire) se esperan un tiempo acotado
+void sampleAllSensors() {
+  uint32_t start = millis();
+  #ifdef SENSOR_MULTI
+    for (auto* s : sensorMgr.readDue(start)) {
+      publishReading(s);
+    }
+    while (sensorMgr.hasPendingReads() && millis() - start < SLEEP_PENDING_READ_MS) {
+      #ifdef USE_MODBUS_BUS
+        modbusBus.poll();
+      #endif
+      delay(1);
+      for (auto* s : sensorMgr.readDue(millis())) {
+        publishReading(s);
+      }
+    }
+  #else
+    if (!sensor || !sensor->isActive()) return;
+    if (sensor->requestRead()) {
+      while (sensor->readPending() && millis() - start < SLEEP_PENDING_READ_MS) {
+        #ifdef USE_MODBUS_BUS
+          modbusBus.poll();
+        #endif
+        delay(1);
+      }
+    }
+    if (sensor->dataReady() && sensor->read()) {
+      publishReading(sensor);
+    }
+  #endif
+}
+
+/**
+ * Despertar del deep sleep (sensor a batería): sin WiFi Manager, servidor
+ * web, NTP ni detección de rol. Restaura el emparejamiento desde RTC, mide,
+ * envía una trama con ACK del peer y vuelve a dormir. No vuelve.
+ */
+void runSleepCycle() {
+  sleepSchedule.onWake();
+  deviceIdentity.begin();
+
+  if (!SPIFFS.begin(false)) {
+    Serial.println("[✗ ERR ] No se pudo montar SPIFFS");
+    enterDeepSleep();  // Con el último send_interval_ms (sleepPeriodMs todavía es 0)
+  }
+  JsonDocument config = loadConfig();
+  sleepPeriodMs = config["send_interval_ms"] | 30000;
+  sleepSchedule.lastPeriodMs = sleepPeriodMs;
+
+  #ifdef SENSOR_MULTI
+    sensorMgr.loadFromConfig(config);
+    sensorMgr.setReportWindows(false);  // Una lectura por despertar
+    sensorMgr.restoreDeadbands(deadbandMemory);
+  #else
+    sensor = SensorFactory::createSensor();
+    if (sensor) sensor->init();
+  #endif
+
+  WiFi.mode(WIFI_STA);
+  configureESPNow(config);
+  espnowMgr.setAggregateCycles(1);  // Una trama por despertar
+  espnowMgr.setDutyCycled(true);
+  if (!espnowMgr.init("sensor", espnowResume.channel)) {
+    enterDeepSleep();  // Sin restaurar la malla: espnowResume queda como estaba
+  }
+
+  // Varios envíos sin ACK: el peer guardado ya no está, buscar gateway otra vez
+  if (sleepSchedule.needsDiscovery()) espnowResume.paired = false;
+  espnowMgr.restoreResumeState(espnowResume);
+  sleepSchedule.onMeshRestored();
+  if (!espnowMgr.isPaired()) espnowMgr.waitForDiscovery();
+
+  sampleAllSensors();
+  if (espnowMgr.isPaired() && sleepSchedule.lastAwakeMs > 0) {
+    // Consumo del despertar anterior, como sensor "power" del nodo
+    MeasurementSet power;
+    power.addNamed("boot_ms", sleepSchedule.lastBootToSendMs, 0, millis());
+    power.addNamed("awake_ms", sleepSchedule.lastAwakeMs, 0, millis());
+    espnowMgr.queueReading("power", power);
+  }
+  bool acked = espnowMgr.flushReadings();
+  sleepSchedule.onSend(acked, millis());
+  if (acked) {
+    Serial.printf("[✓ OK  ] Arranque→envío: %lu ms (promedio %lu, máx %lu)\n",
+                  (unsigned long)sleepSchedule.lastBootToSendMs,
+                  (unsigned long)sleepSchedule.avgBootToSendMs(),
+                  (unsigned long)sleepSchedule.maxBootToSendMs);
+  }
+  enterDeepSleep();
+}
 #endif
 
 void printBanner() {
@@ -146,9 +261,18 @@ void printBanner() {
 
 void setup() {
   Serial.begin(115200);
+
+  #ifdef ENABLE_ESPNOW
+    // Despertó del deep sleep: medir, enviar y volver a dormir lo antes posible
+    if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_TIMER && sleepSchedule.isValid()) {
+      runSleepCycle();
+    }
+  #endif
+
   delay(500);  // Esperar estabilización serial
 
   printBanner();
+  deviceIdentity.begin();
 
   Serial.println("[→ INFO] Iniciando sistema...");
   configTime(0, 0, "pool.ntp.org", "time.nist.gov");
@@ -161,6 +285,7 @@ void setup() {
     Serial.println("[✗ ERR ] No se pudo montar SPIFFS");
   } else {
     Serial.println("[✓ OK  ] SPIFFS montado correctamente");
+    offlineStore.begin();
   }
 
   createConfigFile();
@@ -213,6 +338,7 @@ void setup() {
   #ifdef ENABLE_ESPNOW
     server.on("/espnow/status", HTTP_GET, handleESPNowStatus);
   #endif
+  server.on("/uplink/status", HTTP_GET, handleUplinkStatus);
 
   // Serve favicon from SPIFFS
   server.on("/favicon.svg", HTTP_GET, []() {
@@ -288,6 +414,15 @@ void setup() {
         }
       }
 
+      configureESPNow(espnowConfigDoc);
+
+      MeshOverflowPolicy meshPolicy = MESH_DROP_OLDEST;
+      const char* policyName = espnowConfigDoc["mesh_queue_policy"] | "drop_oldest";
+      if (!parseMeshOverflowPolicy(policyName, meshPolicy)) {
+        Serial.printf("[⚠ WARN] mesh_queue_policy inválida '%s', usando drop_oldest\n", policyName);
+      }
+      meshIngress.begin(espnowConfigDoc["mesh_queue_depth"] | MESH_INGRESS_DEFAULT_DEPTH, meshPolicy);
+
       if (espnowMgr.init(espnowMode, espnowChannel)) {
         Serial.println("[✓ OK  ] ESP-NOW inicializado");
 
@@ -299,6 +434,18 @@ void setup() {
           } else {
             Serial.println("[⚠ WARN] Gateway no encontrado (reintentará automáticamente)");
           }
+
+          // Sensor a batería: portal y web durante SLEEP_SETUP_WINDOW_MS, después ciclos de deep sleep
+          if (espnowConfigDoc["espnow_deep_sleep"] | false) {
+            sleepPeriodMs = espnowConfigDoc["send_interval_ms"] | 30000;
+            sleepSchedule.begin();
+            sleepSchedule.lastPeriodMs = sleepPeriodMs;
+            #ifdef SENSOR_MULTI
+              deadbandMemory.clear();
+            #endif
+            Serial.printf("[→ INFO] Deep sleep en %lu s, luego despierta cada %lu ms\n",
+                          (unsigned long)(SLEEP_SETUP_WINDOW_MS / 1000), (unsigned long)sleepPeriodMs);
+          }
         } else {
           // Gateway mode: register mesh data callback and start beacon
           espnowMgr.setMeshDataCallback(onMeshDataReceived);
@@ -315,6 +462,13 @@ void setup() {
   server.begin();
   Serial.println("[✓ OK  ] Servidor web iniciado en puerto 80");
 
+  // Tarea de envío a Grafana (core 0)
+  JsonDocument uplinkConfig = loadConfig();
+  uplinkQueue.begin(uplinkConfig["uplink_queue_depth"] | UPLINK_QUEUE_DEFAULT_DEPTH,
+                    uplinkConfig["upload_interval_ms"] | DEFAULT_UPLOAD_INTERVAL_MS);
+
+  setupScheduler();
+
   Serial.println("\n━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
   Serial.println("  SISTEMA LISTO");
   Serial.println("━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━━");
@@ -326,131 +480,231 @@ void setup() {
 
 }
 
-void loop() {
+// ─── Tareas del planificador ───────────────────────────────────────────────
+
+void taskWiFi() {
   wifiManager.update();
-  static unsigned long lastStatusPrint = 0;
-  if (millis() - lastStatusPrint > 30000) {  // Print status every 30 seconds
-      lastStatusPrint = millis();
+}
 
-      if (wifiManager.isOnline()) {
-          Serial.println("WiFi Status: Connected to " + wifiManager.getCurrentSSID());
-          Serial.println("IP Address: " + wifiManager.getLocalIP().toString());
-      } else {
-          Serial.println("WiFi Status: Disconnected - AP available at " + wifiManager.getAPSSID());
-      }
-  }
+void taskWeb() {
   server.handleClient();
+}
 
-  #ifdef ENABLE_ESPNOW
-    // Update ESP-NOW (beacon broadcast for gateway, retry discovery for sensor)
-    espnowMgr.update();
-
-    // Process buffered mesh data (gateway only)
-    // This runs in main loop context, safe for HTTP calls
-    while (meshBufferTail != meshBufferHead) {
-      MeshDataBuffer* data = &meshBuffer[meshBufferTail];
-      Serial.printf("[MESH→GRAFANA] Processing buffered data from %02X:%02X:%02X:%02X:%02X:%02X (seq=%lu)\n",
-                 data->senderMAC[0], data->senderMAC[1], data->senderMAC[2], data->senderMAC[3], data->senderMAC[4], data->senderMAC[5], data->seq);
-      if (data->valid) {
-        char deviceid[32];
-        snprintf(deviceid, sizeof(deviceid), "moni-%02X%02X%02X%02X%02X%02X",
-                 data->senderMAC[0], data->senderMAC[1], data->senderMAC[2], data->senderMAC[3], data->senderMAC[4], data->senderMAC[5]);
-
-        Serial.printf("[MESH→GRAFANA] %s: T=%.1f H=%.1f CO2=%.0f (seq=%lu)\n",
-                      deviceid, data->temp, data->hum, data->co2, data->seq);
-
-        // Now safe to make HTTP call from main loop
-        sendDataGrafana(data->temp, data->hum, data->co2, data->sensorId, deviceid);
-
-        data->valid = false;  // Mark as processed
-      }
-
-      // Move to next buffer entry
-      meshBufferTail = (meshBufferTail + 1) % MESH_BUFFER_SIZE;
+void taskStatus() {
+  if (wifiManager.isOnline()) {
+      Serial.println("WiFi Status: Connected to " + wifiManager.getCurrentSSID());
+      Serial.println("IP Address: " + wifiManager.getLocalIP().toString());
+  } else {
+      Serial.println("WiFi Status: Disconnected - AP available at " + wifiManager.getAPSSID());
+  }
+  Serial.printf("Uplink: %lu handshakes, %lu evitados, %lu reconexiones, %lu fallos\n",
+                (unsigned long)uplinkSession.getHandshakes(), (unsigned long)uplinkSession.getHandshakesAvoided(),
+                (unsigned long)uplinkSession.getReconnects(), (unsigned long)uplinkSession.getFailures());
+  Serial.printf("Uplink queue: %u/%u (máx %u), %lu descartados, heap libre %d bytes\n",
+                uplinkQueue.getDepth(), uplinkQueue.getCapacity(), uplinkQueue.getHighWater(),
+                (unsigned long)uplinkQueue.getDropped(), ESP.getFreeHeap());
+
+  #ifdef USE_MODBUS_BUS
+    for (int i = 0; i < modbusBus.getSlotCount(); i++) {
+      const ModbusBusPoller::Slot* b = modbusBus.getSlot(i);
+      Serial.printf("  [modbus %3d] req=%lu ok=%lu timeouts=%lu errores=%lu omitidas=%lu latencia=%lums timeout=%lums\n",
+                    b->address, (unsigned long)b->requests, (unsigned long)b->responses,
+                    (unsigned long)b->timeouts, (unsigned long)b->errors, (unsigned long)b->skipped,
+                    (unsigned long)b->health.getLatencyMs(), (unsigned long)b->health.timeoutMs());
     }
   #endif
 
-  unsigned long currentMillis = millis();
+  // Contabilidad de tiempo de ejecución por tarea
+  for (int i = 0; i < scheduler.getTaskCount(); i++) {
+    const TaskScheduler::Task& t = scheduler.getTask(i);
+    if (t.runs == 0) continue;
+    Serial.printf("  [%-8s] runs=%lu avg=%luus max=%luus overruns=%lu late=%lums\n",
+                  t.name, (unsigned long)t.runs, (unsigned long)(t.totalRunUs / t.runs),
+                  (unsigned long)t.maxRunUs, (unsigned long)t.overruns, (unsigned long)t.maxLatenessMs);
+  }
+}
+
+#ifdef ENABLE_ESPNOW
+void taskESPNow() {
+  // Update ESP-NOW (beacon broadcast for gateway, retry discovery for sensor)
+  espnowMgr.update();
+}
+
+void taskMeshDrain() {
+  // Process buffered mesh data (gateway only)
+  // This runs in main loop context, safe for HTTP calls
+  MeshReading data;
+  while (meshIngress.pop(data, millis())) {
+    char deviceid[18];
+    formatDeviceName(deviceid, data.originatorMAC);
 
-  //// 1. Verificamos si hay que chequear actualizaciones
-  if (currentMillis - lastUpdateCheck >= UPDATE_INTERVAL) {
-    Serial.printf("Free heap before checking: %d bytes\n", ESP.getFreeHeap());
-    checkForUpdates();
-    Serial.printf("Free heap after checking: %d bytes\n", ESP.getFreeHeap());
-    lastUpdateCheck = currentMillis;
+    Serial.printf("[MESH→GRAFANA] %s/%s: %s (seq=%lu)\n",
+                  deviceid, data.sensorId, data.fields, (unsigned long)data.seq);
+
+    // Queued for the uplink task (batched POST)
+    uplinkQueue.enqueue(data.fields, data.sensorId, deviceid, data.ageS);
   }
+}
 
-  //// 2. Enviamos datos a Grafana cada 10 segundos
-  if (currentMillis - lastSendTime >= 10000) {
-    lastSendTime = currentMillis;
+void taskSleep() {
+  // Fin de la ventana de configuración tras un arranque en frío (sensor a batería)
+  espnowMgr.setDutyCycled(true);
+  espnowMgr.flushReadings();  // Trama todavía abierta (espnow_aggregate_cycles), con ACK
+  enterDeepSleep();
+}
 
-    #ifdef SENSOR_MULTI
-      // Modo multi-sensor: leer y enviar todos los sensores
-      sensorMgr.readAll();
+void taskMeshStats() {
+  // Entrega por originador a Grafana, como sensor "mesh" de cada nodo (gateway only)
+  if (espnowMgr.getMode() != "gateway") return;
+  const MeshSeqTracker& tracker = espnowMgr.getSeqTracker();
+  for (int i = 0; i < tracker.slots(); i++) {
+    const MeshOriginatorStats* p = tracker.entry(i);
+    if (!p) continue;
+    MeshOriginatorStats e = *p;  // Copia: rxTask la sigue actualizando
+    char deviceid[18];
+    formatDeviceName(deviceid, e.mac);
+
+    char fields[UPLINK_FIELDS_LEN];
+    snprintf(fields, sizeof(fields), "pdr=%.3f,lost=%lu,reorder=%lu,reboots=%u,lat_avg=%lu,lat_max=%lu",
+             MeshSeqTracker::deliveryPermille(e) / 1000.0, (unsigned long)e.lost,
+             (unsigned long)e.reordered, e.reboots,
+             (unsigned long)e.latencyAvgMs, (unsigned long)e.latencyMaxMs);
+    uplinkQueue.enqueue(fields, "mesh", deviceid);
+  }
+}
+#endif
 
-      Serial.printf("Free heap before sending: %d bytes\n", ESP.getFreeHeap());
+#ifdef SENSOR_MULTI
+// Reloj de las bandas muertas: en un sensor a batería sigue corriendo durante el deep sleep
+uint32_t deadbandClockMs() {
+  #ifdef ENABLE_ESPNOW
+    if (sleepPeriodMs > 0) return sleepSchedule.clockMs(millis());
+  #endif
+  return millis();
+}
+#endif
 
-      for (auto* s : sensorMgr.getSensors()) {
-        if (s->isActive()) {
-          float temperature = s->getTemperature();
-          float humidity = s->getHumidity();
-          float co2 = s->getCO2();
+// Distribuir una lectura a Grafana (lote), RS485 y ESP-NOW
+void publishReading(ISensor* s) {
+  MeasurementSet m;
+  s->getMeasurements(m);
 
-          String sensorId = sensorMgr.getSensorId(s);
+  Serial.printf("[%s] Temp: %.1f°C, Hum: %.1f%%, CO2: %.0fppm\n",
+               s->getSensorID(), m.valueOr(MEAS_TEMP, -1), m.valueOr(MEAS_HUM, -1), m.valueOr(MEAS_CO2, -1));
 
-          Serial.printf("[%s] Temp: %.1f°C, Hum: %.1f%%, CO2: %.0fppm\n",
-                       s->getSensorID(), temperature, humidity, co2);
+  #ifdef SENSOR_MULTI
+    // Sensor con report_ms: la lectura va a la ventana y se publica su estadística al cerrarla.
+    // La ventana tiene precedencia sobre deadband (loadFromConfig avisa si están los dos)
+    bool windowed = sensorMgr.accumulate(s, m, millis());
+    if (!windowed) {
+      // Sensor con deadband: solo los campos que salieron de la banda (o con heartbeat vencido)
+      if (!sensorMgr.applyDeadband(s, m, deadbandClockMs())) return;
+    }
+  #endif
 
-          // Enviar a Grafana
-          sendDataGrafana(s->getMeasurementsString(), s->getSensorID());
+  #ifdef ENABLE_RS485
+    // Enviar por RS485
+    rs485.sendMeasurements(s->getSensorID(), m);
+  #endif
 
-          #ifdef ENABLE_RS485
-            // Enviar por RS485
-            rs485.sendSensorData(temperature, humidity, co2, s->getSensorID());
-          #endif
+  #ifdef SENSOR_MULTI
+    if (windowed) return;
+  #endif
+  publishMeasurements(s, m);
+}
 
-          #ifdef ENABLE_ESPNOW
-            // Enviar por ESP-NOW (solo si es sensor y está emparejado)
-            if (espnowMgr.getMode() == "sensor" && espnowMgr.isPaired()) {
-              espnowMgr.sendSensorData(temperature, humidity, co2, s->getSensorID());
-            }
-          #endif
-        }
-      }
+// Cada destino codifica desde los valores: line protocol para Grafana, trama binaria para ESP-NOW.
+// También publica las estadísticas de las ventanas de reporte (closeWindows).
+void publishMeasurements(ISensor* s, const MeasurementSet& m) {
+  // Tantos registros de uplink como hagan falta para que entren todos los campos
+  char fields[UPLINK_FIELDS_LEN];
+  uint8_t next = 0;
+  while (measurementsToFields(m, fields, sizeof(fields), next) > 0) {
+    uplinkQueue.enqueue(fields, s->getSensorID());
+  }
 
-      Serial.printf("Free heap after sending: %d bytes\n", ESP.getFreeHeap());
+  #ifdef ENABLE_ESPNOW
+    if (espnowMgr.getMode() == "sensor" && espnowMgr.isPaired()) {
+      espnowMgr.queueReading(s->getSensorID(), m);
+    }
+  #endif
+}
 
-    #else
-      // Modo single sensor (backward compatible)
-      float temperature = 99, humidity = 100, co2 = 999999;
+void taskSensors() {
+  #ifdef SENSOR_MULTI
+    // Ventanas de reporte vencidas (report_ms), antes de sumar lecturas nuevas
+    sensorMgr.closeWindows(millis(), publishMeasurements);
 
-      if (sensor && sensor->isActive() && sensor->dataReady()) {
-        if (sensor->read()) {
-          temperature = sensor->getTemperature();
-          humidity = sensor->getHumidity();
-          co2 = sensor->getCO2();
+    // Modo multi-sensor: leer solo los sensores cuyo período venció
+    for (auto* s : sensorMgr.readDue(millis())) {
+      publishReading(s);
+    }
+    #ifdef ENABLE_ESPNOW
+      espnowMgr.endCycle();  // Una trama con las lecturas del ciclo (o de varios)
+    #endif
+  #else
+    // Modo single sensor (backward compatible)
+    if (!sensor) return;
 
-          Serial.printf("[%s] Temp: %.1f°C, Hum: %.1f%%, CO2: %.0fppm\n",
-                       sensor->getSensorType(), temperature, humidity, co2);
-        } else {
-          Serial.println("Error leyendo el sensor!");
-          return;
-        }
-      } else {
-        Serial.println("Sensor no listo, esperando...");
+    if (sensor->isActive() && sensor->dataReady()) {
+      if (!sensor->read()) {
+        Serial.println("Error leyendo el sensor!");
+        return;
       }
+    } else {
+      Serial.println("Sensor no listo, esperando...");
+    }
+    publishReading(sensor);
+    #ifdef ENABLE_ESPNOW
+      espnowMgr.endCycle();
+    #endif
+    // Sensores en dos fases (Modbus): el resultado estará listo en el próximo ciclo
+    sensor->requestRead();
+  #endif
+}
+
+#ifdef USE_MODBUS_BUS
+void taskModbus() {
+  // Avanza la transacción en curso y despacha la siguiente (no bloquea)
+  modbusBus.poll();
+}
+#endif
 
-      Serial.printf("Free heap before sending: %d bytes\n", ESP.getFreeHeap());
-      sendDataGrafana(sensor->getMeasurementsString(), sensor->getSensorID());
-      Serial.printf("Free heap after sending: %d bytes\n", ESP.getFreeHeap());
+void taskOTA() {
+  Serial.printf("Free heap before checking: %d bytes\n", ESP.getFreeHeap());
+  checkForUpdates();
+  Serial.printf("Free heap after checking: %d bytes\n", ESP.getFreeHeap());
+}
 
-      #ifdef ENABLE_RS485
-        // También enviar datos por RS485
-        rs485.sendSensorData(temperature, humidity, co2, sensor ? sensor->getSensorType() : "Unknown");
-      #endif
-    #endif
-  }
-  delay(10);
+void setupScheduler() {
+  //                 nombre     callback        período           deadline(us)  retardo inicial
+  scheduler.addTask("wifi",     taskWiFi,       0,                20000);
+  scheduler.addTask("web",      taskWeb,        0,                50000);
+  #ifdef ENABLE_ESPNOW
+    scheduler.addTask("espnow", taskESPNow,     20,               5000);
+    scheduler.addTask("mesh",   taskMeshDrain,  100,              10000);
+    scheduler.addTask("meshstat", taskMeshStats, MESH_TRACK_REPORT_MS, 10000, MESH_TRACK_REPORT_MS);
+    if (sleepPeriodMs > 0) {
+      scheduler.addTask("sleep", taskSleep, SLEEP_SETUP_WINDOW_MS, 0, SLEEP_SETUP_WINDOW_MS);
+    }
+  #endif
+  #ifdef USE_MODBUS_BUS
+    scheduler.addTask("modbus",  taskModbus,    0,                5000);
+  #endif
+  #ifdef SENSOR_MULTI
+    scheduler.addTask("sensors", taskSensors,   SENSOR_POLL_INTERVAL_MS, 500000);
+  #else
+    scheduler.addTask("sensors", taskSensors,   DEFAULT_SENSOR_PERIOD_MS, 500000);
+  #endif
+  scheduler.addTask("ota",      taskOTA,        UPDATE_INTERVAL,  0,       UPDATE_INTERVAL);
+  scheduler.addTask("status",   taskStatus,     30000,            0,       30000);
+
+  Serial.printf("[✓ OK  ] Planificador: %d tareas\n", scheduler.getTaskCount());
+}
+
+void loop() {
+  scheduler.run();
+  delay(1);
 }
 
 #endif  // UNIT_TEST
\ No newline at end of file
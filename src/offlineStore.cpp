@@ -0,0 +1,205 @@
+#include <WiFi.h>
+#include <SPIFFS.h>
+#include <time.h>
+#include "offlineStore.h"
+#include "sendDataGrafana.h"
+
+OfflineStore offlineStore;
+
+// Timestamps menores a este valor (ns) se tomaron sin reloj NTP
+static const unsigned long long MIN_VALID_TIMESTAMP_NS = 1600000000ULL * 1000000000ULL;
+static const time_t MIN_VALID_EPOCH = 1600000000;
+
+static uint32_t currentSegmentBytes = 0;
+
+OfflineStore::OfflineStore()
+  : firstSegment(0), nextSegment(0), bootFirstSegment(0), readOffset(0),
+    pendingBytes(0), lastReplay(0), storedLines(0), replayedLines(0), droppedSegments(0) {}
+
+void OfflineStore::segmentPath(char* out, size_t size, uint32_t index) {
+  snprintf(out, size, OFFLINE_DIR "/%08lu.log", (unsigned long)index);
+}
+
+void OfflineStore::saveMeta() {
+  File meta = SPIFFS.open(OFFLINE_META_PATH, FILE_WRITE);
+  if (!meta) {
+    Serial.println("[OFFLINE] ✗ No se pudo escribir meta");
+    return;
+  }
+  meta.printf("%lu %lu\n", (unsigned long)firstSegment, (unsigned long)nextSegment);
+  meta.close();
+}
+
+void OfflineStore::begin() {
+  File meta = SPIFFS.open(OFFLINE_META_PATH, FILE_READ);
+  if (meta) {
+    firstSegment = meta.parseInt();
+    nextSegment = meta.parseInt();
+    meta.close();
+    if (nextSegment < firstSegment) nextSegment = firstSegment;
+  }
+
+  // Saltar segmentos que ya no existen y sumar lo pendiente
+  char path[32];
+  pendingBytes = 0;
+  for (uint32_t i = firstSegment; i < nextSegment; i++) {
+    segmentPath(path, sizeof(path), i);
+    File f = SPIFFS.open(path, FILE_READ);
+    if (!f) {
+      if (i == firstSegment) firstSegment++;
+      continue;
+    }
+    pendingBytes += f.size();
+    f.close();
+  }
+
+  // Las escrituras de este arranque van siempre a segmentos nuevos
+  bootFirstSegment = nextSegment;
+  currentSegmentBytes = 0;
+  readOffset = 0;
+
+  if (hasPending()) {
+    Serial.printf("[OFFLINE] %lu bytes pendientes en %lu segmento(s)\n",
+                  (unsigned long)pendingBytes, (unsigned long)(nextSegment - firstSegment));
+  }
+}
+
+void OfflineStore::dropOldest() {
+  char path[32];
+  segmentPath(path, sizeof(path), firstSegment);
+
+  File f = SPIFFS.open(path, FILE_READ);
+  if (f) {
+    uint32_t size = f.size();
+    f.close();
+    pendingBytes -= min(pendingBytes, size - min(size, readOffset));
+  }
+  SPIFFS.remove(path);
+
+  Serial.printf("[OFFLINE] ⚠ Log lleno, descartando segmento %lu\n", (unsigned long)firstSegment);
+  firstSegment++;
+  readOffset = 0;
+  droppedSegments++;
+  saveMeta();
+}
+
+bool OfflineStore::append(const char* body, size_t length) {
+  if (length == 0) return true;
+
+  // Abrir un segmento nuevo si no hay uno de este arranque o si no entra
+  bool needNew = (nextSegment == firstSegment) ||
+                 (nextSegment - 1 < bootFirstSegment) ||
+                 (currentSegmentBytes + length + 1 > OFFLINE_SEGMENT_MAX_BYTES);
+  if (needNew) {
+    nextSegment++;
+    currentSegmentBytes = 0;
+    saveMeta();
+  }
+
+  // Respetar los límites de cantidad de segmentos y de uso de SPIFFS
+  while (nextSegment - firstSegment > 1 &&
+         (nextSegment - firstSegment > OFFLINE_MAX_SEGMENTS ||
+          SPIFFS.usedBytes() + length > SPIFFS.totalBytes() * OFFLINE_MAX_FS_USAGE)) {
+    dropOldest();
+  }
+
+  char path[32];
+  segmentPath(path, sizeof(path), nextSegment - 1);
+  File f = SPIFFS.open(path, FILE_APPEND);
+  if (!f) {
+    Serial.println("[OFFLINE] ✗ No se pudo abrir el segmento");
+    return false;
+  }
+  size_t written = f.write((const uint8_t*)body, length);
+  written += f.print('\n');
+  f.close();
+
+  currentSegmentBytes += written;
+  pendingBytes += written;
+
+  uint32_t lines = 1;
+  for (size_t i = 0; i < length; i++) {
+    if (body[i] == '\n') lines++;
+  }
+  storedLines += lines;
+
+  Serial.printf("[OFFLINE] %lu línea(s) guardadas (%lu bytes pendientes)\n",
+                (unsigned long)lines, (unsigned long)pendingBytes);
+  return written == length + 1;
+}
+
+bool OfflineStore::fixTimestamp(String& line, bool sameBoot) {
+  int space = line.lastIndexOf(' ');
+  if (space < 0) return false;
+
+  unsigned long long ts = strtoull(line.c_str() + space + 1, nullptr, 10);
+  if (ts == 0) return false;                       // Línea truncada
+  if (ts >= MIN_VALID_TIMESTAMP_NS) return true;   // Ya tenía hora NTP
+  if (!sameBoot) return false;                     // Uptime de otro arranque: irrecuperable
+
+  // Sin NTP el reloj arranca en 0: el timestamp es el uptime de la muestra
+  unsigned long long bootEpochNs = (unsigned long long)(time(nullptr) - millis() / 1000) * 1000000000ULL;
+  line = line.substring(0, space + 1) + String(bootEpochNs + ts);
+  return true;
+}
+
+bool OfflineStore::replay() {
+  if (!hasPending()) return false;
+  if (millis() - lastReplay < OFFLINE_REPLAY_INTERVAL) return false;
+  if (WiFi.status() != WL_CONNECTED) return false;
+  if (time(nullptr) < MIN_VALID_EPOCH) return false;  // Esperar NTP para corregir timestamps
+  lastReplay = millis();
+
+  char path[32];
+  segmentPath(path, sizeof(path), firstSegment);
+  File f = SPIFFS.open(path, FILE_READ);
+  if (!f) {
+    firstSegment++;
+    readOffset = 0;
+    saveMeta();
+    return false;
+  }
+
+  f.seek(readOffset);
+  bool sameBoot = firstSegment >= bootFirstSegment;
+
+  String body;
+  body.reserve(OFFLINE_REPLAY_CHUNK + 128);
+  uint32_t consumed = 0;
+  uint32_t lines = 0;
+
+  while (f.available() && body.length() < OFFLINE_REPLAY_CHUNK) {
+    String line = f.readStringUntil('\n');
+    consumed += line.length() + 1;
+    if (line.length() == 0 || !fixTimestamp(line, sameBoot)) continue;
+
+    if (lines > 0) body += '\n';
+    body += line;
+    lines++;
+  }
+  bool finished = !f.available();
+  f.close();
+
+  if (lines > 0) {
+    Serial.printf("[OFFLINE] Reenviando %lu línea(s) del segmento %lu\n",
+                  (unsigned long)lines, (unsigned long)firstSegment);
+    int code = sendBatchGrafana(body);
+    if (code != 204 && (code <= 0 || code >= 500)) {
+      return false;  // Reintentar el mismo bloque más tarde
+    }
+    // 4xx: datos rechazados por el servidor, no tiene sentido reintentar
+  }
+
+  readOffset += consumed;
+  pendingBytes -= min(pendingBytes, consumed);
+  replayedLines += lines;
+
+  if (finished) {
+    SPIFFS.remove(path);
+    firstSegment++;
+    readOffset = 0;
+    if (firstSegment == nextSegment) currentSegmentBytes = 0;
+    saveMeta();
+  }
+  return lines > 0;
+}
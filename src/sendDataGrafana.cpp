@@ -6,63 +6,54 @@
 #include "globals.h"
 #include "sendDataGrafana.h"
 #include "createGrafanaMessage.h"
+#include "uplinkSession.h"
 
 
 
-void sendDataGrafana(float temperature, float humidity, float co2, const char* sensorId, const char* deviceId)  {
-    if (WiFi.status() == WL_CONNECTED) {
-        HTTPClient localHttp;
-
-        localHttp.begin(client, URL);
-        localHttp.setTimeout(5000); // Timeout de 5 segundos
-        localHttp.addHeader("Content-Type", "text/plain");
-        localHttp.addHeader("Authorization", "Basic " + String(TOKEN_GRAFANA));
-
-        String data = create_grafana_message(temperature, humidity, co2, sensorId, deviceId);
-
-        // Debug: mostrar datos que se envían
-        Serial.println("Enviando a Grafana:");
-        Serial.println(data);
+// POST de un cuerpo en line protocol (una o varias líneas separadas por '\n')
+// usando la sesión keep-alive compartida. Devuelve el código HTTP (0 sin WiFi)
+static int postToGrafana(const char* data, size_t length) {
+    if (WiFi.status() != WL_CONNECTED) {
+        Serial.println("Error en la conexión WiFi");
+        uplinkSession.close();
+        return 0;
+    }
 
-        int httpResponseCode = localHttp.POST(data);
-        if (httpResponseCode == 204) {
-            Serial.println("✓ Datos enviados correctamente");
-        } else {
-            Serial.printf("✗ Error en el envío: %d\n", httpResponseCode);
-            Serial.println(localHttp.getString());
-        }
+    // Debug: mostrar datos que se envían
+    Serial.println("Enviando a Grafana:");
+    Serial.println(data);
 
-        localHttp.end();  
+    int httpResponseCode = uplinkSession.post((const uint8_t*)data, length);
+    if (httpResponseCode == 204) {
+        Serial.println("✓ Datos enviados correctamente");
     } else {
-        Serial.println("Error en la conexión WiFi");
+        Serial.printf("✗ Error en el envío: %d\n", httpResponseCode);
     }
+    return httpResponseCode;
 }
-    void sendDataGrafana(const char* message, const char* sensorId, const char* deviceId) {
-    if (WiFi.status() == WL_CONNECTED) {
-        HTTPClient localHttp;
-
-        localHttp.begin(client, URL);
-        localHttp.setTimeout(5000); // Timeout de 5 segundos
-        localHttp.addHeader("Content-Type", "text/plain");
-        localHttp.addHeader("Authorization", "Basic " + String(TOKEN_GRAFANA));
-
-        String data = create_grafana_message(message, sensorId, deviceId);
-
-        // Debug: mostrar datos que se envían
-        Serial.println("Enviando a Grafana:");
-        Serial.println(data);
 
-        int httpResponseCode = localHttp.POST(data);
-        if (httpResponseCode == 204) {
-            Serial.println("✓ Datos enviados correctamente");
-        } else {
-            Serial.printf("✗ Error en el envío: %d\n", httpResponseCode);
-            Serial.println(localHttp.getString());
-        }
+void sendDataGrafana(float temperature, float humidity, float co2, const char* sensorId, const char* deviceId)  {
+    if (WiFi.status() != WL_CONNECTED) {
+        Serial.println("Error en la conexión WiFi");
+        return;
+    }
+    String data = create_grafana_message(temperature, humidity, co2, sensorId, deviceId);
+    postToGrafana(data.c_str(), data.length());
+}
 
-        localHttp.end();  
-    } else {
+void sendDataGrafana(const char* message, const char* sensorId, const char* deviceId) {
+    if (WiFi.status() != WL_CONNECTED) {
         Serial.println("Error en la conexión WiFi");
+        return;
     }
+    String data = create_grafana_message(message, sensorId, deviceId);
+    postToGrafana(data.c_str(), data.length());
+}
+
+int sendBatchGrafana(const String& body) {
+    return postToGrafana(body.c_str(), body.length());
+}
 
-}
\ No newline at end of file
+int sendBatchGrafana(const char* body, size_t length) {
+    return postToGrafana(body, length);
+}
@@ -0,0 +1,109 @@
+#include <time.h>
+#include "uplinkQueue.h"
+#include "grafanaBatch.h"
+#include "offlineStore.h"
+
+UplinkQueue uplinkQueue;
+
+UplinkQueue::UplinkQueue()
+  : queue(nullptr), task(nullptr), capacity(0), uploadInterval(10000),
+    highWater(0), enqueued(0), dropped(0),
+    sentLines(0), batches(0), failedBatches(0), lastBatchMs(0) {}
+
+bool UplinkQueue::begin(uint16_t depth, uint32_t uploadIntervalMs) {
+  if (queue) return true;
+
+  capacity = constrain(depth, 1, UPLINK_QUEUE_MAX_DEPTH);
+  uploadInterval = uploadIntervalMs;
+
+  queue = xQueueCreate(capacity, sizeof(UplinkRecord));
+  if (!queue) {
+    Serial.println("[✗ ERR ] No se pudo crear la cola de envío");
+    return false;
+  }
+
+  BaseType_t ok = xTaskCreatePinnedToCore(taskEntry, "uplink", UPLINK_TASK_STACK, this,
+                                          UPLINK_TASK_PRIORITY, &task, UPLINK_TASK_CORE);
+  if (ok != pdPASS) {
+    Serial.println("[✗ ERR ] No se pudo crear la tarea de envío");
+    vQueueDelete(queue);
+    queue = nullptr;
+    return false;
+  }
+
+  Serial.printf("[✓ OK  ] Tarea de envío en core %d (cola de %u registros, envío cada %lu ms)\n",
+                UPLINK_TASK_CORE, capacity, (unsigned long)uploadInterval);
+  return true;
+}
+
+uint16_t UplinkQueue::getDepth() const {
+  return queue ? uxQueueMessagesWaiting(queue) : 0;
+}
+
+bool UplinkQueue::enqueue(const char* fields, const char* sensorId, const char* deviceId, uint32_t ageSeconds) {
+  if (!queue) return false;
+
+  UplinkRecord rec;
+  rec.timestamp = (uint32_t)time(nullptr);
+  if (ageSeconds < rec.timestamp) rec.timestamp -= ageSeconds;
+  strlcpy(rec.sensorId, sensorId ? sensorId : "unknown", sizeof(rec.sensorId));
+  strlcpy(rec.deviceId, deviceId ? deviceId : "", sizeof(rec.deviceId));
+  if (strlcpy(rec.fields, fields, sizeof(rec.fields)) >= sizeof(rec.fields)) {
+    // No cortar un campo a la mitad: descartar desde la última coma
+    char* lastComma = strrchr(rec.fields, ',');
+    if (lastComma) *lastComma = '\0';
+    Serial.printf("[UPLINK] ⚠ Campos de %s truncados\n", rec.sensorId);
+  }
+
+  if (xQueueSend(queue, &rec, 0) != pdTRUE) {
+    dropped++;
+    Serial.println("[UPLINK] ✗ Cola llena, descartando registro");
+    return false;
+  }
+
+  enqueued++;
+  uint16_t depthNow = capacity - uxQueueSpacesAvailable(queue);
+  if (depthNow > highWater) highWater = depthNow;
+  return true;
+}
+
+void UplinkQueue::taskEntry(void* param) {
+  static_cast<UplinkQueue*>(param)->run();
+}
+
+void UplinkQueue::run() {
+  static GrafanaBatch batch;  // Buffer de 4 KB: fuera del stack de la tarea
+  uint32_t lastFlush = millis();
+
+  for (;;) {
+    // Esperar registros hasta el próximo envío (o el próximo reenvío offline)
+    uint32_t elapsed = millis() - lastFlush;
+    uint32_t wait = elapsed >= uploadInterval ? 0 : uploadInterval - elapsed;
+    if (wait > OFFLINE_REPLAY_INTERVAL) wait = OFFLINE_REPLAY_INTERVAL;
+
+    UplinkRecord rec;
+    if (xQueueReceive(queue, &rec, pdMS_TO_TICKS(wait)) == pdTRUE) {
+      batch.add(rec.fields, rec.sensorId, rec.deviceId, (unsigned long long)rec.timestamp * 1000000000ULL);
+      continue;  // Vaciar la cola antes de decidir si enviar
+    }
+
+    if (millis() - lastFlush >= uploadInterval) {
+      lastFlush = millis();
+      size_t lines = batch.count();
+      if (lines > 0) {
+        uint32_t start = millis();
+        bool ok = batch.flush();
+        lastBatchMs = millis() - start;
+        batches++;
+        if (ok) {
+          sentLines += lines;
+        } else {
+          failedBatches++;
+        }
+      }
+    }
+
+    // Reenviar datos guardados offline (limitado para no frenar los datos en vivo)
+    offlineStore.replay();
+  }
+}
@@ -0,0 +1,85 @@
+#include "uplinkSession.h"
+#include "constants.h"
+
+UplinkSession uplinkSession;
+
+UplinkSession::UplinkSession()
+  : begun(false), handshakes(0), handshakesAvoided(0), reconnects(0), failures(0) {}
+
+bool UplinkSession::begin() {
+  if (begun) return true;
+
+  bool ok;
+  if (strncmp(URL, "https", 5) == 0) {
+    secureClient.setInsecure();
+    ok = http.begin(secureClient, URL);
+  } else {
+    ok = http.begin(plainClient, URL);
+  }
+
+  if (!ok) {
+    Serial.println("[UPLINK] ✗ URL inválida");
+    return false;
+  }
+
+  http.setReuse(true);           // Keep-alive entre POSTs
+  http.setConnectTimeout(3000);
+  http.setTimeout(5000);         // Timeout de 5 segundos
+  http.addHeader("Content-Type", "text/plain");
+  http.addHeader("Authorization", "Basic " + String(TOKEN_GRAFANA));
+  begun = true;
+  return true;
+}
+
+void UplinkSession::close() {
+  if (begun) {
+    http.end();
+    plainClient.stop();
+    secureClient.stop();
+  }
+  begun = false;
+}
+
+bool UplinkSession::isTransportError(int code) {
+  return code == HTTPC_ERROR_CONNECTION_LOST ||
+         code == HTTPC_ERROR_SEND_HEADER_FAILED ||
+         code == HTTPC_ERROR_SEND_PAYLOAD_FAILED ||
+         code == HTTPC_ERROR_NOT_CONNECTED ||
+         code == HTTPC_ERROR_READ_TIMEOUT;
+}
+
+int UplinkSession::send(const uint8_t* body, size_t length) {
+  if (!begin()) return HTTPC_ERROR_CONNECTION_REFUSED;
+
+  if (http.connected()) {
+    handshakesAvoided++;
+  } else {
+    handshakes++;
+  }
+
+  int code = http.POST((uint8_t*)body, length);
+
+  // Consumir el cuerpo de la respuesta para dejar el socket listo para reutilizar
+  if (code > 0 && code != 204) {
+    Serial.println(http.getString());
+  }
+  return code;
+}
+
+int UplinkSession::post(const uint8_t* body, size_t length) {
+  int code = send(body, length);
+
+  if (isTransportError(code)) {
+    // Socket viejo: el servidor cerró la conexión keep-alive
+    Serial.printf("[UPLINK] Conexión caída (%d), reconectando...\n", code);
+    close();
+    reconnects++;
+    code = send(body, length);
+  }
+
+  if (code < 0) {
+    failures++;
+    close();
+  }
+  return code;
+}
@@ -0,0 +1,65 @@
+// Tests for AdcOversampler (oversampled ADC reads with median / trimmed mean)
+
+#include <unity.h>
+#include "AdcOversampler.h"
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testAdcOversampler_MedianRejectsSpikes() {
+    AdcOversampler o;
+    const uint16_t raw[] = {2000, 2002, 4095, 1998, 2001, 0, 2003, 1999, 2000};
+    for (uint16_t v : raw) o.add(v);
+    TEST_ASSERT_EQUAL_UINT16(2000, o.result(ADC_FILTER_MEDIAN));
+
+    // Cantidad par: promedio de los dos centrales
+    o.reset();
+    o.add(10);
+    o.add(20);
+    o.add(31);
+    o.add(40);
+    TEST_ASSERT_EQUAL_UINT16(26, o.result(ADC_FILTER_MEDIAN));
+}
+
+void testAdcOversampler_TrimmedMeanDropsExtremes() {
+    AdcOversampler o;
+    // 16 muestras: se descartan 4 por extremo, incluidos los picos
+    const uint16_t raw[] = {3000, 0, 4095, 5,
+                            1000, 1004, 996, 1002, 998, 1001, 999, 1000,
+                            4000, 10, 3900, 20};
+    for (uint16_t v : raw) o.add(v);
+    TEST_ASSERT_EQUAL_UINT16(1000, o.result(ADC_FILTER_TRIMMED_MEAN));
+    TEST_ASSERT_EQUAL_UINT16(8, o.getSpread());   // 996..1004
+}
+
+void testAdcOversampler_NoiseReduction() {
+    // Ruido pseudoaleatorio de ±40 LSB con picos cada 16 muestras
+    uint32_t lcg = 12345;
+    uint16_t worst = 0;
+    for (int scan = 0; scan < 50; scan++) {
+        AdcOversampler o;
+        for (int i = 0; i < ADC_OVERSAMPLE_DEFAULT; i++) {
+            lcg = lcg * 1103515245u + 12345u;
+            int v = 2048 + (int)((lcg >> 16) % 81) - 40;
+            if (i % 16 == 7) v = (scan & 1) ? 4095 : 0;
+            o.add((uint16_t)v);
+        }
+        uint16_t r = o.result(ADC_FILTER_TRIMMED_MEAN);
+        uint16_t err = r > 2048 ? r - 2048 : 2048 - r;
+        if (err > worst) worst = err;
+    }
+    // Una muestra sola erraría hasta 40 LSB (o 2048 con un pico); filtrado, la mitad
+    TEST_ASSERT_TRUE(worst <= 20);
+}
+
+void testAdcOversampler_LimitsAndEmpty() {
+    AdcOversampler o;
+    TEST_ASSERT_EQUAL_UINT16(0, o.result(ADC_FILTER_MEDIAN));
+
+    o.add(1234);
+    TEST_ASSERT_EQUAL_UINT16(1234, o.result(ADC_FILTER_TRIMMED_MEAN));
+
+    for (int i = 0; i < ADC_OVERSAMPLE_MAX + 10; i++) o.add(7);
+    TEST_ASSERT_EQUAL_UINT8(ADC_OVERSAMPLE_MAX, o.getCount());
+}
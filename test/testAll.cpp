@@ -7,6 +7,145 @@ extern void testSendDataGrafana();
 extern void testCreateGrafanaMessage();
 extern void testCheckForUpdates();
 extern void testGetLatestReleaseTag();
+extern void testScheduler_ContinuousTaskRunsEveryPass();
+extern void testScheduler_PeriodicTaskRespectsPeriod();
+extern void testScheduler_InitialDelay();
+extern void testScheduler_OnePeriodicTaskPerPass();
+extern void testScheduler_MostOverdueFirst();
+extern void testScheduler_RunTimeAccountingAndDeadline();
+extern void testScheduler_SkipsMissedPeriods();
+extern void testScheduler_DisabledTaskDoesNotRun();
+extern void testModbusHealth_UnknownDeviceUsesMaxTimeout();
+extern void testModbusHealth_FrameTimeFromBaudrate();
+extern void testModbusHealth_TimeoutTracksLatency();
+extern void testModbusHealth_TimeoutNeverBelowFrameTime();
+extern void testModbusHealth_JitterWidensTimeout();
+extern void testModbusHealth_SingleFailureDoesNotBackOff();
+extern void testModbusHealth_BackoffDoublesAndCaps();
+extern void testModbusHealth_SuccessClearsBackoff();
+extern void testModbusHealth_BackoffSurvivesMillisWrap();
+extern void testModbusMap_NpkPresetIsOneBlock();
+extern void testModbusMap_UnorderedFieldsAreSorted();
+extern void testModbusMap_SmallGapIsCoalesced();
+extern void testModbusMap_LargeGapSplitsBlocks();
+extern void testModbusMap_BlockLimitedByMaxRegs();
+extern void testModbusMap_TooManyBlocksFails();
+extern void testModbusMap_DecodeTypes();
+extern void testModbusMap_ParseTypeAndDecimals();
+extern void testLineProtocol_BasicLine();
+extern void testLineProtocol_MatchesLegacyEncoder();
+extern void testLineProtocol_EscapesTagsAndMeasurement();
+extern void testLineProtocol_EmptyTagOmittedAndNaNSkipped();
+extern void testLineProtocol_LineWithoutFieldsIsRejected();
+extern void testLineProtocol_MultipleLinesAndRawFields();
+extern void testLineProtocol_OverflowRollsBackWholeLine();
+extern void testLineProtocol_FixedPointFormatting();
+extern void testLineProtocol_BenchmarkAgainstLegacy();
+extern void testMeshDedup_NewPacketThenDuplicate();
+extern void testMeshDedup_OriginatorsAreIndependent();
+extern void testMeshDedup_OutOfOrderInsideWindow();
+extern void testMeshDedup_RebootResetsWindow();
+extern void testMeshDedup_IdleOriginatorForgotten();
+extern void testMeshDedup_SequenceWrap();
+extern void testMeshDedup_FullTableEvictsLeastRecent();
+extern void testMeshDedup_ChurnKeepsProbeChainsIntact();
+extern void testMeshDedup_FloodStormBenchmark();
+extern void testSpscRing_PushPopFifo();
+extern void testSpscRing_FullDropsNewest();
+extern void testSpscRing_ReserveCommitInPlace();
+extern void testSpscRing_IndexWrapAround();
+extern void testSpscRing_TwoThreadsKeepOrder();
+extern void testMeshIngress_FifoAndDepthRounding();
+extern void testMeshIngress_DropNewestKeepsOldest();
+extern void testMeshIngress_DropOldestKeepsNewest();
+extern void testMeshIngress_CoalesceReplacesSameOriginator();
+extern void testMeshIngress_CoalesceDistinguishesSensors();
+extern void testMeshIngress_OccupancyAndLatencyHistograms();
+extern void testMeshIngress_MeshWakeUpBurst();
+extern void testMeshIngress_ConcurrentDropOldest();
+extern void testMeshIngress_ConcurrentCoalesce();
+extern void testMeshIngress_DropOldestDuringPopKeepsOrder();
+extern void testMeshIngress_ParsePolicy();
+extern void testMeshPayload_RoundTripKnownFields();
+extern void testMeshPayload_CompactEncoding();
+extern void testMeshPayload_WideValuesUseInt32();
+extern void testMeshPayload_UnknownFieldTravelsByName();
+extern void testMeshPayload_NonNumericValuesSkipped();
+extern void testMeshPayload_SeveralSensorsInOneFrame();
+extern void testMeshPayload_FullFrameRejectsAtomically();
+extern void testMeshPayload_UnknownTlvAndFieldSkipped();
+extern void testMeshPayload_TruncatedFrameDetected();
+extern void testMeshPayload_NameTableEvictsLeastRecent();
+extern void testMeshPayload_CycleAgesPatchedOnSend();
+extern void testMeshPayload_TxTimePatchedOnSend();
+extern void testMeshPayload_HostileFieldNameSkipped();
+extern void testMeshRouting_RootAdvertisesZero();
+extern void testMeshRouting_NoNeighborsNoRoute();
+extern void testMeshRouting_PicksLowestPathCost();
+extern void testMeshRouting_HysteresisAvoidsFlapping();
+extern void testMeshRouting_SilentParentExpires();
+extern void testMeshRouting_AckFailuresMoveParent();
+extern void testMeshRouting_MissedBeaconsLowerQuality();
+extern void testMeshRouting_ChildIsNeverParent();
+extern void testMeshRouting_TooManyHopsIsNoRoute();
+extern void testMeshRouting_FullTableEvictsWorstNotParent();
+extern void testMeshRouting_BeaconSeqTracksLossUnderTrickle();
+
+extern void testMeshSeqTracker_InOrderIsFullDelivery();
+extern void testMeshSeqTracker_GapCountsLoss();
+extern void testMeshSeqTracker_LateFrameIsReorderNotLoss();
+extern void testMeshSeqTracker_SequenceResetIsReboot();
+extern void testMeshSeqTracker_LatencyRelativeToFastest();
+extern void testMeshSeqTracker_FullTableReplacesQuietest();
+
+extern void testPeerRegistry_AddFindAndCount();
+extern void testPeerRegistry_FrameStatsOnlyForPeers();
+extern void testPeerRegistry_FullEvictsLeastRecent();
+extern void testPeerRegistry_IdleExpireInLruOrder();
+extern void testPeerRegistry_DriverSlotRecycling();
+extern void testPeerRegistry_ChurnKeepsIndexConsistent();
+
+extern void testTrickleTimer_BacksOffWhileStable();
+extern void testTrickleTimer_FiresInSecondHalf();
+extern void testTrickleTimer_SuppressedByRedundantNeighbors();
+extern void testTrickleTimer_NoSuppressionWhenDisallowed();
+extern void testTrickleTimer_ResetReturnsToImin();
+
+extern void testSleepSchedule_BeginMarksValid();
+extern void testSleepSchedule_SleepDiscountsAwakeTime();
+extern void testSleepSchedule_BootToSendStats();
+extern void testSleepSchedule_FailuresRediscoverAndBackOff();
+extern void testSleepSchedule_ClockRunsThroughSleep();
+extern void testSleepSchedule_WakeWithoutConfigKeepsPeriod();
+extern void testSleepSchedule_EarlyExitKeepsResumeState();
+
+extern void testOneWireConversion_TimeByResolution();
+extern void testOneWireConversion_PendingUntilDeadline();
+extern void testOneWireConversion_ProbesJoinRunningConversion();
+extern void testOneWireConversion_EarlyCompletion();
+
+extern void testAdcOversampler_MedianRejectsSpikes();
+extern void testAdcOversampler_TrimmedMeanDropsExtremes();
+extern void testAdcOversampler_NoiseReduction();
+extern void testAdcOversampler_LimitsAndEmpty();
+
+extern void testStreamingStats_MeanMinMaxStd();
+extern void testStreamingStats_StableWithLargeOffset();
+extern void testStreamingStats_WindowFormatsFields();
+extern void testStreamingStats_WindowSplitsAcrossSets();
+
+extern void testDeadbandFilter_FirstReadingPublishesAll();
+extern void testDeadbandFilter_OnlyFieldsOutsideBand();
+extern void testDeadbandFilter_HeartbeatPerField();
+extern void testDeadbandFilter_ZeroBandInvalidAndOverflow();
+extern void testDeadbandFilter_ReferencesSurviveDeepSleep();
+
+extern void testMeasurement_AddUsesFieldTable();
+extern void testMeasurement_FindAndQuality();
+extern void testMeasurement_LineProtocolFields();
+extern void testMeasurement_MeshRoundTripWithoutText();
+extern void testMeasurement_TableKeyedByFieldAndName();
+extern void testMeasurement_FieldKeysEscaped();
 
 void setUp() {}
 void tearDown() {}
@@ -20,6 +159,145 @@ int main() {
     RUN_TEST(testCreateGrafanaMessage);
     RUN_TEST(testSendDataGrafana);
     RUN_TEST(testGetLatestReleaseTag);       
+    RUN_TEST(testScheduler_ContinuousTaskRunsEveryPass);
+    RUN_TEST(testScheduler_PeriodicTaskRespectsPeriod);
+    RUN_TEST(testScheduler_InitialDelay);
+    RUN_TEST(testScheduler_OnePeriodicTaskPerPass);
+    RUN_TEST(testScheduler_MostOverdueFirst);
+    RUN_TEST(testScheduler_RunTimeAccountingAndDeadline);
+    RUN_TEST(testScheduler_SkipsMissedPeriods);
+    RUN_TEST(testScheduler_DisabledTaskDoesNotRun);
+    RUN_TEST(testModbusHealth_UnknownDeviceUsesMaxTimeout);
+    RUN_TEST(testModbusHealth_FrameTimeFromBaudrate);
+    RUN_TEST(testModbusHealth_TimeoutTracksLatency);
+    RUN_TEST(testModbusHealth_TimeoutNeverBelowFrameTime);
+    RUN_TEST(testModbusHealth_JitterWidensTimeout);
+    RUN_TEST(testModbusHealth_SingleFailureDoesNotBackOff);
+    RUN_TEST(testModbusHealth_BackoffDoublesAndCaps);
+    RUN_TEST(testModbusHealth_SuccessClearsBackoff);
+    RUN_TEST(testModbusHealth_BackoffSurvivesMillisWrap);
+    RUN_TEST(testModbusMap_NpkPresetIsOneBlock);
+    RUN_TEST(testModbusMap_UnorderedFieldsAreSorted);
+    RUN_TEST(testModbusMap_SmallGapIsCoalesced);
+    RUN_TEST(testModbusMap_LargeGapSplitsBlocks);
+    RUN_TEST(testModbusMap_BlockLimitedByMaxRegs);
+    RUN_TEST(testModbusMap_TooManyBlocksFails);
+    RUN_TEST(testModbusMap_DecodeTypes);
+    RUN_TEST(testModbusMap_ParseTypeAndDecimals);
+    RUN_TEST(testLineProtocol_BasicLine);
+    RUN_TEST(testLineProtocol_MatchesLegacyEncoder);
+    RUN_TEST(testLineProtocol_EscapesTagsAndMeasurement);
+    RUN_TEST(testLineProtocol_EmptyTagOmittedAndNaNSkipped);
+    RUN_TEST(testLineProtocol_LineWithoutFieldsIsRejected);
+    RUN_TEST(testLineProtocol_MultipleLinesAndRawFields);
+    RUN_TEST(testLineProtocol_OverflowRollsBackWholeLine);
+    RUN_TEST(testLineProtocol_FixedPointFormatting);
+    RUN_TEST(testLineProtocol_BenchmarkAgainstLegacy);
+    RUN_TEST(testMeshDedup_NewPacketThenDuplicate);
+    RUN_TEST(testMeshDedup_OriginatorsAreIndependent);
+    RUN_TEST(testMeshDedup_OutOfOrderInsideWindow);
+    RUN_TEST(testMeshDedup_RebootResetsWindow);
+    RUN_TEST(testMeshDedup_IdleOriginatorForgotten);
+    RUN_TEST(testMeshDedup_SequenceWrap);
+    RUN_TEST(testMeshDedup_FullTableEvictsLeastRecent);
+    RUN_TEST(testMeshDedup_ChurnKeepsProbeChainsIntact);
+    RUN_TEST(testMeshDedup_FloodStormBenchmark);
+    RUN_TEST(testSpscRing_PushPopFifo);
+    RUN_TEST(testSpscRing_FullDropsNewest);
+    RUN_TEST(testSpscRing_ReserveCommitInPlace);
+    RUN_TEST(testSpscRing_IndexWrapAround);
+    RUN_TEST(testSpscRing_TwoThreadsKeepOrder);
+    RUN_TEST(testMeshIngress_FifoAndDepthRounding);
+    RUN_TEST(testMeshIngress_DropNewestKeepsOldest);
+    RUN_TEST(testMeshIngress_DropOldestKeepsNewest);
+    RUN_TEST(testMeshIngress_CoalesceReplacesSameOriginator);
+    RUN_TEST(testMeshIngress_CoalesceDistinguishesSensors);
+    RUN_TEST(testMeshIngress_OccupancyAndLatencyHistograms);
+    RUN_TEST(testMeshIngress_MeshWakeUpBurst);
+    RUN_TEST(testMeshIngress_ConcurrentDropOldest);
+    RUN_TEST(testMeshIngress_ConcurrentCoalesce);
+    RUN_TEST(testMeshIngress_DropOldestDuringPopKeepsOrder);
+    RUN_TEST(testMeshIngress_ParsePolicy);
+    RUN_TEST(testMeshPayload_RoundTripKnownFields);
+    RUN_TEST(testMeshPayload_CompactEncoding);
+    RUN_TEST(testMeshPayload_WideValuesUseInt32);
+    RUN_TEST(testMeshPayload_UnknownFieldTravelsByName);
+    RUN_TEST(testMeshPayload_NonNumericValuesSkipped);
+    RUN_TEST(testMeshPayload_SeveralSensorsInOneFrame);
+    RUN_TEST(testMeshPayload_FullFrameRejectsAtomically);
+    RUN_TEST(testMeshPayload_UnknownTlvAndFieldSkipped);
+    RUN_TEST(testMeshPayload_TruncatedFrameDetected);
+    RUN_TEST(testMeshPayload_NameTableEvictsLeastRecent);
+    RUN_TEST(testMeshPayload_CycleAgesPatchedOnSend);
+    RUN_TEST(testMeshPayload_TxTimePatchedOnSend);
+    RUN_TEST(testMeshPayload_HostileFieldNameSkipped);
+    RUN_TEST(testMeshRouting_RootAdvertisesZero);
+    RUN_TEST(testMeshRouting_NoNeighborsNoRoute);
+    RUN_TEST(testMeshRouting_PicksLowestPathCost);
+    RUN_TEST(testMeshRouting_HysteresisAvoidsFlapping);
+    RUN_TEST(testMeshRouting_SilentParentExpires);
+    RUN_TEST(testMeshRouting_AckFailuresMoveParent);
+    RUN_TEST(testMeshRouting_MissedBeaconsLowerQuality);
+    RUN_TEST(testMeshRouting_ChildIsNeverParent);
+    RUN_TEST(testMeshRouting_TooManyHopsIsNoRoute);
+    RUN_TEST(testMeshRouting_FullTableEvictsWorstNotParent);
+    RUN_TEST(testMeshRouting_BeaconSeqTracksLossUnderTrickle);
+
+    RUN_TEST(testMeshSeqTracker_InOrderIsFullDelivery);
+    RUN_TEST(testMeshSeqTracker_GapCountsLoss);
+    RUN_TEST(testMeshSeqTracker_LateFrameIsReorderNotLoss);
+    RUN_TEST(testMeshSeqTracker_SequenceResetIsReboot);
+    RUN_TEST(testMeshSeqTracker_LatencyRelativeToFastest);
+    RUN_TEST(testMeshSeqTracker_FullTableReplacesQuietest);
+
+    RUN_TEST(testPeerRegistry_AddFindAndCount);
+    RUN_TEST(testPeerRegistry_FrameStatsOnlyForPeers);
+    RUN_TEST(testPeerRegistry_FullEvictsLeastRecent);
+    RUN_TEST(testPeerRegistry_IdleExpireInLruOrder);
+    RUN_TEST(testPeerRegistry_DriverSlotRecycling);
+    RUN_TEST(testPeerRegistry_ChurnKeepsIndexConsistent);
+
+    RUN_TEST(testTrickleTimer_BacksOffWhileStable);
+    RUN_TEST(testTrickleTimer_FiresInSecondHalf);
+    RUN_TEST(testTrickleTimer_SuppressedByRedundantNeighbors);
+    RUN_TEST(testTrickleTimer_NoSuppressionWhenDisallowed);
+    RUN_TEST(testTrickleTimer_ResetReturnsToImin);
+
+    RUN_TEST(testSleepSchedule_BeginMarksValid);
+    RUN_TEST(testSleepSchedule_SleepDiscountsAwakeTime);
+    RUN_TEST(testSleepSchedule_BootToSendStats);
+    RUN_TEST(testSleepSchedule_FailuresRediscoverAndBackOff);
+    RUN_TEST(testSleepSchedule_ClockRunsThroughSleep);
+    RUN_TEST(testSleepSchedule_WakeWithoutConfigKeepsPeriod);
+    RUN_TEST(testSleepSchedule_EarlyExitKeepsResumeState);
+
+    RUN_TEST(testOneWireConversion_TimeByResolution);
+    RUN_TEST(testOneWireConversion_PendingUntilDeadline);
+    RUN_TEST(testOneWireConversion_ProbesJoinRunningConversion);
+    RUN_TEST(testOneWireConversion_EarlyCompletion);
+
+    RUN_TEST(testAdcOversampler_MedianRejectsSpikes);
+    RUN_TEST(testAdcOversampler_TrimmedMeanDropsExtremes);
+    RUN_TEST(testAdcOversampler_NoiseReduction);
+    RUN_TEST(testAdcOversampler_LimitsAndEmpty);
+
+    RUN_TEST(testStreamingStats_MeanMinMaxStd);
+    RUN_TEST(testStreamingStats_StableWithLargeOffset);
+    RUN_TEST(testStreamingStats_WindowFormatsFields);
+    RUN_TEST(testStreamingStats_WindowSplitsAcrossSets);
+
+    RUN_TEST(testDeadbandFilter_FirstReadingPublishesAll);
+    RUN_TEST(testDeadbandFilter_OnlyFieldsOutsideBand);
+    RUN_TEST(testDeadbandFilter_HeartbeatPerField);
+    RUN_TEST(testDeadbandFilter_ZeroBandInvalidAndOverflow);
+    RUN_TEST(testDeadbandFilter_ReferencesSurviveDeepSleep);
+
+    RUN_TEST(testMeasurement_AddUsesFieldTable);
+    RUN_TEST(testMeasurement_FindAndQuality);
+    RUN_TEST(testMeasurement_LineProtocolFields);
+    RUN_TEST(testMeasurement_MeshRoundTripWithoutText);
+    RUN_TEST(testMeasurement_TableKeyedByFieldAndName);
+    RUN_TEST(testMeasurement_FieldKeysEscaped);
     return UNITY_END();
 }
 //void setup() {
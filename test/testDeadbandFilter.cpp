@@ -0,0 +1,128 @@
+// Tests for DeadbandFilter (report-by-exception publishing per field)
+
+#include <unity.h>
+#include "DeadbandFilter.h"
+
+static MeasurementSet reading(float temp, float hum) {
+    MeasurementSet m;
+    m.add(MEAS_TEMP, temp, 0);
+    m.add(MEAS_HUM, hum, 0);
+    return m;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testDeadbandFilter_FirstReadingPublishesAll() {
+    DeadbandFilter f(0.5f);
+    MeasurementSet out;
+    char line[128];
+    TEST_ASSERT_EQUAL(2, f.filter(reading(21.5f, 60.0f), 0, out));
+    measurementsToFields(out, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("temp=21.50,hum=60.00", line);
+}
+
+void testDeadbandFilter_OnlyFieldsOutsideBand() {
+    DeadbandFilter f(0.5f);
+    f.setBand("hum", 2.0f);
+    MeasurementSet out;
+    char line[128];
+    f.filter(reading(21.5f, 60.0f), 0, out);
+
+    out.clear();
+    TEST_ASSERT_EQUAL(0, f.filter(reading(21.8f, 61.0f), 10000, out));
+    TEST_ASSERT_EQUAL(0, out.size());
+
+    TEST_ASSERT_EQUAL(1, f.filter(reading(22.1f, 61.5f), 20000, out));
+    measurementsToFields(out, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("temp=22.10", line);
+
+    // Deriva lenta: la referencia es el último valor publicado (60.00), no la lectura anterior
+    out.clear();
+    TEST_ASSERT_EQUAL(1, f.filter(reading(22.1f, 62.1f), 30000, out));
+    measurementsToFields(out, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("hum=62.10", line);
+
+    TEST_ASSERT_EQUAL_UINT32(3, f.getPublished());
+    TEST_ASSERT_EQUAL_UINT32(1, f.getSuppressed());
+}
+
+void testDeadbandFilter_HeartbeatPerField() {
+    DeadbandFilter f(1.0f, 60000);
+    f.setHeartbeat("co2", 0);   // Sin heartbeat
+    MeasurementSet in;
+    MeasurementSet out;
+    char line[128];
+    in.add(MEAS_SOIL_HUM, 33.8f, 0);
+    in.add(MEAS_CO2, 415, 0);
+    f.filter(in, 0, out);
+
+    in.clear();
+    in.add(MEAS_SOIL_HUM, 33.9f, 0);
+    in.add(MEAS_CO2, 415, 0);
+    out.clear();
+    TEST_ASSERT_EQUAL(0, f.filter(in, 59999, out));
+    TEST_ASSERT_EQUAL(1, f.filter(in, 60000, out));
+    measurementsToFields(out, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("soilHum=33.90", line);
+
+    // El heartbeat cuenta desde la última publicación del campo
+    out.clear();
+    TEST_ASSERT_EQUAL(0, f.filter(in, 119999, out));
+    in.clear();
+    in.add(MEAS_SOIL_HUM, 33.9f, 0);
+    in.add(MEAS_CO2, 430, 0);
+    TEST_ASSERT_EQUAL(1, f.filter(in, 119999, out));
+    measurementsToFields(out, line, sizeof(line));
+    TEST_ASSERT_EQUAL_STRING("co2=430.0", line);
+}
+
+void testDeadbandFilter_ZeroBandInvalidAndOverflow() {
+    // Banda 0: sale cualquier cambio, no la misma lectura repetida
+    DeadbandFilter f;
+    MeasurementSet out;
+    f.filter(reading(21.5f, 60.0f), 0, out);
+    TEST_ASSERT_EQUAL(0, f.filter(reading(21.5f, 60.0f), 1000, out));
+    TEST_ASSERT_EQUAL(1, f.filter(reading(21.51f, 60.0f), 2000, out));
+
+    // Una medición inválida no sale ni mueve la referencia
+    MeasurementSet in;
+    in.add(MEAS_TEMP, -127, 3000, MEAS_INVALID);
+    out.clear();
+    TEST_ASSERT_EQUAL(0, f.filter(in, 3000, out));
+    TEST_ASSERT_EQUAL(0, f.filter(reading(21.51f, 60.0f), 4000, out));
+
+    // Nombre más largo que la tabla: sin lugar, sale siempre
+    DeadbandFilter g(100.0f);
+    in.clear();
+    in.addNamed("conductividad_total", 1, 0, 0);
+    TEST_ASSERT_EQUAL(1, g.filter(in, 0, out));
+    TEST_ASSERT_EQUAL(1, g.filter(in, 1000, out));
+}
+
+void testDeadbandFilter_ReferencesSurviveDeepSleep() {
+    DeadbandMemory mem;
+    memset(&mem, 0xA5, sizeof(mem));   // Basura en RTC tras un corte de energía
+    mem.clear();
+
+    MeasurementSet out;
+    DeadbandFilter before(0.5f, 60000);
+    before.filter(reading(21.5f, 60.0f), 1000, out);
+    before.save(0, mem);
+    DeadbandFilter other(0.5f);
+    other.filter(reading(5.0f, 5.0f), 1000, out);
+    other.save(1, mem);
+    TEST_ASSERT_EQUAL(4, mem.count);
+
+    // Despertar: filtro nuevo desde la configuración, mismas referencias
+    DeadbandFilter after(0.5f, 60000);
+    after.restore(0, mem);
+    out.clear();
+    TEST_ASSERT_EQUAL(0, after.filter(reading(21.7f, 60.2f), 31000, out));
+    TEST_ASSERT_EQUAL(2, after.filter(reading(21.7f, 60.2f), 61000, out));   // Heartbeat desde t=1000
+
+    // Tabla llena: los campos que no entran se publican siempre
+    for (int i = 0; i < DEADBAND_MEMORY_FIELDS; i++) before.save(2, mem);
+    TEST_ASSERT_EQUAL(DEADBAND_MEMORY_FIELDS, mem.count);
+}
@@ -5,57 +5,12 @@
 #include <cstdint>
 #include <cstring>
 
-// ============================================================================
-// Mock/Stub implementations for testing without Arduino/ESP-IDF
-// ============================================================================
-
-static unsigned long mock_millis_value = 0;
-unsigned long millis() { return mock_millis_value; }
-
 // ============================================================================
 // Extracted testable logic from ESPNowManager
 // These mirror the PR #11 implementations for unit testing
+// (duplicate detection moved to MeshDedup, see testMeshDedup.cpp)
 // ============================================================================
 
-// Duplicate packet detection cache (from PR #11)
-static const int SEEN_PACKET_CACHE_SIZE = 30;
-struct PacketID {
-    uint8_t mac[6];
-    uint32_t sequence;
-    unsigned long timestamp;
-};
-
-static PacketID seenPackets[SEEN_PACKET_CACHE_SIZE];
-static int seenPacketIndex = 0;
-
-void resetSeenPacketCache() {
-    memset(seenPackets, 0, sizeof(seenPackets));
-    seenPacketIndex = 0;
-}
-
-// Check if a packet has been seen recently (from PR #11)
-bool hasSeenPacket(const uint8_t* mac, uint32_t seq) {
-    unsigned long now = millis();
-    const unsigned long SEEN_TIMEOUT = 60000; // 1 minute timeout
-
-    for (int i = 0; i < SEEN_PACKET_CACHE_SIZE; i++) {
-        if (memcmp(seenPackets[i].mac, mac, 6) == 0 && seenPackets[i].sequence == seq) {
-            if (now - seenPackets[i].timestamp < SEEN_TIMEOUT) {
-                return true; // Packet is fresh and a duplicate
-            }
-        }
-    }
-    return false; // Packet not seen or is stale
-}
-
-// Mark a packet as seen (from PR #11)
-void markPacketAsSeen(const uint8_t* mac, uint32_t seq) {
-    memcpy(seenPackets[seenPacketIndex].mac, mac, 6);
-    seenPackets[seenPacketIndex].sequence = seq;
-    seenPackets[seenPacketIndex].timestamp = millis();
-    seenPacketIndex = (seenPacketIndex + 1) % SEEN_PACKET_CACHE_SIZE;
-}
-
 // SensorDataMessage structure (PR #11 version with mesh fields)
 typedef struct {
     uint8_t msgType;
@@ -78,106 +33,6 @@ typedef struct {
     uint32_t sequence;
 } SensorDataMessage_Original;
 
-// ============================================================================
-// TESTS: Duplicate Packet Detection
-// ============================================================================
-
-void testHasSeenPacket_NewPacket() {
-    resetSeenPacketCache();
-    mock_millis_value = 1000;
-
-    uint8_t mac[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
-    uint32_t seq = 42;
-
-    // New packet should NOT be seen
-    TEST_ASSERT_FALSE(hasSeenPacket(mac, seq));
-}
-
-void testHasSeenPacket_AfterMarking() {
-    resetSeenPacketCache();
-    mock_millis_value = 1000;
-
-    uint8_t mac[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
-    uint32_t seq = 42;
-
-    // Mark packet as seen
-    markPacketAsSeen(mac, seq);
-
-    // Now it should be seen
-    TEST_ASSERT_TRUE(hasSeenPacket(mac, seq));
-}
-
-void testHasSeenPacket_DifferentSequence() {
-    resetSeenPacketCache();
-    mock_millis_value = 1000;
-
-    uint8_t mac[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
-
-    markPacketAsSeen(mac, 42);
-
-    // Same MAC, different sequence should NOT be seen
-    TEST_ASSERT_FALSE(hasSeenPacket(mac, 43));
-}
-
-void testHasSeenPacket_DifferentMAC() {
-    resetSeenPacketCache();
-    mock_millis_value = 1000;
-
-    uint8_t mac1[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
-    uint8_t mac2[6] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
-
-    markPacketAsSeen(mac1, 42);
-
-    // Different MAC, same sequence should NOT be seen
-    TEST_ASSERT_FALSE(hasSeenPacket(mac2, 42));
-}
-
-void testHasSeenPacket_Timeout() {
-    resetSeenPacketCache();
-    mock_millis_value = 1000;
-
-    uint8_t mac[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
-    uint32_t seq = 42;
-
-    markPacketAsSeen(mac, seq);
-    TEST_ASSERT_TRUE(hasSeenPacket(mac, seq));
-
-    // Advance time past 60 second timeout
-    mock_millis_value = 62000;
-
-    // Should be considered new (stale entry)
-    TEST_ASSERT_FALSE(hasSeenPacket(mac, seq));
-}
-
-void testSeenPacketCache_CircularBuffer() {
-    resetSeenPacketCache();
-    mock_millis_value = 1000;
-
-    uint8_t mac[6] = {0x00, 0x00, 0x00, 0x00, 0x00, 0x00};
-
-    // Fill cache with 30 packets
-    for (int i = 0; i < SEEN_PACKET_CACHE_SIZE; i++) {
-        mac[5] = i;
-        markPacketAsSeen(mac, i);
-    }
-
-    // First packet should still be there
-    mac[5] = 0;
-    TEST_ASSERT_TRUE(hasSeenPacket(mac, 0));
-
-    // Add one more packet - this should overwrite slot 0
-    mac[5] = 99;
-    markPacketAsSeen(mac, 99);
-
-    // First packet should now be gone (overwritten)
-    mac[5] = 0;
-    TEST_ASSERT_FALSE(hasSeenPacket(mac, 0));
-
-    // New packet should be there
-    mac[5] = 99;
-    TEST_ASSERT_TRUE(hasSeenPacket(mac, 99));
-}
-
 // ============================================================================
 // TESTS: Message Structure (PR #11 changes)
 // ============================================================================
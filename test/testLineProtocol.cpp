@@ -0,0 +1,223 @@
+// Tests for LineProtocolWriter (zero-allocation InfluxDB line protocol encoder)
+// plus a benchmark against the previous String-concatenation encoder.
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <new>
+#include <string>
+#include "lineProtocol.h"
+
+// ============================================================================
+// Allocation counter (global operator new, only active while measuring)
+// ============================================================================
+
+static bool lp_counting = false;
+static size_t lp_allocs = 0;
+static size_t lp_allocBytes = 0;
+
+void* operator new(size_t size) {
+    if (lp_counting) {
+        lp_allocs++;
+        lp_allocBytes += size;
+    }
+    void* p = malloc(size ? size : 1);
+    if (!p) throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+
+// ============================================================================
+// Reference: previous encoder (buildInfluxMessage + create_grafana_message)
+// Same chain of temporaries, with std::string standing in for Arduino String.
+// ============================================================================
+
+static std::string legacyFloat(float v) {
+    char tmp[32];
+    snprintf(tmp, sizeof(tmp), "%.2f", v);
+    return std::string(tmp);
+}
+
+static std::string legacyEncode(const char* device, const char* sensor, float t, float h, float c,
+                                unsigned long long ts) {
+    std::string fields = "temp=" + legacyFloat(t) +
+                         ",hum=" + legacyFloat(h) +
+                         ",co2=" + legacyFloat(c);
+    return "medicionesCO2,device=" + std::string(device) +
+           ",sensor=" + std::string(sensor) +
+           " " + fields +
+           " " + std::to_string(ts);
+}
+
+static size_t newEncode(char* buf, size_t size, const char* device, const char* sensor, float t, float h, float c,
+                        unsigned long long ts) {
+    LineProtocolWriter w(buf, size);
+    w.beginLine("medicionesCO2");
+    w.tag("device", device);
+    w.tag("sensor", sensor);
+    w.field("temp", t, 2);
+    w.field("hum", h, 2);
+    w.field("co2", c, 2);
+    w.timestamp(ts);
+    w.endLine();
+    return w.length();
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testLineProtocol_BasicLine() {
+    char buf[256];
+    newEncode(buf, sizeof(buf), "moni-80F3DAAD", "th-mod-1", 23.45f, 55.67f, 789.0f, 1234567890000000000ULL);
+
+    TEST_ASSERT_EQUAL_STRING(
+        "medicionesCO2,device=moni-80F3DAAD,sensor=th-mod-1 temp=23.45,hum=55.67,co2=789.00 1234567890000000000",
+        buf);
+}
+
+void testLineProtocol_MatchesLegacyEncoder() {
+    const float samples[][3] = {
+        {23.45f, 55.67f, 789.0f}, {-10.1f, 0.0f, -1.0f}, {0.005f, 99.995f, 12345.678f}, {-0.004f, 1.0f, 400.0f},
+    };
+    for (auto& s : samples) {
+        char buf[256];
+        newEncode(buf, sizeof(buf), "moni-A1B2", "scd30", s[0], s[1], s[2], 1700000000000000000ULL);
+        std::string legacy = legacyEncode("moni-A1B2", "scd30", s[0], s[1], s[2], 1700000000000000000ULL);
+        // printf escribe "-0.00" para valores que redondean a cero; el protocolo acepta ambos
+        if (legacy.find("-0.00") == std::string::npos) {
+            TEST_ASSERT_EQUAL_STRING(legacy.c_str(), buf);
+        }
+    }
+}
+
+void testLineProtocol_EscapesTagsAndMeasurement() {
+    char buf[128];
+    LineProtocolWriter w(buf, sizeof(buf));
+    w.beginLine("my meas,x");
+    w.tag("sen sor", "a=b,c d");
+    w.fieldInt("n", -42);
+    TEST_ASSERT_TRUE(w.endLine());
+
+    TEST_ASSERT_EQUAL_STRING("my\\ meas\\,x,sen\\ sor=a\\=b\\,c\\ d n=-42i", buf);
+}
+
+void testLineProtocol_EmptyTagOmittedAndNaNSkipped() {
+    char buf[128];
+    LineProtocolWriter w(buf, sizeof(buf));
+    w.beginLine("m");
+    w.tag("device", "");
+    w.field("bad", NAN);
+    w.field("ok", 1.5, 1);
+    w.timestamp(7);
+    TEST_ASSERT_TRUE(w.endLine());
+
+    TEST_ASSERT_EQUAL_STRING("m ok=1.5 7", buf);
+}
+
+void testLineProtocol_LineWithoutFieldsIsRejected() {
+    char buf[128];
+    LineProtocolWriter w(buf, sizeof(buf));
+    w.beginLine("m");
+    w.tag("a", "b");
+    w.field("x", NAN);
+    w.timestamp(1);
+
+    TEST_ASSERT_FALSE(w.endLine());
+    TEST_ASSERT_EQUAL(0, w.length());
+    TEST_ASSERT_EQUAL_STRING("", buf);
+}
+
+void testLineProtocol_MultipleLinesAndRawFields() {
+    char buf[128];
+    LineProtocolWriter w(buf, sizeof(buf));
+    w.beginLine("m");
+    w.rawFields("temp=21.50");
+    w.timestamp(1);
+    TEST_ASSERT_TRUE(w.endLine());
+    w.beginLine("m");
+    w.rawFields("a=1,b=2");
+    w.field("c", 3.0, 0);
+    TEST_ASSERT_TRUE(w.endLine());
+
+    TEST_ASSERT_EQUAL(2, w.lineCount());
+    TEST_ASSERT_EQUAL_STRING("m temp=21.50 1\nm a=1,b=2,c=3", buf);
+}
+
+void testLineProtocol_OverflowRollsBackWholeLine() {
+    char buf[24];
+    LineProtocolWriter w(buf, sizeof(buf));
+    w.beginLine("m");
+    w.rawFields("a=1");
+    TEST_ASSERT_TRUE(w.endLine());
+    size_t before = w.length();
+
+    w.beginLine("m");
+    w.rawFields("long_field_name=123456789");
+    TEST_ASSERT_FALSE(w.endLine());
+
+    TEST_ASSERT_TRUE(w.overflowed());
+    TEST_ASSERT_EQUAL(before, w.length());
+    TEST_ASSERT_EQUAL(1, w.lineCount());
+    TEST_ASSERT_EQUAL_STRING("m a=1", buf);
+}
+
+void testLineProtocol_FixedPointFormatting() {
+    char buf[128];
+    LineProtocolWriter w(buf, sizeof(buf));
+    w.beginLine("m");
+    w.field("a", 0.125, 2);       // Redondeo
+    w.field("b", -2.5, 0);
+    w.field("c", 1e6, 3);
+    w.field("d", 0.05, 1);
+    w.field("e", 3.14159, 9);     // Máximo 6 decimales
+    TEST_ASSERT_TRUE(w.endLine());
+
+    TEST_ASSERT_EQUAL_STRING("m a=0.13,b=-3,c=1000000.000,d=0.1,e=3.141590", buf);
+}
+
+void testLineProtocol_BenchmarkAgainstLegacy() {
+    const int ITER = 20000;
+    char buf[256];
+    volatile size_t sink = 0;
+
+    // Encoder anterior
+    lp_allocs = lp_allocBytes = 0;
+    lp_counting = true;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITER; i++) {
+        std::string s = legacyEncode("moni-80F3DAAD", "th-mod-1", 20.0f + i * 0.01f, 55.5f, 800.0f,
+                                     1700000000000000000ULL + i);
+        sink += s.size();
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    lp_counting = false;
+    size_t legacyAllocs = lp_allocs, legacyBytes = lp_allocBytes;
+
+    // LineProtocolWriter
+    lp_allocs = lp_allocBytes = 0;
+    lp_counting = true;
+    auto t2 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITER; i++) {
+        sink += newEncode(buf, sizeof(buf), "moni-80F3DAAD", "th-mod-1", 20.0f + i * 0.01f, 55.5f, 800.0f,
+                          1700000000000000000ULL + i);
+    }
+    auto t3 = std::chrono::steady_clock::now();
+    lp_counting = false;
+    size_t newAllocs = lp_allocs, newBytes = lp_allocBytes;
+
+    double legacyNs = std::chrono::duration<double, std::nano>(t1 - t0).count() / ITER;
+    double newNs = std::chrono::duration<double, std::nano>(t3 - t2).count() / ITER;
+    printf("[bench] legacy: %.1f allocs/line, %.0f bytes/line, %.0f ns/line\n",
+           (double)legacyAllocs / ITER, (double)legacyBytes / ITER, legacyNs);
+    printf("[bench] writer: %.1f allocs/line, %.0f bytes/line, %.0f ns/line\n",
+           (double)newAllocs / ITER, (double)newBytes / ITER, newNs);
+
+    TEST_ASSERT_EQUAL(0, newAllocs);
+    TEST_ASSERT_TRUE(legacyAllocs >= (size_t)ITER);
+    TEST_ASSERT_TRUE(sink > 0);
+}
@@ -0,0 +1,156 @@
+// Tests for Measurement / MeasurementSet (typed sensor readings and their encoders)
+
+#include <unity.h>
+#include <string.h>
+#include "Measurement.h"
+#include "MeshPayload.h"
+
+static const uint8_t ORIGIN[6] = {0x24, 0x6F, 0x28, 0xAA, 0xBB, 0xCC};
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testMeasurement_AddUsesFieldTable() {
+    MeasurementSet m;
+    TEST_ASSERT_TRUE(m.add(MEAS_CO2, 415, 1000));
+    TEST_ASSERT_TRUE(m.addNamed("soilHum", 33.8f, 1, 1000));
+    TEST_ASSERT_TRUE(m.addNamed("lux", 120, 0, 1000));
+    TEST_ASSERT_FALSE(m.add(MEAS_NAMED, 1, 1000));   // Sin nombre
+    TEST_ASSERT_FALSE(m.addNamed("", 1, 0, 1000));
+
+    TEST_ASSERT_EQUAL(3, m.size());
+    TEST_ASSERT_EQUAL_STRING("co2", m[0].name);
+    TEST_ASSERT_EQUAL(1, m[0].decimals);
+    TEST_ASSERT_EQUAL_UINT32(1000, m[0].timestampMs);
+    // Nombre de la tabla: id fijo, decimales del sensor
+    TEST_ASSERT_EQUAL(MEAS_SOIL_HUM, m[1].field);
+    TEST_ASSERT_EQUAL(1, m[1].decimals);
+    TEST_ASSERT_EQUAL(MEAS_NAMED, m[2].field);
+    TEST_ASSERT_EQUAL_STRING("lux", m[2].name);
+
+    // Lleno: no pisa
+    for (int i = 0; i < MEASUREMENT_MAX; i++) m.add(MEAS_TEMP, i, 0);
+    TEST_ASSERT_EQUAL(MEASUREMENT_MAX, m.size());
+}
+
+void testMeasurement_FindAndQuality() {
+    MeasurementSet m;
+    m.add(MEAS_TEMP, -127, 0, MEAS_INVALID);
+    m.add(MEAS_HUM, 100, 0, MEAS_CLAMPED);
+
+    TEST_ASSERT_NOT_NULL(m.find(MEAS_TEMP));
+    TEST_ASSERT_NULL(m.find(MEAS_CO2));
+    TEST_ASSERT_NULL(m.find(MEAS_NAMED));
+    TEST_ASSERT_EQUAL_FLOAT(-1, m.valueOr(MEAS_TEMP, -1));
+    TEST_ASSERT_EQUAL_FLOAT(100, m.valueOr(MEAS_HUM, -1));
+    TEST_ASSERT_EQUAL(1, m.publishable());
+
+    m.clear();
+    TEST_ASSERT_EQUAL(0, m.size());
+}
+
+void testMeasurement_LineProtocolFields() {
+    MeasurementSet m;
+    m.add(MEAS_TEMP, -3.456f, 0);
+    m.add(MEAS_HUM, 0.004f, 0, MEAS_INVALID);
+    m.add(MEAS_CO2, 415, 0);
+    m.addNamed("ec", 1250.6f, 0, 0);
+    m.add(MEAS_PRESS, NAN, 0);
+
+    char out[UPLINK_FIELDS_LEN];
+    TEST_ASSERT_EQUAL(3, measurementsToFields(m, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("temp=-3.46,co2=415.0,ec=1251", out);
+
+    // -0.001 con 2 decimales no lleva signo
+    char v[8];
+    TEST_ASSERT_EQUAL(4, formatFixed(v, sizeof(v), -0.001f, 2));
+    TEST_ASSERT_EQUAL_STRING("0.00", v);
+    TEST_ASSERT_EQUAL(0, formatFixed(v, 4, 12.5f, 2));
+
+    // Solo campos enteros
+    char small[21];
+    TEST_ASSERT_EQUAL(2, measurementsToFields(m, small, sizeof(small)));
+    TEST_ASSERT_EQUAL_STRING("temp=-3.46,co2=415.0", small);
+}
+
+void testMeasurement_MeshRoundTripWithoutText() {
+    MeasurementSet m;
+    m.add(MEAS_TEMP, 25.3f, 0);
+    m.add(MEAS_HUM, 60.5f, 0);
+    m.add(MEAS_CO2, 412, 0);
+    m.addNamed("lux", 120, 0, 0);
+    m.add(MEAS_PRESS, 0, 0, MEAS_INVALID);
+
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 3, ORIGIN, 1);
+    TEST_ASSERT_TRUE(w.addReading(meshSensorHash("scd30"), m));
+
+    // El gateway decodifica los mismos campos; la inválida no viajó
+    MeshTlvReader reader(buf, w.length());
+    uint8_t type, valueLen;
+    const uint8_t* value;
+    char fields[UPLINK_FIELDS_LEN];
+    int fieldCount = -1;
+    while (reader.next(type, value, valueLen)) {
+        if (type == MESH_TLV_READING) fieldCount = meshReadingToFields(value, valueLen, fields, sizeof(fields));
+    }
+    TEST_ASSERT_EQUAL(4, fieldCount);
+    TEST_ASSERT_EQUAL_STRING("temp=25.30,hum=60.50,co2=412.0,lux=120", fields);
+
+    // Solo inválidas: no se agrega nada
+    MeasurementSet invalid;
+    invalid.add(MEAS_TEMP, -127, 0, MEAS_INVALID);
+    size_t before = w.length();
+    TEST_ASSERT_FALSE(w.addReading(2, invalid));
+    TEST_ASSERT_EQUAL(before, w.length());
+}
+
+void testMeasurement_TableKeyedByFieldAndName() {
+    MeasurementTable<int> t;
+    MeasurementSet m;
+    m.add(MEAS_TEMP, 21, 0);
+    m.addNamed("lux", 120, 0, 0);
+    m.addNamed("uv", 3, 0, 0);
+
+    bool added;
+    for (const Measurement& x : m) t.findOrAdd(x, added)->state = (int)x.value;
+    TEST_ASSERT_EQUAL(3, t.size());
+    TEST_ASSERT_FALSE(t.findOrAdd(m[0], added) == nullptr);
+    TEST_ASSERT_FALSE(added);
+
+    // Por nombre (configuración): "temp" es el campo de la tabla, no un MEAS_NAMED
+    TEST_ASSERT_EQUAL(21, t.find("temp")->state);
+    TEST_ASSERT_EQUAL(MEAS_TEMP, t.findOrAdd("temp", added)->field);
+    TEST_ASSERT_FALSE(added);
+    TEST_ASSERT_EQUAL(3, t.find(MEAS_NAMED, "uv")->state);
+    TEST_ASSERT_NULL(t.find(MEAS_NAMED, "temp"));
+
+    // Nombre largo o tabla llena: sin lugar
+    TEST_ASSERT_NULL(t.findOrAdd(MEAS_NAMED, "conductividad_total", added));
+    for (int i = 0; i < MEASUREMENT_MAX; i++) {
+        char name[8] = {'f', (char)('0' + i), '\0'};
+        t.findOrAdd(MEAS_NAMED, name, added);
+    }
+    TEST_ASSERT_EQUAL(MEASUREMENT_MAX, t.size());
+    TEST_ASSERT_NULL(t.findOrAdd(MEAS_NAMED, "otro", added));
+    TEST_ASSERT_FALSE(added);
+}
+
+void testMeasurement_FieldKeysEscaped() {
+    // Nombres de un mapa Modbus tal como vienen de config.json
+    MeasurementSet m;
+    m.addNamed("soil temp", 21.5f, 1, 0);
+    m.addNamed("a,b=c", 2, 0, 0);
+    m.addNamed("x\ny", 3, 0, 0);
+
+    char out[UPLINK_FIELDS_LEN];
+    TEST_ASSERT_EQUAL(3, measurementsToFields(m, out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("soil\\ temp=21.5,a\\,b\\=c=2,x\\ y=3", out);
+
+    // El largo cuenta los escapes: "soil\ temp=21.5" son 15 caracteres
+    char small[16];
+    TEST_ASSERT_EQUAL(1, measurementsToFields(m, small, sizeof(small)));
+    TEST_ASSERT_EQUAL_STRING("soil\\ temp=21.5", small);
+}
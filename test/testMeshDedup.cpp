@@ -0,0 +1,159 @@
+// Tests for MeshDedup (per-originator sliding-window duplicate filter)
+
+#include <unity.h>
+#include <chrono>
+#include <stdio.h>
+#include "MeshDedup.h"
+
+static void makeMac(uint8_t* mac, int n) {
+    mac[0] = 0x24; mac[1] = 0x6F; mac[2] = 0x28;
+    mac[3] = (n >> 16) & 0xFF; mac[4] = (n >> 8) & 0xFF; mac[5] = n & 0xFF;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testMeshDedup_NewPacketThenDuplicate() {
+    MeshDedup d;
+    uint8_t mac[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 42, 1000));
+    TEST_ASSERT_TRUE(d.checkAndMark(mac, 42, 1005));
+    TEST_ASSERT_TRUE(d.checkAndMark(mac, 42, 1010));
+    TEST_ASSERT_EQUAL(2, d.getStats().duplicates);
+}
+
+void testMeshDedup_OriginatorsAreIndependent() {
+    MeshDedup d;
+    uint8_t mac1[6] = {0xAA, 0xBB, 0xCC, 0xDD, 0xEE, 0xFF};
+    uint8_t mac2[6] = {0x11, 0x22, 0x33, 0x44, 0x55, 0x66};
+
+    TEST_ASSERT_FALSE(d.checkAndMark(mac1, 42, 1000));
+    TEST_ASSERT_FALSE(d.checkAndMark(mac2, 42, 1000));
+    TEST_ASSERT_FALSE(d.checkAndMark(mac1, 43, 1000));
+    TEST_ASSERT_EQUAL(2, d.getStats().originators);
+}
+
+void testMeshDedup_OutOfOrderInsideWindow() {
+    MeshDedup d;
+    uint8_t mac[6];
+    makeMac(mac, 1);
+
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 10, 0));
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 13, 0));
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 11, 0));   // Llegó tarde por otro camino
+    TEST_ASSERT_TRUE(d.checkAndMark(mac, 11, 0));
+    TEST_ASSERT_TRUE(d.checkAndMark(mac, 10, 0));
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 12, 0));
+    TEST_ASSERT_TRUE(d.checkAndMark(mac, 13, 0));
+}
+
+void testMeshDedup_RebootResetsWindow() {
+    MeshDedup d;
+    uint8_t mac[6];
+    makeMac(mac, 1);
+
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 500, 0));
+    // El originador reinició y su contador volvió a 0
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 0, 30000));
+    TEST_ASSERT_TRUE(d.checkAndMark(mac, 0, 30001));
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 1, 60000));
+    TEST_ASSERT_EQUAL(1, d.getStats().resets);
+}
+
+void testMeshDedup_IdleOriginatorForgotten() {
+    MeshDedup d;
+    uint8_t mac[6];
+    makeMac(mac, 1);
+
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 7, 1000));
+    TEST_ASSERT_TRUE(d.checkAndMark(mac, 7, 1000 + MESH_DEDUP_IDLE_MS));
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 7, 2000 + 2 * MESH_DEDUP_IDLE_MS));
+}
+
+void testMeshDedup_SequenceWrap() {
+    MeshDedup d;
+    uint8_t mac[6];
+    makeMac(mac, 1);
+
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 0xFFFFFFFE, 0));
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 0xFFFFFFFF, 0));
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 0, 0));
+    TEST_ASSERT_TRUE(d.checkAndMark(mac, 0xFFFFFFFF, 0));
+    TEST_ASSERT_EQUAL(0, d.getStats().resets);
+}
+
+void testMeshDedup_FullTableEvictsLeastRecent() {
+    MeshDedup d;
+    d.begin(4);
+    uint8_t mac[6];
+
+    for (int i = 0; i < 4; i++) {
+        makeMac(mac, i);
+        d.checkAndMark(mac, 1, 1000 + i);
+    }
+    makeMac(mac, 0);
+    d.checkAndMark(mac, 2, 2000);       // 0 vuelve a ser reciente: el más viejo es 1
+
+    makeMac(mac, 99);
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 1, 3000));
+    TEST_ASSERT_EQUAL(4, d.getStats().originators);
+    TEST_ASSERT_EQUAL(1, d.getStats().evictions);
+
+    // Los que quedaron siguen detectando duplicados
+    const int kept[] = {0, 2, 3};
+    for (int i : kept) {
+        makeMac(mac, i);
+        TEST_ASSERT_TRUE(d.checkAndMark(mac, 1, 3001));
+    }
+    // 1 fue desalojado: su paquete se acepta de nuevo
+    makeMac(mac, 1);
+    TEST_ASSERT_FALSE(d.checkAndMark(mac, 1, 3002));
+}
+
+void testMeshDedup_ChurnKeepsProbeChainsIntact() {
+    MeshDedup d;
+    d.begin(8);
+    uint8_t mac[6];
+
+    // Muchos originadores pasando por una tabla chica: cada inserción desaloja.
+    // El originador k siempre se ve en t = k, así el más viejo es el de menor k.
+    for (int round = 0; round < 200; round++) {
+        makeMac(mac, round);
+        TEST_ASSERT_FALSE(d.checkAndMark(mac, 5, round));
+        TEST_ASSERT_TRUE(d.checkAndMark(mac, 5, round));
+
+        // Los 8 más recientes tienen que seguir encontrándose
+        for (int back = 1; back < 8 && back <= round; back++) {
+            makeMac(mac, round - back);
+            TEST_ASSERT_TRUE(d.checkAndMark(mac, 5, round - back));
+        }
+    }
+    TEST_ASSERT_EQUAL(8, d.getStats().originators);
+    TEST_ASSERT_TRUE(d.getStats().maxProbe <= 16);
+}
+
+void testMeshDedup_FloodStormBenchmark() {
+    // 20 sensores, 4 saltos: cada paquete llega ~4 veces
+    const int SENSORS = 20, ROUNDS = 2000, COPIES = 4;
+    MeshDedup d;
+    uint8_t macs[SENSORS][6];
+    for (int i = 0; i < SENSORS; i++) makeMac(macs[i], i);
+
+    uint32_t accepted = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int r = 0; r < ROUNDS; r++) {
+        for (int c = 0; c < COPIES; c++) {
+            for (int i = 0; i < SENSORS; i++) {
+                if (!d.checkAndMark(macs[i], r, r * 100)) accepted++;
+            }
+        }
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(t1 - t0).count() / (ROUNDS * COPIES * SENSORS);
+    printf("[bench] dedup: %.0f ns/lookup, max probe %u\n", ns, d.getStats().maxProbe);
+
+    TEST_ASSERT_EQUAL(SENSORS * ROUNDS, accepted);
+    TEST_ASSERT_EQUAL(SENSORS * ROUNDS * (COPIES - 1), d.getStats().duplicates);
+}
@@ -0,0 +1,232 @@
+// Tests for MeshIngressQueue (mesh ingress ring with overflow policies)
+
+#include <unity.h>
+#include <stdio.h>
+#include <thread>
+#include "MeshIngressQueue.h"
+
+static MeshReading makeReading(int node, uint32_t seq, const char* sensorId = "scd30") {
+    MeshReading r;
+    memset(&r, 0, sizeof(r));
+    r.originatorMAC[0] = 0x24;
+    r.originatorMAC[5] = (uint8_t)node;
+    strncpy(r.sensorId, sensorId, sizeof(r.sensorId) - 1);
+    snprintf(r.fields, sizeof(r.fields), "temp=%d.00", 20 + node);
+    r.seq = seq;
+    return r;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testMeshIngress_FifoAndDepthRounding() {
+    MeshIngressQueue q;
+    q.begin(20, MESH_DROP_NEWEST);
+    TEST_ASSERT_EQUAL(32, q.capacity());
+
+    for (int i = 0; i < 5; i++) TEST_ASSERT_TRUE(q.push(makeReading(i, i), 0));
+    MeshReading r;
+    for (int i = 0; i < 5; i++) {
+        TEST_ASSERT_TRUE(q.pop(r, 0));
+        TEST_ASSERT_EQUAL(i, r.seq);
+    }
+    TEST_ASSERT_FALSE(q.pop(r, 0));
+}
+
+void testMeshIngress_DropNewestKeepsOldest() {
+    MeshIngressQueue q;
+    q.begin(4, MESH_DROP_NEWEST);
+    for (int i = 0; i < 6; i++) q.push(makeReading(i, i), 0);
+
+    TEST_ASSERT_EQUAL(4, q.size());
+    TEST_ASSERT_EQUAL(2, q.getStats().droppedNewest);
+    MeshReading r;
+    q.pop(r, 0);
+    TEST_ASSERT_EQUAL(0, r.seq);
+}
+
+void testMeshIngress_DropOldestKeepsNewest() {
+    MeshIngressQueue q;
+    q.begin(4, MESH_DROP_OLDEST);
+    for (int i = 0; i < 6; i++) TEST_ASSERT_TRUE(q.push(makeReading(i, i), 0));
+
+    TEST_ASSERT_EQUAL(4, q.size());
+    TEST_ASSERT_EQUAL(2, q.getStats().droppedOldest);
+    MeshReading r;
+    for (int expected = 2; expected < 6; expected++) {
+        TEST_ASSERT_TRUE(q.pop(r, 0));
+        TEST_ASSERT_EQUAL(expected, r.seq);
+    }
+}
+
+void testMeshIngress_CoalesceReplacesSameOriginator() {
+    MeshIngressQueue q;
+    q.begin(4, MESH_COALESCE);
+    q.push(makeReading(1, 10), 100);
+    q.push(makeReading(2, 20), 100);
+    q.push(makeReading(3, 30), 100);
+    q.push(makeReading(4, 40), 100);
+
+    // Lleno: la lectura nueva del nodo 2 reemplaza a la anterior en su lugar
+    TEST_ASSERT_TRUE(q.push(makeReading(2, 21), 150));
+    TEST_ASSERT_EQUAL(1, q.getStats().coalesced);
+    TEST_ASSERT_EQUAL(4, q.size());
+
+    MeshReading r;
+    q.pop(r, 200);
+    TEST_ASSERT_EQUAL(10, r.seq);
+    q.pop(r, 200);
+    TEST_ASSERT_EQUAL(21, r.seq);
+    TEST_ASSERT_EQUAL(100, r.enqueuedMs);   // La latencia cuenta desde la primera
+}
+
+void testMeshIngress_CoalesceDistinguishesSensors() {
+    MeshIngressQueue q;
+    q.begin(2, MESH_COALESCE);
+    q.push(makeReading(1, 1, "scd30"), 0);
+    q.push(makeReading(1, 2, "bme280"), 0);
+
+    // Mismo nodo, otro sensor y sin lectura propia en cola: se descarta la más vieja
+    TEST_ASSERT_TRUE(q.push(makeReading(1, 3, "dht22"), 0));
+    TEST_ASSERT_EQUAL(0, q.getStats().coalesced);
+    TEST_ASSERT_EQUAL(1, q.getStats().droppedOldest);
+
+    MeshReading r;
+    q.pop(r, 0);
+    TEST_ASSERT_EQUAL_STRING("bme280", r.sensorId);
+}
+
+void testMeshIngress_OccupancyAndLatencyHistograms() {
+    MeshIngressQueue q;
+    q.begin(4, MESH_DROP_NEWEST);
+    for (int i = 0; i < 5; i++) q.push(makeReading(i, i), 1000);
+
+    const MeshIngressStats& s = q.getStats();
+    // Ocupación al hacer push: 0, 1, 2, 3 (de 4) y lleno
+    TEST_ASSERT_EQUAL(1, s.occupancy[0]);
+    TEST_ASSERT_EQUAL(1, s.occupancy[1]);
+    TEST_ASSERT_EQUAL(1, s.occupancy[2]);
+    TEST_ASSERT_EQUAL(1, s.occupancy[3]);
+    TEST_ASSERT_EQUAL(1, s.occupancy[4]);
+    TEST_ASSERT_EQUAL(4, s.highWater);
+
+    MeshReading r;
+    q.pop(r, 1005);     // 5 ms
+    q.pop(r, 1050);     // 50 ms
+    q.pop(r, 1700);     // 700 ms
+    q.pop(r, 9000);     // 8 s
+    TEST_ASSERT_EQUAL(1, s.latency[0]);
+    TEST_ASSERT_EQUAL(1, s.latency[1]);
+    TEST_ASSERT_EQUAL(0, s.latency[2]);
+    TEST_ASSERT_EQUAL(1, s.latency[3]);
+    TEST_ASSERT_EQUAL(1, s.latency[5]);
+    TEST_ASSERT_EQUAL(8000, s.maxLatencyMs);
+}
+
+void testMeshIngress_MeshWakeUpBurst() {
+    // 20 nodos despiertan a la vez; el loop drena cada 100 ms
+    MeshIngressQueue q;
+    q.begin(MESH_INGRESS_DEFAULT_DEPTH, MESH_DROP_OLDEST);
+    for (int node = 0; node < 20; node++) {
+        TEST_ASSERT_TRUE(q.push(makeReading(node, 1), 0));
+    }
+    TEST_ASSERT_EQUAL(0, q.getStats().droppedNewest + q.getStats().droppedOldest);
+
+    MeshReading r;
+    int delivered = 0;
+    while (q.pop(r, 100)) delivered++;
+    TEST_ASSERT_EQUAL(20, delivered);
+}
+
+// Productor y consumidor en hilos distintos: nada se entrega dos veces ni
+// fuera de orden, y entregados + descartados = enviados
+static void runConcurrent(MeshOverflowPolicy policy) {
+    static MeshIngressQueue q;
+    q.begin(8, policy);
+    const uint32_t COUNT = 30000;
+    std::atomic<bool> done(false);
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < COUNT; i++) {
+            q.push(makeReading(i % 3, i), i);
+            if ((i & 7) == 0) std::this_thread::yield();
+        }
+        done = true;
+    });
+
+    uint32_t delivered = 0;
+    uint32_t last[3] = {0, 0, 0};
+    bool first[3] = {true, true, true};
+    bool ordered = true;
+    MeshReading r;
+    for (;;) {
+        if (q.pop(r, 0)) {
+            int node = r.originatorMAC[5];
+            if (!first[node] && r.seq <= last[node]) ordered = false;
+            first[node] = false;
+            last[node] = r.seq;
+            delivered++;
+        } else if (done && q.size() == 0) {
+            break;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    const MeshIngressStats& s = q.getStats();
+    TEST_ASSERT_TRUE(ordered);
+    TEST_ASSERT_EQUAL(s.delivered, delivered);
+    TEST_ASSERT_EQUAL(COUNT, delivered + s.droppedNewest + s.droppedOldest + s.coalesced);
+}
+
+void testMeshIngress_ConcurrentDropOldest() {
+    runConcurrent(MESH_DROP_OLDEST);
+}
+
+void testMeshIngress_ConcurrentCoalesce() {
+    runConcurrent(MESH_COALESCE);
+}
+
+// Productor que corre entre la lectura de tail y el CAS del consumidor
+static int raceHookCalls = 0;
+static void pushDuringPop(MeshIngressQueue* q) {
+    if (raceHookCalls++ == 0) q->push(makeReading(0, 4), 0);
+}
+
+void testMeshIngress_DropOldestDuringPopKeepsOrder() {
+    // Cola llena: mientras el consumidor va a tomar la más vieja (seq 0), el
+    // productor la descarta y escribe la nueva (seq 4) en el mismo slot
+    static MeshIngressQueue q;
+    q.begin(4, MESH_DROP_OLDEST);
+    for (int i = 0; i < 4; i++) q.push(makeReading(0, i), 0);
+    raceHookCalls = 0;
+    q.popRaceHook = pushDuringPop;
+
+    MeshReading r;
+    for (uint32_t expected = 1; expected <= 4; expected++) {
+        TEST_ASSERT_TRUE(q.pop(r, 0));
+        TEST_ASSERT_EQUAL(expected, r.seq);
+    }
+    q.popRaceHook = nullptr;
+    TEST_ASSERT_FALSE(q.pop(r, 0));
+    TEST_ASSERT_EQUAL(0, q.size());
+    TEST_ASSERT_EQUAL(1, q.getStats().droppedOldest);
+
+    // La cola sigue funcionando
+    TEST_ASSERT_TRUE(q.push(makeReading(0, 5), 0));
+    TEST_ASSERT_TRUE(q.pop(r, 0));
+    TEST_ASSERT_EQUAL(5, r.seq);
+    TEST_ASSERT_EQUAL(0, q.getStats().droppedNewest);
+}
+
+void testMeshIngress_ParsePolicy() {
+    MeshOverflowPolicy p;
+    TEST_ASSERT_TRUE(parseMeshOverflowPolicy("coalesce", p));
+    TEST_ASSERT_EQUAL(MESH_COALESCE, p);
+    TEST_ASSERT_TRUE(parseMeshOverflowPolicy("drop_newest", p));
+    TEST_ASSERT_EQUAL(MESH_DROP_NEWEST, p);
+    TEST_ASSERT_FALSE(parseMeshOverflowPolicy("fifo", p));
+    TEST_ASSERT_EQUAL_STRING("drop_newest", meshOverflowPolicyName(p));
+}
@@ -0,0 +1,320 @@
+// Tests for MeshPayload (binary TLV mesh data frame)
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include "MeshPayload.h"
+
+static const uint8_t ORIGIN[6] = {0x24, 0x6F, 0x28, 0xAA, 0xBB, 0xCC};
+
+// "temp=25.30,lux=120" → MeasurementSet con los decimales del texto (solo para escribir los casos)
+static MeasurementSet readingOf(const char* text) {
+    static char names[MEASUREMENT_MAX][16];
+    MeasurementSet set;
+    for (const char* p = text; *p && set.size() < MEASUREMENT_MAX; ) {
+        const char* eq = strchr(p, '=');
+        const char* end = strchr(eq, ',');
+        if (!end) end = eq + strlen(eq);
+        const char* dot = (const char*)memchr(eq, '.', end - eq);
+        char* name = names[set.size()];
+        snprintf(name, sizeof(names[0]), "%.*s", (int)(eq - p), p);
+        set.addNamed(name, strtof(eq + 1, nullptr), dot ? end - dot - 1 : 0, 0);
+        p = *end ? end + 1 : end;
+    }
+    return set;
+}
+
+// Decodifica la primera lectura de la trama en out; devuelve la cantidad de campos
+static int firstReading(const uint8_t* frame, size_t len, char* out, size_t cap, uint16_t* hash = nullptr) {
+    MeshTlvReader reader(frame, len);
+    uint8_t type, valueLen;
+    const uint8_t* value;
+    while (reader.next(type, value, valueLen)) {
+        if (type != MESH_TLV_READING) continue;
+        if (hash) *hash = meshTlvHash(value);
+        return meshReadingToFields(value, valueLen, out, cap);
+    }
+    return -1;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testMeshPayload_RoundTripKnownFields() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 3, ORIGIN, 0x01020304);
+    TEST_ASSERT_TRUE(w.addReading(meshSensorHash("scd30"), readingOf("temp=25.30,hum=60.50,co2=412.00")));
+
+    MeshFrameHeader hdr;
+    TEST_ASSERT_TRUE(parseMeshFrameHeader(buf, w.length(), hdr));
+    TEST_ASSERT_EQUAL(3, hdr.hopCount);
+    TEST_ASSERT_EQUAL_UINT32(0x01020304, hdr.sequence);
+    TEST_ASSERT_EQUAL_MEMORY(ORIGIN, hdr.originatorMAC, 6);
+
+    char fields[UPLINK_FIELDS_LEN];
+    uint16_t hash = 0;
+    TEST_ASSERT_EQUAL(3, firstReading(buf, w.length(), fields, sizeof(fields), &hash));
+    TEST_ASSERT_EQUAL_STRING("temp=25.30,hum=60.50,co2=412.0", fields);
+    TEST_ASSERT_EQUAL_UINT16(meshSensorHash("scd30"), hash);
+}
+
+void testMeshPayload_CompactEncoding() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 1);
+    w.addReading(1, readingOf("temp=21.50,hum=48.00"));
+
+    // Cabecera + TLV(2) + hash(2) + 2 campos int16 de 3 bytes
+    TEST_ASSERT_EQUAL(MESH_FRAME_HEADER + 2 + 2 + 3 + 3, w.length());
+}
+
+void testMeshPayload_WideValuesUseInt32() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 1);
+    // 1013.25 hPa * 100 y 3500 ppm * 10 no entran en int16
+    TEST_ASSERT_TRUE(w.addReading(1, readingOf("press=1013.25,co2=3500.0,temp=-12.75")));
+
+    char fields[UPLINK_FIELDS_LEN];
+    TEST_ASSERT_EQUAL(3, firstReading(buf, w.length(), fields, sizeof(fields)));
+    TEST_ASSERT_EQUAL_STRING("press=1013.25,co2=3500.0,temp=-12.75", fields);
+}
+
+void testMeshPayload_UnknownFieldTravelsByName() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 1);
+    TEST_ASSERT_TRUE(w.addReading(1, readingOf("lux=1234.5,soilHum=33.10,vbat=3.712")));
+
+    char fields[UPLINK_FIELDS_LEN];
+    TEST_ASSERT_EQUAL(3, firstReading(buf, w.length(), fields, sizeof(fields)));
+    TEST_ASSERT_EQUAL_STRING("lux=1234.5,soilHum=33.10,vbat=3.712", fields);
+}
+
+void testMeshPayload_NonNumericValuesSkipped() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 1);
+    TEST_ASSERT_TRUE(w.addReading(1, readingOf("temp=nan,hum=55.00")));
+    TEST_ASSERT_FALSE(w.addReading(2, readingOf("temp=nan")));   // Sin campos válidos: no se agrega
+    TEST_ASSERT_EQUAL(1, w.readingCount());
+
+    char fields[UPLINK_FIELDS_LEN];
+    TEST_ASSERT_EQUAL(1, firstReading(buf, w.length(), fields, sizeof(fields)));
+    TEST_ASSERT_EQUAL_STRING("hum=55.00", fields);
+}
+
+void testMeshPayload_SeveralSensorsInOneFrame() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 7);
+    TEST_ASSERT_TRUE(w.addReading(meshSensorHash("scd30"), readingOf("temp=25.30,hum=60.50,co2=412.00"), "scd30"));
+    TEST_ASSERT_TRUE(w.addReading(meshSensorHash("bme280"), readingOf("temp=24.90,hum=58.10,press=1009.80"), "bme280"));
+    TEST_ASSERT_TRUE(w.addReading(meshSensorHash("npk"), readingOf("soilHum=31.2,soilTemp=19.4,ec=820,ph=6.8,n=12,p=8,k=40"), "npk"));
+    TEST_ASSERT_EQUAL(3, w.readingCount());
+    // Tres tramas fijas de 56 bytes no alcanzaban para el NPK; acá entran con nombres
+    TEST_ASSERT_TRUE(w.length() < 120);
+
+    MeshNameTable names;
+    MeshTlvReader reader(buf, w.length());
+    uint8_t type, valueLen;
+    const uint8_t* value;
+    int readings = 0;
+    char fields[UPLINK_FIELDS_LEN];
+    while (reader.next(type, value, valueLen)) {
+        if (type == MESH_TLV_SENSOR_NAME) {
+            names.learn(ORIGIN, meshTlvHash(value), (const char*)value + 2, valueLen - 2);
+        } else if (type == MESH_TLV_READING) {
+            const char* name = names.lookup(ORIGIN, meshTlvHash(value));
+            TEST_ASSERT_NOT_NULL(name);
+            TEST_ASSERT_TRUE(meshReadingToFields(value, valueLen, fields, sizeof(fields)) > 0);
+            if (readings == 2) {
+                TEST_ASSERT_EQUAL_STRING("npk", name);
+                TEST_ASSERT_EQUAL_STRING("soilHum=31.20,soilTemp=19.4,ec=820,ph=6.8,n=12,p=8,k=40", fields);
+            }
+            readings++;
+        }
+    }
+    TEST_ASSERT_FALSE(reader.isTruncated());
+    TEST_ASSERT_EQUAL(3, readings);
+}
+
+void testMeshPayload_FullFrameRejectsAtomically() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 1);
+    int added = 0;
+    while (w.addReading(added, readingOf("temp=25.30,hum=60.50,co2=412.00"), "sensor-with-a-long-name")) added++;
+
+    TEST_ASSERT_TRUE(added > 3);
+    size_t before = w.length();
+    TEST_ASSERT_TRUE(before <= MESH_FRAME_MAX);
+    // El intento fallido no dejó el nombre ni una lectura a medias
+    TEST_ASSERT_FALSE(w.addReading(999, readingOf("temp=25.30,hum=60.50,co2=412.00"), "sensor-with-a-long-name"));
+    TEST_ASSERT_EQUAL(before, w.length());
+
+    MeshTlvReader reader(buf, w.length());
+    uint8_t type, valueLen;
+    const uint8_t* value;
+    int tlvs = 0;
+    while (reader.next(type, value, valueLen)) tlvs++;
+    TEST_ASSERT_FALSE(reader.isTruncated());
+    TEST_ASSERT_EQUAL(added * 2, tlvs);
+}
+
+void testMeshPayload_UnknownTlvAndFieldSkipped() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 1);
+    size_t len = w.length();
+
+    // TLV de un tipo futuro y una lectura con un campo id 60 (int16) que este firmware no conoce
+    const uint8_t tail[] = {
+        9, 1, 0xAB,
+        MESH_TLV_READING, 2 + 3 + 3, 0x01, 0x00,
+        60, 0x10, 0x00,
+        1, 0xD0, 0x07,   // temp = 2000 → 20.00
+    };
+    memcpy(&buf[len], tail, sizeof(tail));
+    len += sizeof(tail);
+
+    char fields[UPLINK_FIELDS_LEN];
+    TEST_ASSERT_EQUAL(1, firstReading(buf, len, fields, sizeof(fields)));
+    TEST_ASSERT_EQUAL_STRING("temp=20.00", fields);
+}
+
+void testMeshPayload_TruncatedFrameDetected() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 1);
+    w.addReading(1, readingOf("temp=20.00,hum=50.00"));
+
+    MeshTlvReader reader(buf, w.length() - 2);
+    uint8_t type, valueLen;
+    const uint8_t* value;
+    TEST_ASSERT_FALSE(reader.next(type, value, valueLen));
+    TEST_ASSERT_TRUE(reader.isTruncated());
+
+    MeshFrameHeader hdr;
+    TEST_ASSERT_FALSE(parseMeshFrameHeader(buf, MESH_FRAME_HEADER - 1, hdr));
+    buf[1] = 3;   // Versión desconocida
+    TEST_ASSERT_FALSE(parseMeshFrameHeader(buf, w.length(), hdr));
+}
+
+void testMeshPayload_CycleAgesPatchedOnSend() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 1);
+
+    // Tres ciclos de 30 s en la misma trama, enviada 1 s después del último
+    for (uint32_t cycle = 0; cycle < 3; cycle++) {
+        TEST_ASSERT_TRUE(w.beginCycle(10000 + cycle * 30000));
+        char m[32];
+        snprintf(m, sizeof(m), "temp=2%u.00", (unsigned)cycle);
+        TEST_ASSERT_TRUE(w.addReading(1, readingOf(m)));
+    }
+    w.finish(10000 + 2 * 30000 + 1000);
+    TEST_ASSERT_EQUAL(3, w.cycleCount());
+
+    MeshTlvReader reader(buf, w.length());
+    uint8_t type, valueLen;
+    const uint8_t* value;
+    uint16_t age = 0;
+    uint16_t ages[3];
+    int n = 0;
+    char fields[UPLINK_FIELDS_LEN];
+    while (reader.next(type, value, valueLen)) {
+        if (type == MESH_TLV_AGE) age = meshTlvHash(value);
+        if (type == MESH_TLV_READING) {
+            meshReadingToFields(value, valueLen, fields, sizeof(fields));
+            ages[n++] = age;
+        }
+    }
+    TEST_ASSERT_EQUAL(3, n);
+    TEST_ASSERT_EQUAL(61, ages[0]);
+    TEST_ASSERT_EQUAL(31, ages[1]);
+    TEST_ASSERT_EQUAL(1, ages[2]);
+    TEST_ASSERT_EQUAL_STRING("temp=22.00", fields);
+
+    // Límite de marcas por trama
+    for (int i = 3; i < MESH_MAX_CYCLE_MARKS; i++) TEST_ASSERT_TRUE(w.beginCycle(0));
+    TEST_ASSERT_FALSE(w.beginCycle(0));
+}
+
+void testMeshPayload_TxTimePatchedOnSend() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 1);
+    uint32_t txMs = 0;
+    TEST_ASSERT_FALSE(findMeshTxTime(buf, w.length(), txMs));
+
+    TEST_ASSERT_TRUE(w.markTxTime());
+    TEST_ASSERT_FALSE(w.markTxTime());   // Una sola por trama
+    TEST_ASSERT_TRUE(w.addReading(1, readingOf("temp=21.00")));
+    w.finish(0x12345678);
+
+    TEST_ASSERT_TRUE(findMeshTxTime(buf, w.length(), txMs));
+    TEST_ASSERT_EQUAL_UINT32(0x12345678, txMs);
+    char fields[UPLINK_FIELDS_LEN];
+    TEST_ASSERT_EQUAL(1, firstReading(buf, w.length(), fields, sizeof(fields)));
+}
+
+void testMeshPayload_NameTableEvictsLeastRecent() {
+    MeshNameTable names;
+    uint8_t mac[6] = {1, 2, 3, 4, 5, 0};
+    for (int i = 0; i < MESH_NAME_TABLE_SIZE; i++) {
+        mac[5] = i;
+        names.learn(mac, 100, "s", 1);
+    }
+    mac[5] = 0;
+    TEST_ASSERT_NOT_NULL(names.lookup(mac, 100));   // Refresca el nodo 0
+
+    mac[5] = 200;
+    names.learn(mac, 100, "nuevo", 5);
+    mac[5] = 1;
+    TEST_ASSERT_NULL(names.lookup(mac, 100));        // El menos usado salió
+    mac[5] = 0;
+    TEST_ASSERT_NOT_NULL(names.lookup(mac, 100));
+    // Mismo hash, otro originador: no se confunden
+    mac[5] = 201;
+    TEST_ASSERT_NULL(names.lookup(mac, 100));
+}
+
+void testMeshPayload_HostileFieldNameSkipped() {
+    uint8_t buf[MESH_FRAME_MAX];
+    MeshFrameWriter w(buf, sizeof(buf));
+    w.begin(4, 4, ORIGIN, 1);
+    size_t len = w.length();
+
+    // Nombres armados a mano: uno que inyectaría una línea y uno vacío, entre dos campos válidos
+    const char evil[] = "x=1\nhack,a";
+    uint8_t tail[64];
+    size_t n = 0;
+    tail[n++] = MESH_TLV_READING;
+    tail[n++] = 0;   // Largo, abajo
+    tail[n++] = 0x01;
+    tail[n++] = 0x00;
+    tail[n++] = 1; tail[n++] = 0xD0; tail[n++] = 0x07;            // temp = 20.00
+    tail[n++] = MESH_FIELD_NAMED; tail[n++] = sizeof(evil) - 1;
+    memcpy(&tail[n], evil, sizeof(evil) - 1);
+    n += sizeof(evil) - 1;
+    tail[n++] = 0; tail[n++] = 5; tail[n++] = 0; tail[n++] = 0; tail[n++] = 0;
+    tail[n++] = MESH_FIELD_NAMED; tail[n++] = 3;
+    memcpy(&tail[n], "a b", 3);
+    n += 3;
+    tail[n++] = 0; tail[n++] = 6; tail[n++] = 0; tail[n++] = 0; tail[n++] = 0;
+    tail[n++] = MESH_FIELD_NAMED; tail[n++] = 5;
+    memcpy(&tail[n], "v_bat", 5);
+    n += 5;
+    tail[n++] = 0; tail[n++] = 7; tail[n++] = 0; tail[n++] = 0; tail[n++] = 0;
+    tail[1] = n - 2;
+    memcpy(&buf[len], tail, n);
+    len += n;
+
+    char fields[UPLINK_FIELDS_LEN];
+    TEST_ASSERT_EQUAL(2, firstReading(buf, len, fields, sizeof(fields)));
+    TEST_ASSERT_EQUAL_STRING("temp=20.00,v_bat=7", fields);
+}
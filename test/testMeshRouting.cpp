@@ -0,0 +1,179 @@
+// Tests for MeshRouter (gradient routing towards the gateway)
+
+#include <unity.h>
+#include "MeshRouting.h"
+
+static const uint8_t SELF[6] = {0x24, 0, 0, 0, 0, 0x01};
+static const uint8_t NONE[6] = {0, 0, 0, 0, 0, 0};
+static const uint32_t INTERVAL = 2000;
+
+static const uint8_t* mac(uint8_t id) {
+    static uint8_t m[6] = {0x24, 0, 0, 0, 0, 0};
+    m[5] = id;
+    return m;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testMeshRouting_RootAdvertisesZero() {
+    MeshRouter r;
+    r.begin(true, SELF, INTERVAL);
+    TEST_ASSERT_TRUE(r.hasParent());
+    TEST_ASSERT_EQUAL(0, r.hops());
+    TEST_ASSERT_EQUAL(0, r.cost());
+}
+
+void testMeshRouting_NoNeighborsNoRoute() {
+    MeshRouter r;
+    r.begin(false, SELF, INTERVAL);
+    TEST_ASSERT_FALSE(r.hasParent());
+    TEST_ASSERT_EQUAL(ROUTE_NO_HOPS, r.hops());
+    TEST_ASSERT_EQUAL(ROUTE_NO_COST, r.cost());
+
+    // Un vecino sin ruta tampoco sirve
+    r.onBeacon(mac(2), ROUTE_NO_HOPS, ROUTE_NO_COST, NONE, -60, 0);
+    TEST_ASSERT_FALSE(r.hasParent());
+}
+
+void testMeshRouting_PicksLowestPathCost() {
+    MeshRouter r;
+    r.begin(false, SELF, INTERVAL);
+    r.onBeacon(mac(20), 1, 11, mac(10), -55, 0);  // Relay con buen enlace
+    r.onBeacon(mac(10), 0, 0, NONE, -85, 0);      // Gateway con enlace malo
+    // Costo por el gateway: ETX(90) = 28; por el relay: 11 + ETX(230) = 22
+    TEST_ASSERT_EQUAL_MEMORY(mac(20), r.parent(), 6);
+    TEST_ASSERT_EQUAL(2, r.hops());
+    TEST_ASSERT_EQUAL(11 + MeshRouter::linkCost(230), r.cost());
+}
+
+void testMeshRouting_HysteresisAvoidsFlapping() {
+    MeshRouter r;
+    r.begin(false, SELF, INTERVAL);
+    r.onBeacon(mac(2), 1, 30, NONE, -60, 0);
+    TEST_ASSERT_EQUAL_MEMORY(mac(2), r.parent(), 6);
+
+    // Apenas mejor: no cambia
+    r.onBeacon(mac(3), 1, 27, NONE, -60, 100);
+    TEST_ASSERT_EQUAL_MEMORY(mac(2), r.parent(), 6);
+    TEST_ASSERT_EQUAL(1, r.getStats().parentChanges);
+
+    // Claramente mejor: cambia
+    r.onBeacon(mac(3), 1, 12, NONE, -60, 200);
+    TEST_ASSERT_EQUAL_MEMORY(mac(3), r.parent(), 6);
+    TEST_ASSERT_EQUAL(2, r.getStats().parentChanges);
+}
+
+void testMeshRouting_SilentParentExpires() {
+    MeshRouter r;
+    r.begin(false, SELF, INTERVAL);
+    r.onBeacon(mac(2), 0, 0, NONE, -60, 0);
+    r.onBeacon(mac(3), 1, 15, mac(2), -60, 0);
+    TEST_ASSERT_EQUAL_MEMORY(mac(2), r.parent(), 6);
+
+    // El gateway deja de emitir; el relay sigue
+    for (uint32_t t = INTERVAL; t <= 4 * INTERVAL; t += INTERVAL) r.onBeacon(mac(3), 1, 15, mac(2), -60, t);
+    TEST_ASSERT_EQUAL_MEMORY(mac(3), r.parent(), 6);
+    TEST_ASSERT_EQUAL(1, r.neighborCount());
+
+    // Nadie emite: sin ruta
+    TEST_ASSERT_TRUE(r.update(10 * INTERVAL));
+    TEST_ASSERT_FALSE(r.hasParent());
+}
+
+void testMeshRouting_AckFailuresMoveParent() {
+    MeshRouter r;
+    r.begin(false, SELF, INTERVAL);
+    r.onBeacon(mac(2), 1, 10, NONE, -60, 0);
+    r.onBeacon(mac(3), 1, 16, NONE, -60, 0);
+    TEST_ASSERT_EQUAL_MEMORY(mac(2), r.parent(), 6);
+
+    int fails = 0;
+    while (memcmp(r.parent(), mac(2), 6) == 0 && fails < 20) {
+        r.onTxResult(mac(2), false, 10);
+        fails++;
+    }
+    TEST_ASSERT_EQUAL_MEMORY(mac(3), r.parent(), 6);
+    TEST_ASSERT_TRUE(fails <= 8);
+    TEST_ASSERT_EQUAL(fails, r.getStats().txFail);
+}
+
+void testMeshRouting_MissedBeaconsLowerQuality() {
+    MeshRouter a, b;
+    a.begin(false, SELF, INTERVAL);
+    b.begin(false, SELF, INTERVAL);
+    // a escucha todos los beacons del vecino; b uno de cada tres
+    for (uint32_t t = 0; t <= 30 * INTERVAL; t += INTERVAL) a.onBeacon(mac(2), 0, 0, NONE, 0, t);
+    for (uint32_t t = 0; t <= 30 * INTERVAL; t += 3 * INTERVAL) b.onBeacon(mac(2), 0, 0, NONE, 0, t);
+
+    TEST_ASSERT_TRUE(a.neighbor(0)->quality > 240);
+    TEST_ASSERT_TRUE(b.neighbor(0)->quality < 120);
+    TEST_ASSERT_TRUE(b.cost() > a.cost());
+}
+
+void testMeshRouting_ChildIsNeverParent() {
+    MeshRouter r;
+    r.begin(false, SELF, INTERVAL);
+    r.onBeacon(mac(2), 0, 0, NONE, -60, 0);
+    // Un hijo que rutea por nosotros anuncia costo bajo pero no puede ser padre
+    r.onBeacon(mac(5), 1, 1, SELF, -50, 0);
+    TEST_ASSERT_EQUAL_MEMORY(mac(2), r.parent(), 6);
+
+    // Se cae el gateway: el hijo sigue sin servir (evita el lazo)
+    for (uint32_t t = INTERVAL; t <= 5 * INTERVAL; t += INTERVAL) r.onBeacon(mac(5), 1, 1, SELF, -50, t);
+    TEST_ASSERT_FALSE(r.hasParent());
+}
+
+void testMeshRouting_TooManyHopsIsNoRoute() {
+    MeshRouter r;
+    r.begin(false, SELF, INTERVAL);
+    r.onBeacon(mac(2), ROUTE_MAX_HOPS, 80, NONE, -60, 0);
+    TEST_ASSERT_FALSE(r.hasParent());
+    r.onBeacon(mac(3), ROUTE_MAX_HOPS - 1, 70, NONE, -60, 0);
+    TEST_ASSERT_TRUE(r.hasParent());
+    TEST_ASSERT_EQUAL(ROUTE_MAX_HOPS, r.hops());
+}
+
+void testMeshRouting_FullTableEvictsWorstNotParent() {
+    MeshRouter r;
+    r.begin(false, SELF, INTERVAL);
+    r.onBeacon(mac(1), 0, 0, NONE, -60, 0);
+    for (int i = 2; i <= ROUTE_MAX_NEIGHBORS; i++) r.onBeacon(mac(i), 2, 30 + i, NONE, -60, 0);
+    TEST_ASSERT_EQUAL(ROUTE_MAX_NEIGHBORS, r.neighborCount());
+
+    r.onBeacon(mac(100), 1, 12, NONE, -60, 0);
+    TEST_ASSERT_EQUAL(ROUTE_MAX_NEIGHBORS, r.neighborCount());
+    TEST_ASSERT_EQUAL(1, r.getStats().evictions);
+    TEST_ASSERT_EQUAL_MEMORY(mac(1), r.parent(), 6);
+
+    // Salió el más caro (16), siguen los demás
+    bool found16 = false, found100 = false;
+    for (int i = 0; i < ROUTE_MAX_NEIGHBORS; i++) {
+        const RouteNeighbor* n = r.neighbor(i);
+        if (n && n->mac[5] == 16) found16 = true;
+        if (n && n->mac[5] == 100) found100 = true;
+    }
+    TEST_ASSERT_FALSE(found16);
+    TEST_ASSERT_TRUE(found100);
+}
+
+void testMeshRouting_BeaconSeqTracksLossUnderTrickle() {
+    MeshRouter a, b;
+    a.begin(false, SELF, INTERVAL);
+    b.begin(false, SELF, INTERVAL);
+    // Vecino con intervalo Trickle de 64 s: a recibe todos sus beacons, b uno de cada tres
+    const uint32_t slow = 64000;
+    for (int s = 0; s <= 30; s++) a.onBeacon(mac(2), 0, 0, NONE, 0, s * slow, s, slow);
+    for (int s = 0; s <= 30; s += 3) b.onBeacon(mac(2), 0, 0, NONE, 0, s * slow, s, slow);
+
+    TEST_ASSERT_EQUAL(1, a.neighborCount());   // No se olvida con intervalos largos
+    TEST_ASSERT_TRUE(a.neighbor(0)->quality > 240);
+    TEST_ASSERT_TRUE(b.neighbor(0)->quality < 120);
+
+    // Silencio tolerado: ROUTE_NEIGHBOR_BEACONS veces el doble del intervalo anunciado
+    a.update(30 * slow + 2 * slow * ROUTE_NEIGHBOR_BEACONS);
+    TEST_ASSERT_EQUAL(1, a.neighborCount());
+    a.update(30 * slow + 2 * slow * ROUTE_NEIGHBOR_BEACONS + 1);
+    TEST_ASSERT_EQUAL(0, a.neighborCount());
+}
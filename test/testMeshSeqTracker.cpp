@@ -0,0 +1,108 @@
+// Tests for MeshSeqTracker (per-originator loss, reorder and latency stats)
+
+#include <unity.h>
+#include "MeshSeqTracker.h"
+
+static const uint8_t NODE_A[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x01};
+static const uint8_t NODE_B[6] = {0x24, 0x6F, 0x28, 0x00, 0x00, 0x02};
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testMeshSeqTracker_InOrderIsFullDelivery() {
+    MeshSeqTracker t;
+    for (uint32_t s = 5; s < 15; s++) t.onFrame(NODE_A, s, s * 100);
+
+    const MeshOriginatorStats* e = t.lookup(NODE_A);
+    TEST_ASSERT_NOT_NULL(e);
+    TEST_ASSERT_EQUAL_UINT32(10, e->received);
+    TEST_ASSERT_EQUAL_UINT32(10, e->expected);
+    TEST_ASSERT_EQUAL_UINT32(0, e->lost);
+    TEST_ASSERT_EQUAL(1000, MeshSeqTracker::deliveryPermille(*e));
+    TEST_ASSERT_NULL(t.lookup(NODE_B));
+}
+
+void testMeshSeqTracker_GapCountsLoss() {
+    MeshSeqTracker t;
+    t.onFrame(NODE_A, 1, 0);
+    t.onFrame(NODE_A, 2, 0);
+    t.onFrame(NODE_A, 6, 0);   // Faltan 3, 4 y 5
+    t.onFrame(NODE_A, 7, 0);
+
+    const MeshOriginatorStats* e = t.lookup(NODE_A);
+    TEST_ASSERT_EQUAL_UINT32(1, e->gaps);
+    TEST_ASSERT_EQUAL_UINT32(3, e->lost);
+    TEST_ASSERT_EQUAL_UINT32(7, e->expected);
+    TEST_ASSERT_EQUAL(571, MeshSeqTracker::deliveryPermille(*e));   // 4/7
+}
+
+void testMeshSeqTracker_LateFrameIsReorderNotLoss() {
+    MeshSeqTracker t;
+    t.onFrame(NODE_A, 1, 0);
+    t.onFrame(NODE_A, 3, 0);
+    t.onFrame(NODE_A, 2, 0);   // Llegó tarde
+
+    const MeshOriginatorStats* e = t.lookup(NODE_A);
+    TEST_ASSERT_EQUAL_UINT32(1, e->reordered);
+    TEST_ASSERT_EQUAL_UINT32(0, e->lost);
+    TEST_ASSERT_EQUAL(1000, MeshSeqTracker::deliveryPermille(*e));
+}
+
+void testMeshSeqTracker_SequenceResetIsReboot() {
+    MeshSeqTracker t;
+    for (uint32_t s = 100; s < 110; s++) t.onFrame(NODE_A, s, 0);
+    t.onFrame(NODE_A, 0, 1000);
+    t.onFrame(NODE_A, 1, 2000);
+
+    const MeshOriginatorStats* e = t.lookup(NODE_A);
+    TEST_ASSERT_EQUAL(1, e->reboots);
+    TEST_ASSERT_EQUAL_UINT32(0, e->reordered);
+    TEST_ASSERT_EQUAL_UINT32(0, e->lost);
+    TEST_ASSERT_EQUAL_UINT32(1, e->highest);
+    TEST_ASSERT_EQUAL_UINT32(12, e->expected);
+}
+
+void testMeshSeqTracker_LatencyRelativeToFastest() {
+    MeshSeqTracker t;
+    // Reloj del originador corrido 1000000 ms; tránsito de 5 ms salvo una trama demorada
+    const uint32_t skew = 1000000;
+    for (uint32_t s = 0; s < 10; s++) {
+        uint32_t tx = 30000 * s;
+        uint32_t transit = (s == 6) ? 85 : 5;
+        t.onFrame(NODE_A, s, skew + tx + transit, true, tx);
+    }
+
+    const MeshOriginatorStats* e = t.lookup(NODE_A);
+    TEST_ASSERT_EQUAL_UINT32(10, e->latencySamples);
+    TEST_ASSERT_EQUAL_UINT32(80, e->latencyMaxMs);
+    TEST_ASSERT_TRUE(e->latencyAvgMs > 0 && e->latencyAvgMs < 80);
+}
+
+void testMeshSeqTracker_FullTableReplacesQuietest() {
+    MeshSeqTracker t;
+    uint8_t mac[6] = {0x24, 0, 0, 0, 0, 0};
+    for (int i = 0; i < MESH_TRACK_MAX; i++) {
+        mac[5] = i;
+        t.onFrame(mac, 1, 1000 + i);
+    }
+    TEST_ASSERT_EQUAL(MESH_TRACK_MAX, t.size());
+
+    mac[5] = 0;
+    t.onFrame(mac, 2, 5000);   // El 0 vuelve a hablar: el más callado es el 1
+
+    mac[5] = 200;
+    t.onFrame(mac, 1, 6000);
+    TEST_ASSERT_EQUAL(MESH_TRACK_MAX, t.size());
+    TEST_ASSERT_EQUAL_UINT32(1, t.getEvictions());
+    TEST_ASSERT_NOT_NULL(t.lookup(mac));
+
+    mac[5] = 1;
+    TEST_ASSERT_NULL(t.lookup(mac));
+    for (int i = 2; i < MESH_TRACK_MAX; i++) {
+        mac[5] = i;
+        TEST_ASSERT_NOT_NULL(t.lookup(mac));
+    }
+    mac[5] = 0;
+    TEST_ASSERT_EQUAL_UINT32(2, t.lookup(mac)->received);
+}
@@ -0,0 +1,124 @@
+// Tests for ModbusLinkHealth (adaptive timeout and dead-device backoff)
+
+#include <unity.h>
+#include "ModbusLinkHealth.h"
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testModbusHealth_UnknownDeviceUsesMaxTimeout() {
+    ModbusLinkHealth h;
+    h.configure(9600, 2);
+
+    TEST_ASSERT_EQUAL_UINT32(MODBUS_TIMEOUT_MAX_MS, h.timeoutMs());
+    TEST_ASSERT_FALSE(h.shouldSkip(0));
+}
+
+void testModbusHealth_FrameTimeFromBaudrate() {
+    ModbusLinkHealth h;
+
+    // 2 registros: 8 + 9 bytes = 170 bits + 2 × t3.5 (70 bits) = 240 bits
+    h.configure(9600, 2);
+    TEST_ASSERT_EQUAL_UINT32(25, h.getFrameTimeMs());   // 240 / 9600 s = 25 ms
+
+    h.configure(19200, 2);
+    TEST_ASSERT_EQUAL_UINT32(13, h.getFrameTimeMs());   // 12.5 ms, redondeado hacia arriba
+}
+
+void testModbusHealth_TimeoutTracksLatency() {
+    ModbusLinkHealth h;
+    h.configure(9600, 2);
+
+    for (int i = 0; i < 30; i++) {
+        h.onSuccess(40);
+    }
+
+    // Latencia estable: media 40 ms, desvío ~0 → timeout cerca de la latencia
+    TEST_ASSERT_EQUAL_UINT32(40, h.getLatencyMs());
+    TEST_ASSERT_TRUE(h.timeoutMs() >= 40);
+    TEST_ASSERT_TRUE(h.timeoutMs() < 60);
+}
+
+void testModbusHealth_TimeoutNeverBelowFrameTime() {
+    ModbusLinkHealth h;
+    h.configure(9600, 2);
+
+    for (int i = 0; i < 30; i++) {
+        h.onSuccess(1);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(25 + MODBUS_TIMEOUT_SLACK_MS, h.timeoutMs());
+}
+
+void testModbusHealth_JitterWidensTimeout() {
+    ModbusLinkHealth steady, jittery;
+    steady.configure(9600, 2);
+    jittery.configure(9600, 2);
+
+    for (int i = 0; i < 20; i++) {
+        steady.onSuccess(50);
+        jittery.onSuccess(i % 2 ? 20 : 80);
+    }
+
+    TEST_ASSERT_TRUE(jittery.timeoutMs() > steady.timeoutMs());
+}
+
+void testModbusHealth_SingleFailureDoesNotBackOff() {
+    ModbusLinkHealth h;
+    h.configure(9600, 2);
+    h.onSuccess(30);
+
+    h.onFailure(1000);
+
+    TEST_ASSERT_FALSE(h.shouldSkip(1001));
+    TEST_ASSERT_EQUAL_UINT8(1, h.getConsecutiveFailures());
+}
+
+void testModbusHealth_BackoffDoublesAndCaps() {
+    ModbusLinkHealth h;
+    h.configure(9600, 2);
+
+    uint32_t now = 0;
+    h.onFailure(now);
+    h.onFailure(now);
+    TEST_ASSERT_EQUAL_UINT32(MODBUS_BACKOFF_BASE_MS, h.getBackoffMs());
+    TEST_ASSERT_TRUE(h.shouldSkip(now + MODBUS_BACKOFF_BASE_MS - 1));
+    TEST_ASSERT_FALSE(h.shouldSkip(now + MODBUS_BACKOFF_BASE_MS));   // Re-probe
+
+    now += MODBUS_BACKOFF_BASE_MS;
+    h.onFailure(now);
+    TEST_ASSERT_EQUAL_UINT32(2 * MODBUS_BACKOFF_BASE_MS, h.getBackoffMs());
+
+    for (int i = 0; i < 20; i++) {
+        h.onFailure(now);
+    }
+    TEST_ASSERT_EQUAL_UINT32(MODBUS_BACKOFF_MAX_MS, h.getBackoffMs());
+}
+
+void testModbusHealth_SuccessClearsBackoff() {
+    ModbusLinkHealth h;
+    h.configure(9600, 2);
+
+    h.onFailure(0);
+    h.onFailure(0);
+    TEST_ASSERT_TRUE(h.shouldSkip(1));
+
+    h.onSuccess(30);   // El re-probe respondió
+
+    TEST_ASSERT_FALSE(h.shouldSkip(2));
+    TEST_ASSERT_EQUAL_UINT8(0, h.getConsecutiveFailures());
+    TEST_ASSERT_EQUAL_UINT32(0, h.getBackoffMs());
+}
+
+void testModbusHealth_BackoffSurvivesMillisWrap() {
+    ModbusLinkHealth h;
+    h.configure(9600, 2);
+
+    uint32_t now = 0xFFFFFF00;
+    h.onFailure(now);
+    h.onFailure(now);
+
+    TEST_ASSERT_TRUE(h.shouldSkip(now + 1000));       // Desborda a un valor chico
+    TEST_ASSERT_FALSE(h.shouldSkip(now + MODBUS_BACKOFF_BASE_MS));
+}
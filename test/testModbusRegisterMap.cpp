@@ -0,0 +1,121 @@
+// Tests for ModbusRegisterMap (block-read coalescing and field decoding)
+
+#include <unity.h>
+#include "ModbusRegisterMap.h"
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testModbusMap_NpkPresetIsOneBlock() {
+    const ModbusPreset* p = findModbusPreset("npk_7in1");
+    TEST_ASSERT_NOT_NULL(p);
+
+    ModbusBlock blocks[MODBUS_SENSOR_MAX_BLOCKS];
+    int n = planModbusBlocks(p->fields, p->fieldCount, 16, MODBUS_COALESCE_MAX_GAP, blocks, MODBUS_SENSOR_MAX_BLOCKS);
+
+    // 7 parámetros de suelo en una sola trama
+    TEST_ASSERT_EQUAL(1, n);
+    TEST_ASSERT_EQUAL(0, blocks[0].start);
+    TEST_ASSERT_EQUAL(7, blocks[0].count);
+}
+
+void testModbusMap_UnorderedFieldsAreSorted() {
+    const ModbusPreset* p = findModbusPreset("th_mb_04s");
+    TEST_ASSERT_NOT_NULL(p);
+
+    // El preset lista temp (reg 1) antes que hum (reg 0)
+    ModbusBlock blocks[MODBUS_SENSOR_MAX_BLOCKS];
+    int n = planModbusBlocks(p->fields, p->fieldCount, 16, MODBUS_COALESCE_MAX_GAP, blocks, MODBUS_SENSOR_MAX_BLOCKS);
+
+    TEST_ASSERT_EQUAL(1, n);
+    TEST_ASSERT_EQUAL(0, blocks[0].start);
+    TEST_ASSERT_EQUAL(2, blocks[0].count);
+}
+
+void testModbusMap_SmallGapIsCoalesced() {
+    ModbusFieldDesc f[] = {
+        {"a", 10, MB_U16, 1.0f, 0},
+        {"b", 14, MB_U32, 1.0f, 0},   // 3 registros sin usar en el medio
+    };
+    ModbusBlock blocks[MODBUS_SENSOR_MAX_BLOCKS];
+    int n = planModbusBlocks(f, 2, 16, 4, blocks, MODBUS_SENSOR_MAX_BLOCKS);
+
+    TEST_ASSERT_EQUAL(1, n);
+    TEST_ASSERT_EQUAL(10, blocks[0].start);
+    TEST_ASSERT_EQUAL(6, blocks[0].count);
+    TEST_ASSERT_EQUAL(0, findModbusBlock(blocks, n, f[1]));
+}
+
+void testModbusMap_LargeGapSplitsBlocks() {
+    ModbusFieldDesc f[] = {
+        {"a", 0,    MB_U16, 1.0f, 0},
+        {"b", 1,    MB_U16, 1.0f, 0},
+        {"cfg", 2000, MB_U16, 1.0f, 0},
+    };
+    ModbusBlock blocks[MODBUS_SENSOR_MAX_BLOCKS];
+    int n = planModbusBlocks(f, 3, 16, 4, blocks, MODBUS_SENSOR_MAX_BLOCKS);
+
+    TEST_ASSERT_EQUAL(2, n);
+    TEST_ASSERT_EQUAL(0, blocks[0].start);
+    TEST_ASSERT_EQUAL(2, blocks[0].count);
+    TEST_ASSERT_EQUAL(2000, blocks[1].start);
+    TEST_ASSERT_EQUAL(1, findModbusBlock(blocks, n, f[2]));
+}
+
+void testModbusMap_BlockLimitedByMaxRegs() {
+    ModbusFieldDesc f[] = {
+        {"a", 0, MB_U16, 1.0f, 0},
+        {"b", 3, MB_U16, 1.0f, 0},
+        {"c", 6, MB_U16, 1.0f, 0},
+    };
+    ModbusBlock blocks[MODBUS_SENSOR_MAX_BLOCKS];
+    int n = planModbusBlocks(f, 3, 4, 4, blocks, MODBUS_SENSOR_MAX_BLOCKS);
+
+    TEST_ASSERT_EQUAL(2, n);
+    TEST_ASSERT_EQUAL(4, blocks[0].count);
+    TEST_ASSERT_EQUAL(6, blocks[1].start);
+}
+
+void testModbusMap_TooManyBlocksFails() {
+    ModbusFieldDesc f[] = {
+        {"a", 0,   MB_U16, 1.0f, 0},
+        {"b", 100, MB_U16, 1.0f, 0},
+        {"c", 200, MB_U16, 1.0f, 0},
+    };
+    ModbusBlock blocks[2];
+    TEST_ASSERT_EQUAL(-1, planModbusBlocks(f, 3, 16, 4, blocks, 2));
+}
+
+void testModbusMap_DecodeTypes() {
+    // Ejemplo del datasheet SN-3002: humedad 0x0292, temperatura 0xFF9B
+    uint16_t regs[] = {0x0292, 0xFF9B, 0x03E8, 0x0038};
+
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 65.8, decodeModbusField(&regs[0], MB_U16, 0.1f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, -10.1, decodeModbusField(&regs[1], MB_S16, 0.1f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 1000, decodeModbusField(&regs[2], MB_U16, 1.0f));
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 5.6, decodeModbusField(&regs[3], MB_U16, 0.1f));
+
+    uint16_t u32[] = {0x0001, 0x0002};
+    TEST_ASSERT_FLOAT_WITHIN(0.5, 65538, decodeModbusField(u32, MB_U32, 1.0f));
+
+    uint16_t s32[] = {0xFFFF, 0xFFFE};
+    TEST_ASSERT_FLOAT_WITHIN(0.001, -2, decodeModbusField(s32, MB_S32, 1.0f));
+
+    uint16_t f32[] = {0x41C8, 0x0000};   // 25.0f
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 25.0, decodeModbusField(f32, MB_F32, 1.0f));
+}
+
+void testModbusMap_ParseTypeAndDecimals() {
+    ModbusDataType t;
+    TEST_ASSERT_TRUE(parseModbusType("s16", t));
+    TEST_ASSERT_EQUAL(MB_S16, t);
+    TEST_ASSERT_TRUE(parseModbusType("f32", t));
+    TEST_ASSERT_EQUAL(MB_F32, t);
+    TEST_ASSERT_FALSE(parseModbusType("int", t));
+
+    TEST_ASSERT_EQUAL(1, modbusScaleDecimals(0.1f));
+    TEST_ASSERT_EQUAL(2, modbusScaleDecimals(0.01f));
+    TEST_ASSERT_EQUAL(0, modbusScaleDecimals(1.0f));
+    TEST_ASSERT_EQUAL(0, modbusScaleDecimals(10.0f));
+}
@@ -0,0 +1,52 @@
+// Tests for OneWireConversion (split-phase DS18B20 conversion per bus)
+
+#include <unity.h>
+#include "OneWireConversion.h"
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testOneWireConversion_TimeByResolution() {
+    TEST_ASSERT_EQUAL(94, OneWireConversion::conversionMs(9));
+    TEST_ASSERT_EQUAL(188, OneWireConversion::conversionMs(10));
+    TEST_ASSERT_EQUAL(375, OneWireConversion::conversionMs(11));
+    TEST_ASSERT_EQUAL(750, OneWireConversion::conversionMs(12));
+}
+
+void testOneWireConversion_PendingUntilDeadline() {
+    OneWireConversion c;
+    c.begin(OneWireConversion::conversionMs(12));
+    TEST_ASSERT_FALSE(c.pending(0));
+
+    TEST_ASSERT_TRUE(c.start(1000));
+    TEST_ASSERT_TRUE(c.pending(1100));   // Antes se leía aquí: 85.0 "no listo"
+    TEST_ASSERT_TRUE(c.pending(1749));
+    TEST_ASSERT_FALSE(c.pending(1750));
+    TEST_ASSERT_EQUAL_UINT32(750, c.getLastDurationMs());
+}
+
+void testOneWireConversion_ProbesJoinRunningConversion() {
+    OneWireConversion c;
+    TEST_ASSERT_TRUE(c.start(0));
+    TEST_ASSERT_FALSE(c.start(10));   // Segunda sonda del bus: sin otro Convert T
+    TEST_ASSERT_FALSE(c.start(400));
+    TEST_ASSERT_FALSE(c.pending(750));
+
+    TEST_ASSERT_TRUE(c.start(10000));  // Próximo período: conversión nueva
+    TEST_ASSERT_EQUAL_UINT32(2, c.getConversions());
+}
+
+void testOneWireConversion_EarlyCompletion() {
+    OneWireConversion c;
+    c.start(0);
+    c.complete(610);                   // El bus avisó que terminó
+    TEST_ASSERT_FALSE(c.pending(611));
+    TEST_ASSERT_EQUAL_UINT32(610, c.getLastDurationMs());
+    TEST_ASSERT_EQUAL_UINT32(1, c.getEarlyCompletions());
+
+    // Alimentación parásita: requestTemperatures() ya esperó
+    c.begin(0);
+    c.start(5000);
+    TEST_ASSERT_FALSE(c.pending(5000));
+}
@@ -0,0 +1,121 @@
+// Tests for PeerRegistry (hashed peer table with LRU eviction)
+
+#include <unity.h>
+#include "PeerRegistry.h"
+
+static const uint8_t* mac(uint8_t id) {
+    static uint8_t m[6] = {0x24, 0x6F, 0x28, 0, 0, 0};
+    m[5] = id;
+    return m;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testPeerRegistry_AddFindAndCount() {
+    PeerRegistry r;
+    r.begin(8);
+    TEST_ASSERT_EQUAL(0, r.size());
+    TEST_ASSERT_NULL(r.find(mac(1)));
+
+    PeerEntry* a = r.add(mac(1), 100);
+    r.add(mac(2), 200);
+    TEST_ASSERT_EQUAL(2, r.size());
+    TEST_ASSERT_EQUAL_PTR(a, r.find(mac(1)));
+
+    // Volver a emparejar no duplica
+    TEST_ASSERT_EQUAL_PTR(a, r.add(mac(1), 300));
+    TEST_ASSERT_EQUAL(2, r.size());
+    TEST_ASSERT_EQUAL_UINT32(300, a->lastSeenMs);
+    TEST_ASSERT_EQUAL_UINT32(100, a->pairedMs);
+}
+
+void testPeerRegistry_FrameStatsOnlyForPeers() {
+    PeerRegistry r;
+    r.add(mac(1), 0);
+    TEST_ASSERT_NOT_NULL(r.onFrame(mac(1), 40, -61, 10));
+    TEST_ASSERT_NOT_NULL(r.onFrame(mac(1), 60, -58, 20));
+    TEST_ASSERT_NULL(r.onFrame(mac(9), 40, -70, 30));
+
+    const PeerEntry* e = r.find(mac(1));
+    TEST_ASSERT_EQUAL_UINT32(2, e->frames);
+    TEST_ASSERT_EQUAL_UINT32(100, e->bytes);
+    TEST_ASSERT_EQUAL(-58, e->rssi);
+    TEST_ASSERT_EQUAL_UINT32(20, e->lastSeenMs);
+}
+
+void testPeerRegistry_FullEvictsLeastRecent() {
+    PeerRegistry r;
+    r.begin(4);
+    for (int i = 1; i <= 4; i++) r.add(mac(i), i * 10);
+    r.onFrame(mac(1), 10, 0, 100);   // El 1 vuelve a hablar: el menos usado es el 2
+
+    PeerEntry evicted;
+    bool didEvict = false;
+    r.add(mac(5), 200, &evicted, &didEvict);
+    TEST_ASSERT_TRUE(didEvict);
+    TEST_ASSERT_EQUAL_MEMORY(mac(2), evicted.mac, 6);
+    TEST_ASSERT_EQUAL(4, r.size());
+    TEST_ASSERT_EQUAL_UINT32(1, r.getStats().evictions);
+    TEST_ASSERT_NULL(r.find(mac(2)));
+    TEST_ASSERT_NOT_NULL(r.find(mac(1)));
+    TEST_ASSERT_NOT_NULL(r.find(mac(5)));
+}
+
+void testPeerRegistry_IdleExpireInLruOrder() {
+    PeerRegistry r;
+    r.add(mac(1), 0);
+    r.add(mac(2), 1000);
+    r.add(mac(3), 50000);
+
+    int expired = 0;
+    while (const PeerEntry* e = r.oldestIdle(60000, 30000)) {
+        r.expire(e->mac);
+        expired++;
+    }
+    TEST_ASSERT_EQUAL(2, expired);
+    TEST_ASSERT_EQUAL(1, r.size());
+    TEST_ASSERT_NOT_NULL(r.find(mac(3)));
+    TEST_ASSERT_EQUAL_UINT32(2, r.getStats().expired);
+}
+
+void testPeerRegistry_DriverSlotRecycling() {
+    PeerRegistry r;
+    r.add(mac(1), 0)->inDriver = true;
+    r.add(mac(2), 10);                  // Sin lugar en el driver
+    r.add(mac(3), 20)->inDriver = true;
+
+    TEST_ASSERT_EQUAL_MEMORY(mac(1), r.leastRecentInDriver()->mac, 6);
+    TEST_ASSERT_EQUAL_MEMORY(mac(3), r.leastRecentInDriver(mac(1))->mac, 6);
+    r.onFrame(mac(1), 10, 0, 30);
+    TEST_ASSERT_EQUAL_MEMORY(mac(3), r.leastRecentInDriver()->mac, 6);
+}
+
+void testPeerRegistry_ChurnKeepsIndexConsistent() {
+    PeerRegistry r;
+    r.begin(PEER_REGISTRY_MAX_CAPACITY);
+    // Muchas altas y bajas: después de cada una todos los presentes se encuentran
+    uint8_t m[6] = {0x24, 0, 0, 0, 0, 0};
+    for (int round = 0; round < 500; round++) {
+        m[4] = round & 0xFF;
+        m[5] = (round * 37) & 0xFF;
+        r.add(m, round);
+        if (round % 3 == 0) {
+            m[5] = ((round - 30) * 37) & 0xFF;
+            m[4] = (round - 30) & 0xFF;
+            r.remove(m);
+        }
+    }
+    int walked = 0;
+    uint32_t lastSeen = 0xFFFFFFFF;
+    for (const PeerEntry* e = r.first(); e; e = r.next(e)) {
+        TEST_ASSERT_EQUAL_PTR(e, r.find(e->mac));
+        TEST_ASSERT_TRUE(e->lastSeenMs <= lastSeen);   // Del más reciente al menos reciente
+        lastSeen = e->lastSeenMs;
+        walked++;
+    }
+    TEST_ASSERT_EQUAL(r.size(), walked);
+    TEST_ASSERT_EQUAL(PEER_REGISTRY_MAX_CAPACITY, r.size());
+    TEST_ASSERT_TRUE(r.getStats().maxProbe < 16);
+}
@@ -0,0 +1,121 @@
+// Tests for SleepSchedule (deep sleep duty cycle of battery sensors)
+
+#include <unity.h>
+#include "SleepSchedule.h"
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testSleepSchedule_BeginMarksValid() {
+    SleepSchedule s;
+    memset(&s, 0xA5, sizeof(s));   // Basura en RTC tras un corte de energía
+    TEST_ASSERT_FALSE(s.isValid());
+
+    s.begin();
+    TEST_ASSERT_TRUE(s.isValid());
+    TEST_ASSERT_EQUAL_UINT32(0, s.wakes);
+    TEST_ASSERT_EQUAL(0, s.failStreak);
+}
+
+void testSleepSchedule_SleepDiscountsAwakeTime() {
+    SleepSchedule s;
+    s.begin();
+    TEST_ASSERT_EQUAL_UINT32(59200, s.sleepMs(60000, 800));
+    // Despierto más que el período: duerme lo mínimo
+    TEST_ASSERT_EQUAL_UINT32(SLEEP_MIN_MS, s.sleepMs(60000, 300000));
+}
+
+void testSleepSchedule_BootToSendStats() {
+    SleepSchedule s;
+    s.begin();
+    s.onSend(true, 300);
+    s.onSend(true, 500);
+    s.onSend(false, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(2, s.acked);
+    TEST_ASSERT_EQUAL_UINT32(1, s.failed);
+    TEST_ASSERT_EQUAL_UINT32(500, s.lastBootToSendMs);
+    TEST_ASSERT_EQUAL_UINT32(500, s.maxBootToSendMs);
+    TEST_ASSERT_EQUAL_UINT32(400, s.avgBootToSendMs());
+}
+
+void testSleepSchedule_FailuresRediscoverAndBackOff() {
+    SleepSchedule s;
+    s.begin();
+    for (int i = 0; i < SLEEP_REDISCOVER_AFTER - 1; i++) s.onSend(false, 0);
+    TEST_ASSERT_FALSE(s.needsDiscovery());
+    s.onSend(false, 0);
+    TEST_ASSERT_TRUE(s.needsDiscovery());
+    TEST_ASSERT_EQUAL_UINT32(60000, s.sleepMs(60000, 0));   // El primer reintento, al período normal
+
+    s.onSend(false, 0);
+    TEST_ASSERT_EQUAL_UINT32(120000, s.sleepMs(60000, 0));
+    for (int i = 0; i < 20; i++) s.onSend(false, 0);
+    TEST_ASSERT_EQUAL_UINT32(60000UL * SLEEP_MAX_BACKOFF, s.sleepMs(60000, 0));
+
+    // Un ACK vuelve al período normal
+    s.onSend(true, 250);
+    TEST_ASSERT_FALSE(s.needsDiscovery());
+    TEST_ASSERT_EQUAL_UINT32(60000, s.sleepMs(60000, 0));
+}
+
+void testSleepSchedule_ClockRunsThroughSleep() {
+    SleepSchedule s;
+    s.begin();
+    TEST_ASSERT_EQUAL_UINT32(1500, s.clockMs(1500));
+
+    // Ventana de configuración de 300 s, después despertares de 60 s
+    s.onSleep(300000, 59000);
+    TEST_ASSERT_EQUAL_UINT32(359000 + 200, s.clockMs(200));
+    s.onSleep(1000, 59000);
+    TEST_ASSERT_EQUAL_UINT32(419000 + 200, s.clockMs(200));
+    TEST_ASSERT_EQUAL_UINT32(1000, s.lastAwakeMs);
+}
+
+void testSleepSchedule_WakeWithoutConfigKeepsPeriod() {
+    SleepSchedule s;
+    s.begin();
+    // Sin config y sin período guardado: el default, no SLEEP_MIN_MS
+    TEST_ASSERT_EQUAL_UINT32(SLEEP_DEFAULT_PERIOD_MS - 500, s.sleepMs(0, 500));
+
+    s.lastPeriodMs = 120000;
+    TEST_ASSERT_EQUAL_UINT32(119500, s.sleepMs(0, 500));
+    TEST_ASSERT_EQUAL_UINT32(59500, s.sleepMs(60000, 500));
+}
+
+// Malla recién construida: lo que guardaría ESPNowManager sin restaurar (sin peer, canal 1, secuencia 0)
+struct FreshMesh {
+    void saveResumeState(EspNowResumeState& state) const {
+        memset(&state, 0, sizeof(state));
+        state.magic = ESPNOW_RESUME_MAGIC;
+        state.channel = 1;
+    }
+};
+
+void testSleepSchedule_EarlyExitKeepsResumeState() {
+    SleepSchedule s;
+    s.begin();
+    EspNowResumeState rtc;
+    memset(&rtc, 0, sizeof(rtc));
+    rtc.magic = ESPNOW_RESUME_MAGIC;
+    rtc.channel = 11;
+    rtc.paired = true;
+    rtc.sequence = 4242;
+    EspNowResumeState before = rtc;
+
+    // Despertar que se corta antes de restoreResumeState (SPIFFS o init de ESP-NOW)
+    s.onWake();
+    TEST_ASSERT_FALSE(s.saveMesh(FreshMesh(), rtc));
+    TEST_ASSERT_EQUAL_MEMORY(&before, &rtc, sizeof(rtc));
+
+    // Despertar completo: se guarda
+    s.onWake();
+    s.onMeshRestored();
+    TEST_ASSERT_TRUE(s.saveMesh(FreshMesh(), rtc));
+    TEST_ASSERT_EQUAL(1, rtc.channel);
+
+    // Arranque en frío: la malla ya está inicializada
+    s.begin();
+    TEST_ASSERT_TRUE(s.saveMesh(FreshMesh(), rtc));
+}
@@ -0,0 +1,103 @@
+// Tests for SpscRing (lock-free single-producer/single-consumer ring)
+
+#include <unity.h>
+#include <string.h>
+#include <thread>
+#include "SpscRing.h"
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testSpscRing_PushPopFifo() {
+    SpscRing<int, 4> r;
+    TEST_ASSERT_TRUE(r.empty());
+
+    TEST_ASSERT_TRUE(r.push(1));
+    TEST_ASSERT_TRUE(r.push(2));
+    TEST_ASSERT_TRUE(r.push(3));
+    TEST_ASSERT_EQUAL(3, r.size());
+
+    int v = 0;
+    TEST_ASSERT_TRUE(r.pop(v));
+    TEST_ASSERT_EQUAL(1, v);
+    TEST_ASSERT_TRUE(r.pop(v));
+    TEST_ASSERT_EQUAL(2, v);
+    TEST_ASSERT_TRUE(r.pop(v));
+    TEST_ASSERT_EQUAL(3, v);
+    TEST_ASSERT_FALSE(r.pop(v));
+}
+
+void testSpscRing_FullDropsNewest() {
+    SpscRing<int, 4> r;
+    for (int i = 0; i < 4; i++) TEST_ASSERT_TRUE(r.push(i));
+
+    // Los 4 slots se usan: no se pierde uno para distinguir lleno de vacío
+    TEST_ASSERT_FALSE(r.push(99));
+    TEST_ASSERT_EQUAL(4, r.size());
+    TEST_ASSERT_EQUAL(1, r.getDropped());
+    TEST_ASSERT_EQUAL(4, r.getHighWater());
+
+    int v;
+    r.pop(v);
+    TEST_ASSERT_EQUAL(0, v);
+    TEST_ASSERT_TRUE(r.push(4));
+}
+
+void testSpscRing_ReserveCommitInPlace() {
+    struct Frame { int len; char data[8]; };
+    SpscRing<Frame, 2> r;
+
+    Frame* f = r.reserve();
+    TEST_ASSERT_NOT_NULL(f);
+    f->len = 3;
+    memcpy(f->data, "abc", 4);
+    TEST_ASSERT_TRUE(r.empty());   // No es visible hasta commit()
+    r.commit();
+
+    Frame* head = r.front();
+    TEST_ASSERT_NOT_NULL(head);
+    TEST_ASSERT_EQUAL(3, head->len);
+    TEST_ASSERT_EQUAL_STRING("abc", head->data);
+    r.release();
+    TEST_ASSERT_NULL(r.front());
+}
+
+void testSpscRing_IndexWrapAround() {
+    SpscRing<uint32_t, 2> r;
+    uint32_t v;
+    for (uint32_t i = 0; i < 100000; i++) {
+        TEST_ASSERT_TRUE(r.push(i));
+        TEST_ASSERT_TRUE(r.pop(v));
+        TEST_ASSERT_EQUAL(i, v);
+    }
+    TEST_ASSERT_EQUAL(0, r.getDropped());
+}
+
+void testSpscRing_TwoThreadsKeepOrder() {
+    static SpscRing<uint32_t, 16> r;
+    const uint32_t COUNT = 50000;
+
+    std::thread producer([&] {
+        for (uint32_t i = 0; i < COUNT;) {
+            if (r.push(i)) i++;
+            else std::this_thread::yield();
+        }
+    });
+
+    uint32_t expected = 0;
+    bool inOrder = true;
+    while (expected < COUNT) {
+        uint32_t v;
+        if (r.pop(v)) {
+            if (v != expected) inOrder = false;
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    producer.join();
+
+    TEST_ASSERT_TRUE(inOrder);
+    TEST_ASSERT_TRUE(r.empty());
+}
@@ -0,0 +1,104 @@
+// Tests for StreamingStats / MeasurementWindow (per-sensor reporting window)
+
+#include <unity.h>
+#include "StreamingStats.h"
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testStreamingStats_MeanMinMaxStd() {
+    StreamingStats s;
+    const float xs[] = {2, 4, 4, 4, 5, 5, 7, 9};
+    for (float x : xs) s.add(x);
+
+    TEST_ASSERT_EQUAL_UINT32(8, s.count);
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, 5.0, s.mean);
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, 2.0, s.stddev());
+    TEST_ASSERT_EQUAL_FLOAT(2, s.min);
+    TEST_ASSERT_EQUAL_FLOAT(9, s.max);
+
+    s.reset();
+    s.add(-3);
+    TEST_ASSERT_EQUAL_FLOAT(-3, s.min);
+    TEST_ASSERT_EQUAL_FLOAT(-3, s.max);
+    TEST_ASSERT_FLOAT_WITHIN(1e-9, 0.0, s.stddev());
+}
+
+void testStreamingStats_StableWithLargeOffset() {
+    // Desvío chico sobre un valor grande: sum(x²) - n·media² perdería todo
+    StreamingStats s;
+    for (int i = 0; i < 10000; i++) s.add(i & 1 ? 100000.5f : 99999.5f);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 100000.0, s.mean);
+    TEST_ASSERT_FLOAT_WITHIN(1e-6, 0.5, s.stddev());
+}
+
+void testStreamingStats_WindowFormatsFields() {
+    MeasurementWindow w;
+    MeasurementSet m;
+    m.add(MEAS_TEMP, 21.5f, 0);
+    m.addNamed("hum", 60.0f, 1, 0);
+    m.addNamed("label", 0, 0, 0, MEAS_INVALID);
+    w.add(m);
+    m.clear();
+    m.add(MEAS_TEMP, 22.5f, 1000);
+    m.addNamed("hum", 62.0f, 1, 1000);
+    w.add(m);
+    TEST_ASSERT_EQUAL_UINT32(2, w.getSamples());
+    TEST_ASSERT_EQUAL(2, w.getFieldCount());
+
+    MeasurementSet stats;
+    char out[160];
+    uint8_t next = 0;
+    TEST_ASSERT_EQUAL(2, w.format(next, stats));
+    TEST_ASSERT_EQUAL(8, stats.size());
+    TEST_ASSERT_EQUAL(MEAS_NAMED, stats[0].field);
+    TEST_ASSERT_EQUAL_UINT32(1000, stats[0].timestampMs);
+    measurementsToFields(stats, out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING("temp_mean=22.00,temp_min=21.50,temp_max=22.50,temp_std=0.50,"
+                             "hum_mean=61.0,hum_min=60.0,hum_max=62.0,hum_std=1.0", out);
+    stats.clear();
+    TEST_ASSERT_EQUAL(0, w.format(next, stats));
+
+    // La ventana siguiente arranca de cero
+    w.reset();
+    m.clear();
+    m.add(MEAS_TEMP, 20.0f, 2000);
+    w.add(m);
+    next = 0;
+    w.format(next, stats);
+    measurementsToFields(stats, out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING("temp_mean=20.00,temp_min=20.00,temp_max=20.00,temp_std=0.00", out);
+}
+
+void testStreamingStats_WindowSplitsAcrossSets() {
+    MeasurementWindow w;
+    MeasurementSet m;
+    m.add(MEAS_TEMP, 21.5f, 0);
+    m.add(MEAS_HUM, 60.5f, 0);
+    m.addNamed("co2", 415.0f, 2, 0);
+    w.add(m);
+
+    // Dos campos (8 mediciones) por MeasurementSet, y cada set en líneas de uplink
+    MeasurementSet stats;
+    uint8_t next = 0;
+    int sets = 0;
+    int fields = 0;
+    int lines = 0;
+    uint8_t n;
+    while ((n = w.format(next, stats)) > 0) {
+        char out[UPLINK_FIELDS_LEN];
+        uint8_t field = 0;
+        while (measurementsToFields(stats, out, sizeof(out), field) > 0) {
+            TEST_ASSERT_TRUE(strlen(out) < sizeof(out));
+            lines++;
+        }
+        TEST_ASSERT_EQUAL(stats.size(), field);
+        fields += n;
+        sets++;
+        stats.clear();
+    }
+    TEST_ASSERT_EQUAL(3, fields);
+    TEST_ASSERT_EQUAL(2, sets);
+    TEST_ASSERT_EQUAL(3, lines);
+}
@@ -0,0 +1,144 @@
+// Tests for TaskScheduler (cooperative scheduler used by main loop)
+
+#include <unity.h>
+#include "TaskScheduler.h"
+
+// ============================================================================
+// Mock clocks
+// ============================================================================
+
+static uint32_t sched_mock_ms = 0;
+static uint32_t sched_mock_us = 0;
+static uint32_t schedMockMillis() { return sched_mock_ms; }
+static uint32_t schedMockMicros() { return sched_mock_us; }
+
+static int fastRuns = 0;
+static int slowRuns = 0;
+static int otherRuns = 0;
+static void fastTask() { fastRuns++; }
+static void slowTask() { slowRuns++; sched_mock_us += 5000; }  // 5 ms of work
+static void otherTask() { otherRuns++; }
+
+static void resetScheduler() {
+    sched_mock_ms = 0;
+    sched_mock_us = 0;
+    fastRuns = slowRuns = otherRuns = 0;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testScheduler_ContinuousTaskRunsEveryPass() {
+    resetScheduler();
+    TaskScheduler sched(schedMockMillis, schedMockMicros);
+    sched.addTask("web", fastTask, 0);
+
+    sched.run();
+    sched.run();
+    sched.run();
+
+    TEST_ASSERT_EQUAL_INT(3, fastRuns);
+}
+
+void testScheduler_PeriodicTaskRespectsPeriod() {
+    resetScheduler();
+    TaskScheduler sched(schedMockMillis, schedMockMicros);
+    sched.addTask("sensors", otherTask, 1000);
+
+    sched.run();                   // t=0: due
+    TEST_ASSERT_EQUAL_INT(1, otherRuns);
+
+    sched_mock_ms = 500;
+    sched.run();                   // not due yet
+    TEST_ASSERT_EQUAL_INT(1, otherRuns);
+
+    sched_mock_ms = 1000;
+    sched.run();                   // due again
+    TEST_ASSERT_EQUAL_INT(2, otherRuns);
+    TEST_ASSERT_EQUAL_UINT32(1000, sched.msUntilNext());
+}
+
+void testScheduler_InitialDelay() {
+    resetScheduler();
+    TaskScheduler sched(schedMockMillis, schedMockMicros);
+    sched.addTask("ota", otherTask, 3600000, 0, 3600000);
+
+    sched.run();
+    TEST_ASSERT_EQUAL_INT(0, otherRuns);
+
+    sched_mock_ms = 3600000;
+    sched.run();
+    TEST_ASSERT_EQUAL_INT(1, otherRuns);
+}
+
+void testScheduler_OnePeriodicTaskPerPass() {
+    resetScheduler();
+    TaskScheduler sched(schedMockMillis, schedMockMicros);
+    sched.addTask("web", fastTask, 0);
+    sched.addTask("slow", slowTask, 100);
+    sched.addTask("other", otherTask, 100);
+
+    // Both periodic tasks are due, but only one runs per pass;
+    // the web task runs in between
+    sched.run();
+    TEST_ASSERT_EQUAL_INT(1, slowRuns + otherRuns);
+    TEST_ASSERT_EQUAL_INT(1, fastRuns);
+
+    sched.run();
+    TEST_ASSERT_EQUAL_INT(1, slowRuns);
+    TEST_ASSERT_EQUAL_INT(1, otherRuns);
+    TEST_ASSERT_EQUAL_INT(2, fastRuns);
+}
+
+void testScheduler_MostOverdueFirst() {
+    resetScheduler();
+    TaskScheduler sched(schedMockMillis, schedMockMicros);
+    sched.addTask("a", slowTask, 100, 0, 50);   // due at 50
+    sched.addTask("b", otherTask, 100, 0, 10);  // due at 10
+
+    sched_mock_ms = 60;
+    sched.run();
+    TEST_ASSERT_EQUAL_INT(1, otherRuns);  // b is 50 ms late, a only 10 ms
+    TEST_ASSERT_EQUAL_INT(0, slowRuns);
+}
+
+void testScheduler_RunTimeAccountingAndDeadline() {
+    resetScheduler();
+    TaskScheduler sched(schedMockMillis, schedMockMicros);
+    int id = sched.addTask("slow", slowTask, 100, 2000);  // 2 ms deadline
+
+    sched.run();
+
+    const TaskScheduler::Task& t = sched.getTask(id);
+    TEST_ASSERT_EQUAL_UINT32(1, t.runs);
+    TEST_ASSERT_EQUAL_UINT32(5000, t.lastRunUs);
+    TEST_ASSERT_EQUAL_UINT32(5000, t.maxRunUs);
+    TEST_ASSERT_EQUAL_UINT32(1, t.overruns);
+}
+
+void testScheduler_SkipsMissedPeriods() {
+    resetScheduler();
+    TaskScheduler sched(schedMockMillis, schedMockMicros);
+    int id = sched.addTask("sensors", otherTask, 100);
+
+    sched_mock_ms = 1050;  // 10 periods late
+    sched.run();
+    TEST_ASSERT_EQUAL_INT(1, otherRuns);
+    TEST_ASSERT_TRUE(sched.getTask(id).skipped >= 9);
+    TEST_ASSERT_EQUAL_UINT32(1050, sched.getTask(id).maxLatenessMs);
+
+    // No burst of catch-up runs
+    sched.run();
+    TEST_ASSERT_EQUAL_INT(1, otherRuns);
+}
+
+void testScheduler_DisabledTaskDoesNotRun() {
+    resetScheduler();
+    TaskScheduler sched(schedMockMillis, schedMockMicros);
+    int id = sched.addTask("mesh", otherTask, 0);
+    sched.setEnabled(id, false);
+
+    sched.run();
+    TEST_ASSERT_EQUAL_INT(0, otherRuns);
+}
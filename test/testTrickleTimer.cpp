@@ -0,0 +1,85 @@
+// Tests for TrickleTimer (adaptive beacon interval with suppression)
+
+#include <unity.h>
+#include "TrickleTimer.h"
+
+// Avanza de a 10 ms hasta untilMs (incluido) y devuelve cuántas veces pidió transmitir
+static int runUntil(TrickleTimer& t, uint32_t& now, uint32_t untilMs) {
+    int sent = 0;
+    for (; now <= untilMs; now += 10) {
+        if (t.poll(now)) sent++;
+    }
+    return sent;
+}
+
+// ============================================================================
+// TESTS
+// ============================================================================
+
+void testTrickleTimer_BacksOffWhileStable() {
+    TrickleTimer t;
+    t.begin(2000, 64000, 3, 0x1234);
+    uint32_t now = 0;
+
+    // 2 + 4 + 8 + 16 + 32 = 62 s de intervalos crecientes, uno por intervalo
+    TEST_ASSERT_EQUAL(5, runUntil(t, now, 62000));
+    TEST_ASSERT_EQUAL_UINT32(64000, t.getInterval());
+
+    // Ya en Imax: uno cada 64 s en vez de 32 con intervalo fijo de 2 s
+    TEST_ASSERT_EQUAL(1, runUntil(t, now, 62000 + 64000));
+    TEST_ASSERT_EQUAL_UINT32(64000, t.getInterval());
+}
+
+void testTrickleTimer_FiresInSecondHalf() {
+    for (uint32_t seed = 1; seed < 50; seed++) {
+        TrickleTimer t;
+        t.begin(2000, 2000, 0, seed);
+        uint32_t now = 0;
+        while (!t.poll(now)) now += 10;
+        TEST_ASSERT_TRUE(now >= 1000 && now < 2000);
+    }
+}
+
+void testTrickleTimer_SuppressedByRedundantNeighbors() {
+    TrickleTimer t;
+    t.begin(2000, 2000, 2, 7);
+    uint32_t now = 0;
+
+    t.poll(now);
+    t.hearConsistent();
+    t.hearConsistent();   // Dos vecinos ya anunciaron lo mismo
+    TEST_ASSERT_EQUAL(0, runUntil(t, now, 1999));
+    TEST_ASSERT_EQUAL_UINT32(1, t.getStats().suppressed);
+
+    // Intervalo siguiente sin vecinos: transmite
+    TEST_ASSERT_EQUAL(1, runUntil(t, now, 4000));
+}
+
+void testTrickleTimer_NoSuppressionWhenDisallowed() {
+    TrickleTimer t;
+    t.begin(2000, 2000, 1, 7);
+    t.setSuppression(false);   // Gateway o nodo que reenvía
+    uint32_t now = 0;
+    t.poll(now);
+    for (int i = 0; i < 5; i++) t.hearConsistent();
+    TEST_ASSERT_EQUAL(1, runUntil(t, now, 1999));
+    TEST_ASSERT_EQUAL_UINT32(0, t.getStats().suppressed);
+}
+
+void testTrickleTimer_ResetReturnsToImin() {
+    TrickleTimer t;
+    t.begin(2000, 64000, 3, 99);
+    uint32_t now = 0;
+    runUntil(t, now, 62000);
+    TEST_ASSERT_EQUAL_UINT32(64000, t.getInterval());
+
+    t.reset(now);   // Cambió el padre
+    TEST_ASSERT_EQUAL_UINT32(2000, t.getInterval());
+    TEST_ASSERT_EQUAL_UINT32(1, t.getStats().resets);
+    uint32_t start = now;
+    TEST_ASSERT_EQUAL(1, runUntil(t, now, start + 1990));
+
+    // En Imin un reset no reinicia el intervalo en curso
+    t.reset(now);
+    TEST_ASSERT_EQUAL_UINT32(1, t.getStats().resets);
+}